@@ -8,7 +8,7 @@ if plugin "js" then
 	excludes { "src/meta_js.cpp" }
 	includedirs { "../../js/src", }
 	defines { "BUILDING_JS" }
-	dynamic_link_plugin { "engine" }
+	dynamic_link_plugin { "engine", "physics" }
 
 	project "meta"
 		files { "src/meta_js.cpp" }
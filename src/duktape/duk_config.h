@@ -3086,7 +3086,8 @@ typedef struct duk_hthread duk_context;
 #undef DUK_USE_VALSTACK_UNSAFE
 #define DUK_USE_VERBOSE_ERRORS
 #define DUK_USE_VERBOSE_EXECUTOR_ERRORS
-#define DUK_USE_VOLUNTARY_GC
+/* collections are scheduled by JSScriptSystemImpl::updateGC */
+#undef DUK_USE_VOLUNTARY_GC
 #define DUK_USE_ZERO_BUFFER_DATA
 
 /*
@@ -1,5 +1,6 @@
 #define LUMIX_NO_CUSTOM_CRT
 #include <string.h>
+#include "../js_heap_snapshot.h"
 #include "../js_script_manager.h"
 #include "../js_script_system.h"
 #include "../duktape/duk_debugger.h"
@@ -13,6 +14,7 @@
 #include "editor/world_editor.h"
 #include "core/array.h"
 #include "core/log.h"
+#include "core/math.h"
 #include "core/os.h"
 #include "core/path.h"
 #include "core/profiler.h"
@@ -312,7 +314,7 @@ template <typename T> struct StoredType {
 	using Type = T; 
 	static T construct(T value, IAllocator& allocator) { return value; }
 	static T get(T value) { return value; }
-	static T toType(duk_context* ctx, i32 idx, JSScriptSystem& system) { return JSWrapper::toType<T>(ctx, -1); }
+	static T toType(duk_context* ctx, i32 idx, JSScriptSystem& system) { return JSWrapper::toType<T>(ctx, duk_normalize_index(ctx, -1)); }
 	static void push(duk_context* ctx, T value, JSScriptSystem&, WorldEditor&) { JSWrapper::push(ctx, value); }
 };
 
@@ -349,7 +351,7 @@ struct SetJSPropertyCommand : IEditorCommand {
 	{
 		auto* module = (JSScriptModule*)m_editor.getWorld()->getModule(JS_SCRIPT_TYPE);
 		uintptr script_id = module->getScriptID(m_entity, m_script_index);
-		duk_context* ctx = system.getGlobalContext();
+		duk_context* ctx = module->getScriptContext(m_entity, m_script_index);
 		
 		JSWrapper::DebugGuard guard(ctx);
 		duk_push_global_stash(ctx);
@@ -372,9 +374,8 @@ struct SetJSPropertyCommand : IEditorCommand {
 
 	bool setValue(T value) {
 		auto* module = (JSScriptModule*)m_editor.getWorld()->getModule(JS_SCRIPT_TYPE);
-		auto& system = (JSScriptSystem&)module->getSystem();
 		uintptr script_id = module->getScriptID(m_entity, m_script_index);
-		duk_context* ctx = system.getGlobalContext();
+		duk_context* ctx = module->getScriptContext(m_entity, m_script_index);
 		
 		JSWrapper::DebugGuard guard(ctx);
 		duk_push_global_stash(ctx);
@@ -424,7 +425,7 @@ struct JSPropertyGridPlugin : PropertyGrid::IPlugin {
 		auto* module = (JSScriptModule*)editor.getWorld()->getModule(cmp_type);
 		auto& system = (JSScriptSystem&)module->getSystem();
 		EntityRef entity = entities[0];
-		duk_context* ctx = system.getGlobalContext();
+		duk_context* ctx = module->getScriptContext(entity, array_index);
 		IAllocator& allocator = editor.getAllocator();
 		UniquePtr<IEditorCommand> cmd;
 		
@@ -470,13 +471,67 @@ struct JSPropertyGridPlugin : PropertyGrid::IPlugin {
 					}
 					break;
 				}
-				case JSScriptModule::Property::ENTITY:
+				case JSScriptModule::Property::ENTITY: {
 					EntityPtr value = JSWrapper::toType<EntityPtr>(ctx, -1);
 
 					if (m_app.getPropertyGrid().entityInput(property_name, &value)) {
 						cmd = UniquePtr<SetJSPropertyCommand<EntityPtr>>::create(allocator, system, editor, entity, array_index, property_name, value);
 					}
 					break;
+				}
+				case JSScriptModule::Property::VEC2: {
+					Vec2 v;
+					if (JSWrapper::getVector(ctx, -1, 2, &v.x) && ImGui::DragFloat2("##v", &v.x)) {
+						cmd = UniquePtr<SetJSPropertyCommand<Vec2>>::create(allocator, system, editor, entity, array_index, property_name, v);
+					}
+					break;
+				}
+				case JSScriptModule::Property::VEC3: {
+					Vec3 v;
+					if (JSWrapper::getVector(ctx, -1, 3, &v.x) && ImGui::DragFloat3("##v", &v.x)) {
+						cmd = UniquePtr<SetJSPropertyCommand<Vec3>>::create(allocator, system, editor, entity, array_index, property_name, v);
+					}
+					break;
+				}
+				case JSScriptModule::Property::VEC4: {
+					Vec4 v;
+					if (JSWrapper::getVector(ctx, -1, 4, &v.x) && ImGui::DragFloat4("##v", &v.x)) {
+						cmd = UniquePtr<SetJSPropertyCommand<Vec4>>::create(allocator, system, editor, entity, array_index, property_name, v);
+					}
+					break;
+				}
+				case JSScriptModule::Property::COLOR: {
+					Vec4 v;
+					if (JSWrapper::getVector(ctx, -1, 4, &v.x) && ImGui::ColorEdit4("##v", &v.x)) {
+						cmd = UniquePtr<SetJSPropertyCommand<Vec4>>::create(allocator, system, editor, entity, array_index, property_name, v);
+					}
+					break;
+				}
+				case JSScriptModule::Property::QUAT: {
+					Quat q;
+					if (!JSWrapper::getVector(ctx, -1, 4, &q.x)) break;
+					Vec3 euler = radiansToDegrees(q.toEuler());
+					if (ImGui::DragFloat3("##v", &euler.x)) {
+						q.fromEuler(degreesToRadians(euler));
+						cmd = UniquePtr<SetJSPropertyCommand<Quat>>::create(allocator, system, editor, entity, array_index, property_name, q);
+					}
+					break;
+				}
+				case JSScriptModule::Property::RESOURCE: {
+					if (!duk_is_string(ctx, -1)) break;
+					Path path(duk_get_string(ctx, -1));
+					const ResourceType resource_type = module->getPropertyResourceType(entity, array_index, property_index);
+					if (m_app.getAssetBrowser().resourceInput("##v", path, resource_type)) {
+						cmd = UniquePtr<SetJSPropertyCommand<Path>>::create(allocator, system, editor, entity, array_index, property_name, path);
+					}
+					break;
+				}
+				case JSScriptModule::Property::F32_ARRAY:
+				case JSScriptModule::Property::F64_ARRAY:
+				case JSScriptModule::Property::I32_ARRAY:
+					// arrays are edited only from scripts
+					ImGui::Text("%d elements", (i32)duk_get_length(ctx, -1));
+					break;
 			}
 			duk_pop_3(ctx);
 
@@ -625,12 +680,13 @@ struct ConsolePlugin final : public StudioApp::GUIPlugin {
 					Span<const EntityRef> selected = that->m_app.getWorldEditor().getSelectedEntities();
 					if (selected.size() == 1 && module->getWorld().hasComponent(selected[0], JS_SCRIPT_TYPE)) {
 						const uintptr id = module->getScriptID(selected[0], 0);
-						duk_push_global_stash(ctx); // [stash]
-						duk_push_pointer(ctx, (void*)id);  // [stash, id]
-						duk_get_prop(ctx, -2); // [stash, this]
-						duk_remove(ctx, -2); // [this]
-						that->autocompleteSubstep(ctx, tmp + 5/*"this."*/, data);
-						duk_pop(ctx);
+						duk_context* script_ctx = module->getScriptContext(selected[0], 0);
+						duk_push_global_stash(script_ctx); // [stash]
+						duk_push_pointer(script_ctx, (void*)id);  // [stash, id]
+						duk_get_prop(script_ctx, -2); // [stash, this]
+						duk_remove(script_ctx, -2); // [this]
+						that->autocompleteSubstep(script_ctx, tmp + 5/*"this."*/, data);
+						duk_pop(script_ctx);
 					}
 				}
 				else if (startsWith("thi", tmp)) {
@@ -659,6 +715,191 @@ struct ConsolePlugin final : public StudioApp::GUIPlugin {
 	}
 
 
+	// objects aggregated by constructor name
+	struct DiffRow {
+		const char* type;
+		u32 count[2] = {};
+		u64 size[2] = {};
+		// objects in B, which are not in A
+		u32 new_count = 0;
+	};
+
+	// id is not enough, since heap pointers are reused after objects are freed
+	bool isNew(u32 node_idx) const {
+		const JSHeapSnapshot::Node& node = m_snapshots[1].nodes[node_idx];
+		const i32 prev_idx = m_snapshots[0].find(node.id);
+		if (prev_idx < 0) return true;
+		return !equalStrings(m_snapshots[0].getString(m_snapshots[0].nodes[prev_idx].type), m_snapshots[1].getString(node.type));
+	}
+
+	void diff() {
+		m_diff.clear();
+		m_new_objects.clear();
+		m_selected_type = -1;
+		HashMap<StableHash, u32> rows(m_app.getAllocator());
+		for (u32 i = 0; i < 2; ++i) {
+			const JSHeapSnapshot& snapshot = m_snapshots[i];
+			for (u32 j = 0, c = snapshot.nodes.size(); j < c; ++j) {
+				const JSHeapSnapshot::Node& node = snapshot.nodes[j];
+				const char* type = snapshot.getString(node.type);
+				const StableHash hash(type);
+				auto iter = rows.find(hash);
+				u32 row_idx;
+				if (iter.isValid()) {
+					row_idx = iter.value();
+				}
+				else {
+					row_idx = m_diff.size();
+					rows.insert(hash, row_idx);
+					m_diff.emplace().type = type;
+				}
+				DiffRow& row = m_diff[row_idx];
+				++row.count[i];
+				row.size[i] += node.self_size;
+				if (i == 1 && isNew(j)) ++row.new_count;
+			}
+		}
+
+		if (m_diff.empty()) return;
+		qsort(m_diff.begin(), m_diff.size(), sizeof(DiffRow), [](const void* a, const void* b) -> int {
+			const DiffRow* r0 = (const DiffRow*)a;
+			const DiffRow* r1 = (const DiffRow*)b;
+			const i64 d0 = (i64)r0->count[1] - r0->count[0];
+			const i64 d1 = (i64)r1->count[1] - r1->count[0];
+			return d0 < d1 ? 1 : (d0 > d1 ? -1 : 0);
+		});
+	}
+
+	void selectType(i32 row_idx) {
+		m_selected_type = row_idx;
+		m_new_objects.clear();
+		if (row_idx < 0) return;
+
+		const JSHeapSnapshot& snapshot = m_snapshots[1];
+		for (u32 i = 0, c = snapshot.nodes.size(); i < c; ++i) {
+			if (!equalStrings(snapshot.getString(snapshot.nodes[i].type), m_diff[row_idx].type)) continue;
+			if (isNew(i)) m_new_objects.push(i);
+		}
+	}
+
+	void captureSnapshot(u32 idx) {
+		auto* module = (JSScriptModule*)m_app.getWorldEditor().getWorld()->getModule(JS_SCRIPT_TYPE);
+		module->captureHeapSnapshot(m_snapshots[idx]);
+		diff();
+	}
+
+	void saveSnapshot(u32 idx) {
+		char path[512];
+		if (!os::getSaveFilename(Span(path), "Heap snapshot\0*.jshs\0", "jshs")) return;
+
+		OutputMemoryStream blob(m_app.getAllocator());
+		m_snapshots[idx].serialize(blob);
+		os::OutputFile file;
+		if (!file.open(path)) {
+			logError("Failed to create ", path);
+			return;
+		}
+		if (!file.write(blob.data(), blob.size())) logError("Failed to write ", path);
+		file.close();
+	}
+
+	void loadSnapshot(u32 idx) {
+		char path[512];
+		if (!os::getOpenFilename(Span(path), "Heap snapshot\0*.jshs\0", nullptr)) return;
+
+		os::InputFile file;
+		if (!file.open(path)) {
+			logError("Failed to open ", path);
+			return;
+		}
+		OutputMemoryStream blob(m_app.getAllocator());
+		blob.resize(file.size());
+		const bool read = file.read(blob.getMutableData(), blob.size());
+		file.close();
+
+		InputMemoryStream input(blob);
+		if (!read || !m_snapshots[idx].deserialize(input)) {
+			logError("Invalid heap snapshot ", path);
+			m_snapshots[idx].clear();
+		}
+		diff();
+	}
+
+	void snapshotsGUI() {
+		if (!ImGui::CollapsingHeader("Snapshots")) return;
+
+		for (u32 i = 0; i < 2; ++i) {
+			ImGui::PushID(i);
+			ImGui::TextUnformatted(i == 0 ? "A" : "B");
+			ImGui::SameLine();
+			if (ImGui::Button("Capture")) captureSnapshot(i);
+			ImGui::SameLine();
+			if (ImGui::Button("Save")) saveSnapshot(i);
+			ImGui::SameLine();
+			if (ImGui::Button("Load")) loadSnapshot(i);
+			ImGui::SameLine();
+			ImGui::Text("%d values", m_snapshots[i].nodes.size());
+			ImGui::PopID();
+		}
+
+		if (m_diff.empty()) return;
+
+		if (ImGui::BeginTable("diff", 6, ImGuiTableFlags_Borders | ImGuiTableFlags_Resizable | ImGuiTableFlags_ScrollY, ImVec2(0, 300))) {
+			ImGui::TableSetupColumn("Type");
+			ImGui::TableSetupColumn("Count A");
+			ImGui::TableSetupColumn("Count B");
+			ImGui::TableSetupColumn("Delta");
+			ImGui::TableSetupColumn("KB delta");
+			ImGui::TableSetupColumn("New in B");
+			ImGui::TableHeadersRow();
+			for (i32 i = 0; i < m_diff.size(); ++i) {
+				const DiffRow& row = m_diff[i];
+				ImGui::TableNextRow();
+				ImGui::TableNextColumn();
+				if (ImGui::Selectable(row.type, m_selected_type == i, ImGuiSelectableFlags_SpanAllColumns)) selectType(i);
+				ImGui::TableNextColumn();
+				ImGui::Text("%d", row.count[0]);
+				ImGui::TableNextColumn();
+				ImGui::Text("%d", row.count[1]);
+				ImGui::TableNextColumn();
+				ImGui::Text("%+d", i32(row.count[1] - row.count[0]));
+				ImGui::TableNextColumn();
+				ImGui::Text("%+.1f", ((i64)row.size[1] - (i64)row.size[0]) / 1024.f);
+				ImGui::TableNextColumn();
+				ImGui::Text("%d", row.new_count);
+			}
+			ImGui::EndTable();
+		}
+
+		if (m_selected_type < 0) return;
+
+		ImGui::Text("New %s in B", m_diff[m_selected_type].type);
+		if (ImGui::BeginTable("new_objects", 3, ImGuiTableFlags_Borders | ImGuiTableFlags_Resizable | ImGuiTableFlags_ScrollY, ImVec2(0, 300))) {
+			ImGui::TableSetupColumn("Retainer path");
+			ImGui::TableSetupColumn("Size");
+			ImGui::TableSetupColumn("Retained size");
+			ImGui::TableHeadersRow();
+			const JSHeapSnapshot& snapshot = m_snapshots[1];
+			ImGuiListClipper clipper;
+			clipper.Begin(m_new_objects.size());
+			while (clipper.Step()) {
+				for (i32 i = clipper.DisplayStart; i < clipper.DisplayEnd; ++i) {
+					const JSHeapSnapshot::Node& node = snapshot.nodes[m_new_objects[i]];
+					char path[1024];
+					snapshot.getRetainerPath(m_new_objects[i], Span(path));
+					ImGui::TableNextRow();
+					ImGui::TableNextColumn();
+					ImGui::TextUnformatted(path);
+					ImGui::TableNextColumn();
+					ImGui::Text("%d", node.self_size);
+					ImGui::TableNextColumn();
+					ImGui::Text("%.1f KB", node.retained_size / 1024.f);
+				}
+			}
+			ImGui::EndTable();
+		}
+	}
+
 	void onGUI() override {
 		if (m_app.checkShortcut(m_open_action, true)) m_is_open = !m_is_open;
 		if (!m_is_open) return;
@@ -745,16 +986,119 @@ struct ConsolePlugin final : public StudioApp::GUIPlugin {
 };
 
 
+struct MemoryPlugin final : public StudioApp::GUIPlugin {
+	MemoryPlugin(StudioApp& app)
+		: m_app(app)
+		, m_report(app.getAllocator())
+		, m_snapshots{JSHeapSnapshot(app.getAllocator()), JSHeapSnapshot(app.getAllocator())}
+		, m_diff(app.getAllocator())
+		, m_new_objects(app.getAllocator())
+	{
+		m_app.getSettings().registerOption("js_memory_open", &m_is_open);
+	}
+
+	const char* getName() const override { return "js_memory"; }
+
+	void measure() {
+		auto* module = (JSScriptModule*)m_app.getWorldEditor().getWorld()->getModule(JS_SCRIPT_TYPE);
+		m_report.global = {};
+		m_report.modules.clear();
+		m_report.scripts.clear();
+		m_report.instances.clear();
+		module->getMemoryReport(m_report);
+
+		auto cmp = [](const void* a, const void* b) -> int {
+			const u64 a_bytes = ((const JSMemoryItem*)a)->bytes;
+			const u64 b_bytes = ((const JSMemoryItem*)b)->bytes;
+			return a_bytes < b_bytes ? 1 : (a_bytes > b_bytes ? -1 : 0);
+		};
+		if (!m_report.scripts.empty()) qsort(m_report.scripts.begin(), m_report.scripts.size(), sizeof(JSMemoryItem), cmp);
+		if (!m_report.instances.empty()) qsort(m_report.instances.begin(), m_report.instances.size(), sizeof(JSMemoryItem), cmp);
+		if (!m_report.modules.empty()) qsort(m_report.modules.begin(), m_report.modules.size(), sizeof(JSMemoryItem), cmp);
+	}
+
+	static void itemsGUI(const char* label, Span<const JSMemoryItem> items, bool show_entity) {
+		if (!ImGui::CollapsingHeader(label)) return;
+		if (!ImGui::BeginTable(label, show_entity ? 4 : 3, ImGuiTableFlags_Borders | ImGuiTableFlags_Resizable)) return;
+
+		ImGui::TableSetupColumn("Path");
+		if (show_entity) ImGui::TableSetupColumn("Entity");
+		ImGui::TableSetupColumn("KB");
+		ImGui::TableSetupColumn("Values");
+		ImGui::TableHeadersRow();
+		for (const JSMemoryItem& item : items) {
+			ImGui::TableNextRow();
+			ImGui::TableNextColumn();
+			ImGui::TextUnformatted(item.path.c_str());
+			if (show_entity) {
+				ImGui::TableNextColumn();
+				ImGui::Text("%d [%d]", item.entity.index, item.scr_index);
+			}
+			ImGui::TableNextColumn();
+			ImGui::Text("%.1f", item.bytes / 1024.f);
+			ImGui::TableNextColumn();
+			ImGui::Text("%d", item.objects);
+		}
+		ImGui::EndTable();
+	}
+
+	void onGUI() override {
+		if (m_app.checkShortcut(m_open_action, true)) m_is_open = !m_is_open;
+		if (!m_is_open) return;
+
+		if (m_auto_refresh && m_refresh_timer.getTimeSinceTick() > 2) {
+			m_refresh_timer.tick();
+			measure();
+		}
+
+		if (ImGui::Begin("JavaScript memory", &m_is_open)) {
+			if (ImGui::Button("Measure")) measure();
+			ImGui::SameLine();
+			ImGui::Checkbox("Auto refresh", &m_auto_refresh);
+
+			auto* module = (JSScriptModule*)m_app.getWorldEditor().getWorld()->getModule(JS_SCRIPT_TYPE);
+			auto& system = (JSScriptSystem&)module->getSystem();
+			const JSAllocator::Stats& heap = system.getHeapStats(module->getGlobalContext());
+			const JSGCStats& gc = system.getGCStats(module->getGlobalContext());
+			ImGui::Text("Heap: %.1f KB live, %.1f KB reserved, %d allocations", heap.live_bytes / 1024.f, heap.reserved_bytes / 1024.f, heap.live_allocations);
+			ImGui::Text("GC: %d collections, last pause %.2f ms, max pause %.2f ms", gc.collections, gc.last_pause_ms, gc.max_pause_ms);
+			ImGui::Text("Global: %.1f KB", m_report.global.bytes / 1024.f);
+
+			itemsGUI("Scripts", Span<const JSMemoryItem>(m_report.scripts.begin(), m_report.scripts.size()), false);
+			itemsGUI("Instances", Span<const JSMemoryItem>(m_report.instances.begin(), m_report.instances.size()), true);
+			itemsGUI("Modules", Span<const JSMemoryItem>(m_report.modules.begin(), m_report.modules.size()), false);
+			snapshotsGUI();
+		}
+		ImGui::End();
+	}
+
+	StudioApp& m_app;
+	JSMemoryReport m_report;
+	// A and B
+	JSHeapSnapshot m_snapshots[2];
+	Array<DiffRow> m_diff;
+	i32 m_selected_type = -1;
+	// indices of nodes in B
+	Array<u32> m_new_objects;
+	bool m_is_open = false;
+	bool m_auto_refresh = false;
+	os::Timer m_refresh_timer;
+	Action m_open_action{"JavaScript", "JS memory", "Memory", "js_memory",  nullptr, Action::WINDOW};
+};
+
+
 struct StudioAppPlugin : StudioApp::IPlugin {
 	StudioAppPlugin(StudioApp& app)
 		: m_app(app)
 		, m_asset_plugin(app)
 		, m_console_plugin(app)
+		, m_memory_plugin(app)
 		, m_property_grid_plugin(app)
 	{}
 
 	~StudioAppPlugin() override {
 		m_app.removePlugin(m_console_plugin);
+		m_app.removePlugin(m_memory_plugin);
 		m_app.getAssetCompiler().removePlugin(m_asset_plugin);
 		m_app.getAssetBrowser().removePlugin(m_asset_plugin);
 		m_app.getPropertyGrid().removePlugin(m_property_grid_plugin);
@@ -768,6 +1112,7 @@ struct StudioAppPlugin : StudioApp::IPlugin {
 		m_app.getAssetCompiler().addPlugin(m_asset_plugin, Span(exts));
 		m_app.getAssetBrowser().addPlugin(m_asset_plugin, Span(exts));
 		m_app.addPlugin(m_console_plugin);
+		m_app.addPlugin(m_memory_plugin);
 		m_app.getPropertyGrid().addPlugin(m_property_grid_plugin);
 	}
 
@@ -778,6 +1123,7 @@ struct StudioAppPlugin : StudioApp::IPlugin {
 	StudioApp& m_app;
 	AssetPlugin m_asset_plugin;
 	ConsolePlugin m_console_plugin;
+	MemoryPlugin m_memory_plugin;
 	JSPropertyGridPlugin m_property_grid_plugin;
 };
 
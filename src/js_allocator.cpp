@@ -0,0 +1,206 @@
+#include "js_allocator.h"
+
+#include "core/crt.h"
+#include "core/math.h"
+
+
+namespace Lumix {
+
+static constexpr u32 SLAB_SIZE = 64 * 1024;
+static constexpr u32 BIG_SIZE_CLASS = JSAllocator::SIZE_CLASS_COUNT;
+
+// precedes each block, big blocks are allocated with its alignment, so all blocks are 16-byte aligned
+struct alignas(16) JSAllocator::BlockHeader {
+	u32 size;
+	u32 size_class;
+	// nullptr for big blocks
+	Slab* slab;
+};
+
+struct JSAllocator::FreeBlock {
+	FreeBlock* next;
+};
+
+// blocks follow right after the slab, their strides are multiples of 16
+struct alignas(16) JSAllocator::Slab {
+	// in m_partial_slabs, if the slab has free blocks
+	Slab* prev;
+	Slab* next;
+	FreeBlock* free_blocks;
+	u32 size_class;
+	u32 live_blocks;
+};
+
+static u32 getSizeClass(size_t size) {
+	if (size > JSAllocator::MAX_SMALL_SIZE) return BIG_SIZE_CLASS;
+
+	u32 size_class = 0;
+	while ((JSAllocator::MIN_BLOCK_SIZE << size_class) < size) ++size_class;
+	return size_class;
+}
+
+JSAllocator::JSAllocator(IAllocator& parent)
+	: m_allocator(parent, "duktape")
+{}
+
+// without live allocations all slabs have free blocks
+JSAllocator::~JSAllocator() {
+	ASSERT(m_stats.live_allocations == 0);
+	for (Slab*& slab : m_partial_slabs) {
+		while (slab) {
+			Slab* next = slab->next;
+			m_allocator.deallocate(slab);
+			slab = next;
+		}
+	}
+}
+
+void JSAllocator::linkSlab(Slab* slab) {
+	Slab*& head = m_partial_slabs[slab->size_class];
+	slab->prev = nullptr;
+	slab->next = head;
+	if (head) head->prev = slab;
+	head = slab;
+}
+
+void JSAllocator::unlinkSlab(Slab* slab) {
+	if (slab->prev) slab->prev->next = slab->next;
+	else m_partial_slabs[slab->size_class] = slab->next;
+	if (slab->next) slab->next->prev = slab->prev;
+	slab->prev = slab->next = nullptr;
+}
+
+JSAllocator::Slab* JSAllocator::allocSlab(u32 size_class) {
+	u8* mem = (u8*)m_allocator.allocate(SLAB_SIZE, alignof(Slab));
+	if (!mem) return nullptr;
+
+	Slab* slab = (Slab*)mem;
+	slab->free_blocks = nullptr;
+	slab->size_class = size_class;
+	slab->live_blocks = 0;
+
+	const u32 stride = sizeof(BlockHeader) + (MIN_BLOCK_SIZE << size_class);
+	for (u32 offset = sizeof(Slab); offset + stride <= SLAB_SIZE; offset += stride) {
+		FreeBlock* block = (FreeBlock*)(mem + offset);
+		block->next = slab->free_blocks;
+		slab->free_blocks = block;
+	}
+	linkSlab(slab);
+	m_stats.reserved_bytes += SLAB_SIZE;
+	return slab;
+}
+
+void* JSAllocator::allocate(size_t size) {
+	ASSERT(size <= 0xffFFffFF);
+	const u32 size_class = getSizeClass(size);
+	BlockHeader* header;
+	if (size_class == BIG_SIZE_CLASS) {
+		header = (BlockHeader*)m_allocator.allocate(sizeof(BlockHeader) + size, alignof(BlockHeader));
+		if (!header) return nullptr;
+		m_stats.reserved_bytes += sizeof(BlockHeader) + size;
+		header->slab = nullptr;
+	}
+	else {
+		Slab* slab = m_partial_slabs[size_class];
+		if (!slab) slab = allocSlab(size_class);
+		if (!slab) return nullptr;
+		header = (BlockHeader*)slab->free_blocks;
+		slab->free_blocks = slab->free_blocks->next;
+		++slab->live_blocks;
+		if (!slab->free_blocks) unlinkSlab(slab);
+		header->slab = slab;
+	}
+
+	header->size = (u32)size;
+	header->size_class = size_class;
+
+	m_stats.live_bytes += size;
+	m_stats.peak_live_bytes = maximum(m_stats.peak_live_bytes, m_stats.live_bytes);
+	++m_stats.live_allocations;
+	++m_stats.total_allocations;
+	++m_stats.size_classes[size_class];
+	return header + 1;
+}
+
+void JSAllocator::deallocate(void* ptr) {
+	if (!ptr) return;
+
+	BlockHeader* header = (BlockHeader*)ptr - 1;
+	m_stats.live_bytes -= header->size;
+	--m_stats.live_allocations;
+	--m_stats.size_classes[header->size_class];
+
+	if (header->size_class == BIG_SIZE_CLASS) {
+		m_stats.reserved_bytes -= sizeof(BlockHeader) + header->size;
+		m_allocator.deallocate(header);
+		return;
+	}
+
+	Slab* slab = header->slab;
+	const bool was_full = !slab->free_blocks;
+	FreeBlock* block = (FreeBlock*)header;
+	block->next = slab->free_blocks;
+	slab->free_blocks = block;
+	--slab->live_blocks;
+	if (was_full) {
+		linkSlab(slab);
+	}
+	else if (slab->live_blocks == 0 && (slab->prev || slab->next)) {
+		// the last slab of the size class is kept, so a single block allocated and freed in a loop does not allocate slabs
+		unlinkSlab(slab);
+		m_stats.reserved_bytes -= SLAB_SIZE;
+		m_allocator.deallocate(slab);
+	}
+}
+
+void* JSAllocator::reallocate(void* ptr, size_t size) {
+	if (!ptr) return allocate(size);
+	if (size == 0) {
+		deallocate(ptr);
+		return nullptr;
+	}
+
+	ASSERT(size <= 0xffFFffFF);
+	BlockHeader* header = (BlockHeader*)ptr - 1;
+	const u32 old_size = header->size;
+	const u32 size_class = getSizeClass(size);
+
+	if (size_class == header->size_class && size_class != BIG_SIZE_CLASS) {
+		// still fits in the same block
+		header->size = (u32)size;
+		m_stats.live_bytes = m_stats.live_bytes - old_size + size;
+		m_stats.peak_live_bytes = maximum(m_stats.peak_live_bytes, m_stats.live_bytes);
+		return ptr;
+	}
+
+	if (size_class == BIG_SIZE_CLASS && header->size_class == BIG_SIZE_CLASS) {
+		header = (BlockHeader*)m_allocator.reallocate(header, sizeof(BlockHeader) + size, sizeof(BlockHeader) + old_size, alignof(BlockHeader));
+		if (!header) return nullptr;
+		header->size = (u32)size;
+		m_stats.live_bytes = m_stats.live_bytes - old_size + size;
+		m_stats.peak_live_bytes = maximum(m_stats.peak_live_bytes, m_stats.live_bytes);
+		m_stats.reserved_bytes = m_stats.reserved_bytes - old_size + size;
+		return header + 1;
+	}
+
+	void* new_ptr = allocate(size);
+	if (!new_ptr) return nullptr;
+	memcpy(new_ptr, ptr, minimum(old_size, (u32)size));
+	deallocate(ptr);
+	return new_ptr;
+}
+
+void* JSAllocator::dukAlloc(void* udata, duk_size_t size) {
+	return ((JSAllocator*)udata)->allocate(size);
+}
+
+void* JSAllocator::dukRealloc(void* udata, void* ptr, duk_size_t size) {
+	return ((JSAllocator*)udata)->reallocate(ptr, size);
+}
+
+void JSAllocator::dukFree(void* udata, void* ptr) {
+	((JSAllocator*)udata)->deallocate(ptr);
+}
+
+
+} // namespace Lumix
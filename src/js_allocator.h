@@ -0,0 +1,61 @@
+#pragma once
+
+
+#include "core/allocator.h"
+#include "core/tag_allocator.h"
+#include "duktape/duktape.h"
+
+
+namespace Lumix
+{
+
+// allocator of a Duktape heap
+// small blocks come from slab pools with power of two size classes, bigger blocks from the parent allocator
+// all blocks are 16-byte aligned, empty slabs are returned to the parent except the last one of each size class
+struct JSAllocator {
+	static constexpr u32 MIN_BLOCK_SIZE = 16;
+	static constexpr u32 SIZE_CLASS_COUNT = 6;
+	static constexpr u32 MAX_SMALL_SIZE = MIN_BLOCK_SIZE << (SIZE_CLASS_COUNT - 1);
+
+	struct Stats {
+		// sizes requested by Duktape
+		u64 live_bytes = 0;
+		u64 peak_live_bytes = 0;
+		// slabs and big blocks, including headers and free blocks
+		u64 reserved_bytes = 0;
+		u32 live_allocations = 0;
+		u64 total_allocations = 0;
+		// live allocations per size class, the last one is for blocks bigger than MAX_SMALL_SIZE
+		u32 size_classes[SIZE_CLASS_COUNT + 1] = {};
+	};
+
+	explicit JSAllocator(IAllocator& parent);
+	~JSAllocator();
+
+	void* allocate(size_t size);
+	void* reallocate(void* ptr, size_t size);
+	void deallocate(void* ptr);
+	const Stats& getStats() const { return m_stats; }
+
+	// duk_create_heap callbacks, udata is JSAllocator*
+	static void* dukAlloc(void* udata, duk_size_t size);
+	static void* dukRealloc(void* udata, void* ptr, duk_size_t size);
+	static void dukFree(void* udata, void* ptr);
+
+private:
+	struct BlockHeader;
+	struct FreeBlock;
+	struct Slab;
+
+	Slab* allocSlab(u32 size_class);
+	void linkSlab(Slab* slab);
+	void unlinkSlab(Slab* slab);
+
+	TagAllocator m_allocator;
+	// slabs with free blocks
+	Slab* m_partial_slabs[SIZE_CLASS_COUNT] = {};
+	Stats m_stats;
+};
+
+
+} // namespace Lumix
@@ -50,6 +50,11 @@ namespace Lumix {
 		EntityRef entity {JSWrapper::toType<i32>(ctx, -1)};
 		duk_pop_2(ctx);
 		auto value = JSWrapper::toType<bool>(ctx, 0);
+		if (JSCommandBuffer* commands = getCommandBuffer(ctx)) {
+			static const ComponentType cmp_type = reflection::getComponentType("property_animator");
+			commands->call<AnimationModule, bool>(module, entity, cmp_type, value, [](AnimationModule* module, EntityRef entity, bool value) { module->enablePropertyAnimator(entity, value); });
+			return 0;
+		}
 		module->enablePropertyAnimator(entity, value);
 		return 0;
 	}
@@ -80,6 +85,11 @@ namespace Lumix {
 		EntityRef entity {JSWrapper::toType<i32>(ctx, -1)};
 		duk_pop_2(ctx);
 		auto value = JSWrapper::toType<bool>(ctx, 0);
+		if (JSCommandBuffer* commands = getCommandBuffer(ctx)) {
+			static const ComponentType cmp_type = reflection::getComponentType("property_animator");
+			commands->call<AnimationModule, bool>(module, entity, cmp_type, value, [](AnimationModule* module, EntityRef entity, bool value) { module->setPropertyAnimatorLooped(entity, value); });
+			return 0;
+		}
 		module->setPropertyAnimatorLooped(entity, value);
 		return 0;
 	}
@@ -110,6 +120,11 @@ namespace Lumix {
 		EntityRef entity {JSWrapper::toType<i32>(ctx, -1)};
 		duk_pop_2(ctx);
 		auto value = JSWrapper::toType<Path>(ctx, 0);
+		if (JSCommandBuffer* commands = getCommandBuffer(ctx)) {
+			static const ComponentType cmp_type = reflection::getComponentType("property_animator");
+			commands->call<AnimationModule, Path>(module, entity, cmp_type, value, [](AnimationModule* module, EntityRef entity, Path value) { module->setPropertyAnimatorAnimation(entity, value); });
+			return 0;
+		}
 		module->setPropertyAnimatorAnimation(entity, value);
 		return 0;
 	}
@@ -140,6 +155,11 @@ namespace Lumix {
 		EntityRef entity {JSWrapper::toType<i32>(ctx, -1)};
 		duk_pop_2(ctx);
 		auto value = JSWrapper::toType<Path>(ctx, 0);
+		if (JSCommandBuffer* commands = getCommandBuffer(ctx)) {
+			static const ComponentType cmp_type = reflection::getComponentType("animator");
+			commands->call<AnimationModule, Path>(module, entity, cmp_type, value, [](AnimationModule* module, EntityRef entity, Path value) { module->setAnimatorSource(entity, value); });
+			return 0;
+		}
 		module->setAnimatorSource(entity, value);
 		return 0;
 	}
@@ -170,6 +190,11 @@ namespace Lumix {
 		EntityRef entity {JSWrapper::toType<i32>(ctx, -1)};
 		duk_pop_2(ctx);
 		auto value = JSWrapper::toType<bool>(ctx, 0);
+		if (JSCommandBuffer* commands = getCommandBuffer(ctx)) {
+			static const ComponentType cmp_type = reflection::getComponentType("animator");
+			commands->call<AnimationModule, bool>(module, entity, cmp_type, value, [](AnimationModule* module, EntityRef entity, bool value) { module->setAnimatorUseRootMotion(entity, value); });
+			return 0;
+		}
 		module->setAnimatorUseRootMotion(entity, value);
 		return 0;
 	}
@@ -200,6 +225,11 @@ namespace Lumix {
 		EntityRef entity {JSWrapper::toType<i32>(ctx, -1)};
 		duk_pop_2(ctx);
 		auto value = JSWrapper::toType<u32>(ctx, 0);
+		if (JSCommandBuffer* commands = getCommandBuffer(ctx)) {
+			static const ComponentType cmp_type = reflection::getComponentType("animator");
+			commands->call<AnimationModule, u32>(module, entity, cmp_type, value, [](AnimationModule* module, EntityRef entity, u32 value) { module->setAnimatorDefaultSet(entity, value); });
+			return 0;
+		}
 		module->setAnimatorDefaultSet(entity, value);
 		return 0;
 	}
@@ -230,6 +260,11 @@ namespace Lumix {
 		EntityRef entity {JSWrapper::toType<i32>(ctx, -1)};
 		duk_pop_2(ctx);
 		auto value = JSWrapper::toType<Path>(ctx, 0);
+		if (JSCommandBuffer* commands = getCommandBuffer(ctx)) {
+			static const ComponentType cmp_type = reflection::getComponentType("animable");
+			commands->call<AnimationModule, Path>(module, entity, cmp_type, value, [](AnimationModule* module, EntityRef entity, Path value) { module->setAnimableAnimation(entity, value); });
+			return 0;
+		}
 		module->setAnimableAnimation(entity, value);
 		return 0;
 	}
@@ -260,6 +295,11 @@ namespace Lumix {
 		EntityRef entity {JSWrapper::toType<i32>(ctx, -1)};
 		duk_pop_2(ctx);
 		auto value = JSWrapper::toType<Path>(ctx, 0);
+		if (JSCommandBuffer* commands = getCommandBuffer(ctx)) {
+			static const ComponentType cmp_type = reflection::getComponentType("ambient_sound");
+			commands->call<AudioModule, Path>(module, entity, cmp_type, value, [](AudioModule* module, EntityRef entity, Path value) { module->setAmbientSoundClip(entity, value); });
+			return 0;
+		}
 		module->setAmbientSoundClip(entity, value);
 		return 0;
 	}
@@ -290,6 +330,11 @@ namespace Lumix {
 		EntityRef entity {JSWrapper::toType<i32>(ctx, -1)};
 		duk_pop_2(ctx);
 		auto value = JSWrapper::toType<bool>(ctx, 0);
+		if (JSCommandBuffer* commands = getCommandBuffer(ctx)) {
+			static const ComponentType cmp_type = reflection::getComponentType("ambient_sound");
+			commands->call<AudioModule, bool>(module, entity, cmp_type, value, [](AudioModule* module, EntityRef entity, bool value) { module->setAmbientSound3D(entity, value); });
+			return 0;
+		}
 		module->setAmbientSound3D(entity, value);
 		return 0;
 	}
@@ -320,6 +365,11 @@ namespace Lumix {
 		EntityRef entity {JSWrapper::toType<i32>(ctx, -1)};
 		duk_pop_2(ctx);
 		auto value = JSWrapper::toType<const char*>(ctx, 0);
+		if (JSCommandBuffer* commands = getCommandBuffer(ctx)) {
+			static const ComponentType cmp_type = reflection::getComponentType("lua_script_inline");
+			commands->call<LuaScriptModule, const char*>(module, entity, cmp_type, value, [](LuaScriptModule* module, EntityRef entity, const char* value) { module->setInlineScriptCode(entity, value); });
+			return 0;
+		}
 		module->setInlineScriptCode(entity, value);
 		return 0;
 	}
@@ -350,6 +400,11 @@ namespace Lumix {
 		EntityRef entity {JSWrapper::toType<i32>(ctx, -1)};
 		duk_pop_2(ctx);
 		auto value = JSWrapper::toType<bool>(ctx, 0);
+		if (JSCommandBuffer* commands = getCommandBuffer(ctx)) {
+			static const ComponentType cmp_type = reflection::getComponentType("navmesh_zone");
+			commands->call<NavigationModule, bool>(module, entity, cmp_type, value, [](NavigationModule* module, EntityRef entity, bool value) { module->setZoneAutoload(entity, value); });
+			return 0;
+		}
 		module->setZoneAutoload(entity, value);
 		return 0;
 	}
@@ -380,6 +435,11 @@ namespace Lumix {
 		EntityRef entity {JSWrapper::toType<i32>(ctx, -1)};
 		duk_pop_2(ctx);
 		auto value = JSWrapper::toType<bool>(ctx, 0);
+		if (JSCommandBuffer* commands = getCommandBuffer(ctx)) {
+			static const ComponentType cmp_type = reflection::getComponentType("navmesh_zone");
+			commands->call<NavigationModule, bool>(module, entity, cmp_type, value, [](NavigationModule* module, EntityRef entity, bool value) { module->setZoneDetailed(entity, value); });
+			return 0;
+		}
 		module->setZoneDetailed(entity, value);
 		return 0;
 	}
@@ -410,6 +470,11 @@ namespace Lumix {
 		EntityRef entity {JSWrapper::toType<i32>(ctx, -1)};
 		duk_pop_2(ctx);
 		auto value = JSWrapper::toType<float>(ctx, 0);
+		if (JSCommandBuffer* commands = getCommandBuffer(ctx)) {
+			static const ComponentType cmp_type = reflection::getComponentType("navmesh_agent");
+			commands->call<NavigationModule, float>(module, entity, cmp_type, value, [](NavigationModule* module, EntityRef entity, float value) { module->setAgentRadius(entity, value); });
+			return 0;
+		}
 		module->setAgentRadius(entity, value);
 		return 0;
 	}
@@ -440,6 +505,11 @@ namespace Lumix {
 		EntityRef entity {JSWrapper::toType<i32>(ctx, -1)};
 		duk_pop_2(ctx);
 		auto value = JSWrapper::toType<float>(ctx, 0);
+		if (JSCommandBuffer* commands = getCommandBuffer(ctx)) {
+			static const ComponentType cmp_type = reflection::getComponentType("navmesh_agent");
+			commands->call<NavigationModule, float>(module, entity, cmp_type, value, [](NavigationModule* module, EntityRef entity, float value) { module->setAgentHeight(entity, value); });
+			return 0;
+		}
 		module->setAgentHeight(entity, value);
 		return 0;
 	}
@@ -470,6 +540,11 @@ namespace Lumix {
 		EntityRef entity {JSWrapper::toType<i32>(ctx, -1)};
 		duk_pop_2(ctx);
 		auto value = JSWrapper::toType<bool>(ctx, 0);
+		if (JSCommandBuffer* commands = getCommandBuffer(ctx)) {
+			static const ComponentType cmp_type = reflection::getComponentType("navmesh_agent");
+			commands->call<NavigationModule, bool>(module, entity, cmp_type, value, [](NavigationModule* module, EntityRef entity, bool value) { module->setAgentMoveEntity(entity, value); });
+			return 0;
+		}
 		module->setAgentMoveEntity(entity, value);
 		return 0;
 	}
@@ -514,6 +589,11 @@ namespace Lumix {
 		EntityRef entity {JSWrapper::toType<i32>(ctx, -1)};
 		duk_pop_2(ctx);
 		auto value = JSWrapper::toType<Path>(ctx, 0);
+		if (JSCommandBuffer* commands = getCommandBuffer(ctx)) {
+			static const ComponentType cmp_type = reflection::getComponentType("physical_heightfield");
+			commands->call<PhysicsModule, Path>(module, entity, cmp_type, value, [](PhysicsModule* module, EntityRef entity, Path value) { module->setHeightfieldSource(entity, value); });
+			return 0;
+		}
 		module->setHeightfieldSource(entity, value);
 		return 0;
 	}
@@ -544,6 +624,11 @@ namespace Lumix {
 		EntityRef entity {JSWrapper::toType<i32>(ctx, -1)};
 		duk_pop_2(ctx);
 		auto value = JSWrapper::toType<float>(ctx, 0);
+		if (JSCommandBuffer* commands = getCommandBuffer(ctx)) {
+			static const ComponentType cmp_type = reflection::getComponentType("physical_heightfield");
+			commands->call<PhysicsModule, float>(module, entity, cmp_type, value, [](PhysicsModule* module, EntityRef entity, float value) { module->setHeightfieldXZScale(entity, value); });
+			return 0;
+		}
 		module->setHeightfieldXZScale(entity, value);
 		return 0;
 	}
@@ -574,6 +659,11 @@ namespace Lumix {
 		EntityRef entity {JSWrapper::toType<i32>(ctx, -1)};
 		duk_pop_2(ctx);
 		auto value = JSWrapper::toType<float>(ctx, 0);
+		if (JSCommandBuffer* commands = getCommandBuffer(ctx)) {
+			static const ComponentType cmp_type = reflection::getComponentType("physical_heightfield");
+			commands->call<PhysicsModule, float>(module, entity, cmp_type, value, [](PhysicsModule* module, EntityRef entity, float value) { module->setHeightfieldYScale(entity, value); });
+			return 0;
+		}
 		module->setHeightfieldYScale(entity, value);
 		return 0;
 	}
@@ -604,6 +694,11 @@ namespace Lumix {
 		EntityRef entity {JSWrapper::toType<i32>(ctx, -1)};
 		duk_pop_2(ctx);
 		auto value = JSWrapper::toType<u32>(ctx, 0);
+		if (JSCommandBuffer* commands = getCommandBuffer(ctx)) {
+			static const ComponentType cmp_type = reflection::getComponentType("physical_heightfield");
+			commands->call<PhysicsModule, u32>(module, entity, cmp_type, value, [](PhysicsModule* module, EntityRef entity, u32 value) { module->setHeightfieldLayer(entity, value); });
+			return 0;
+		}
 		module->setHeightfieldLayer(entity, value);
 		return 0;
 	}
@@ -634,6 +729,11 @@ namespace Lumix {
 		EntityRef entity {JSWrapper::toType<i32>(ctx, -1)};
 		duk_pop_2(ctx);
 		auto value = (PhysicsModule::D6Motion)JSWrapper::toType<i32>(ctx, 0);
+		if (JSCommandBuffer* commands = getCommandBuffer(ctx)) {
+			static const ComponentType cmp_type = reflection::getComponentType("d6_joint");
+			commands->call<PhysicsModule, PhysicsModule::D6Motion>(module, entity, cmp_type, value, [](PhysicsModule* module, EntityRef entity, PhysicsModule::D6Motion value) { module->setD6JointXMotion(entity, value); });
+			return 0;
+		}
 		module->setD6JointXMotion(entity, value);
 		return 0;
 	}
@@ -664,6 +764,11 @@ namespace Lumix {
 		EntityRef entity {JSWrapper::toType<i32>(ctx, -1)};
 		duk_pop_2(ctx);
 		auto value = (PhysicsModule::D6Motion)JSWrapper::toType<i32>(ctx, 0);
+		if (JSCommandBuffer* commands = getCommandBuffer(ctx)) {
+			static const ComponentType cmp_type = reflection::getComponentType("d6_joint");
+			commands->call<PhysicsModule, PhysicsModule::D6Motion>(module, entity, cmp_type, value, [](PhysicsModule* module, EntityRef entity, PhysicsModule::D6Motion value) { module->setD6JointYMotion(entity, value); });
+			return 0;
+		}
 		module->setD6JointYMotion(entity, value);
 		return 0;
 	}
@@ -694,6 +799,11 @@ namespace Lumix {
 		EntityRef entity {JSWrapper::toType<i32>(ctx, -1)};
 		duk_pop_2(ctx);
 		auto value = (PhysicsModule::D6Motion)JSWrapper::toType<i32>(ctx, 0);
+		if (JSCommandBuffer* commands = getCommandBuffer(ctx)) {
+			static const ComponentType cmp_type = reflection::getComponentType("d6_joint");
+			commands->call<PhysicsModule, PhysicsModule::D6Motion>(module, entity, cmp_type, value, [](PhysicsModule* module, EntityRef entity, PhysicsModule::D6Motion value) { module->setD6JointZMotion(entity, value); });
+			return 0;
+		}
 		module->setD6JointZMotion(entity, value);
 		return 0;
 	}
@@ -724,6 +834,11 @@ namespace Lumix {
 		EntityRef entity {JSWrapper::toType<i32>(ctx, -1)};
 		duk_pop_2(ctx);
 		auto value = (PhysicsModule::D6Motion)JSWrapper::toType<i32>(ctx, 0);
+		if (JSCommandBuffer* commands = getCommandBuffer(ctx)) {
+			static const ComponentType cmp_type = reflection::getComponentType("d6_joint");
+			commands->call<PhysicsModule, PhysicsModule::D6Motion>(module, entity, cmp_type, value, [](PhysicsModule* module, EntityRef entity, PhysicsModule::D6Motion value) { module->setD6JointSwing1Motion(entity, value); });
+			return 0;
+		}
 		module->setD6JointSwing1Motion(entity, value);
 		return 0;
 	}
@@ -754,6 +869,11 @@ namespace Lumix {
 		EntityRef entity {JSWrapper::toType<i32>(ctx, -1)};
 		duk_pop_2(ctx);
 		auto value = (PhysicsModule::D6Motion)JSWrapper::toType<i32>(ctx, 0);
+		if (JSCommandBuffer* commands = getCommandBuffer(ctx)) {
+			static const ComponentType cmp_type = reflection::getComponentType("d6_joint");
+			commands->call<PhysicsModule, PhysicsModule::D6Motion>(module, entity, cmp_type, value, [](PhysicsModule* module, EntityRef entity, PhysicsModule::D6Motion value) { module->setD6JointSwing2Motion(entity, value); });
+			return 0;
+		}
 		module->setD6JointSwing2Motion(entity, value);
 		return 0;
 	}
@@ -784,6 +904,11 @@ namespace Lumix {
 		EntityRef entity {JSWrapper::toType<i32>(ctx, -1)};
 		duk_pop_2(ctx);
 		auto value = (PhysicsModule::D6Motion)JSWrapper::toType<i32>(ctx, 0);
+		if (JSCommandBuffer* commands = getCommandBuffer(ctx)) {
+			static const ComponentType cmp_type = reflection::getComponentType("d6_joint");
+			commands->call<PhysicsModule, PhysicsModule::D6Motion>(module, entity, cmp_type, value, [](PhysicsModule* module, EntityRef entity, PhysicsModule::D6Motion value) { module->setD6JointTwistMotion(entity, value); });
+			return 0;
+		}
 		module->setD6JointTwistMotion(entity, value);
 		return 0;
 	}
@@ -814,6 +939,11 @@ namespace Lumix {
 		EntityRef entity {JSWrapper::toType<i32>(ctx, -1)};
 		duk_pop_2(ctx);
 		auto value = JSWrapper::toType<float>(ctx, 0);
+		if (JSCommandBuffer* commands = getCommandBuffer(ctx)) {
+			static const ComponentType cmp_type = reflection::getComponentType("d6_joint");
+			commands->call<PhysicsModule, float>(module, entity, cmp_type, value, [](PhysicsModule* module, EntityRef entity, float value) { module->setD6JointLinearLimit(entity, value); });
+			return 0;
+		}
 		module->setD6JointLinearLimit(entity, value);
 		return 0;
 	}
@@ -844,6 +974,11 @@ namespace Lumix {
 		EntityRef entity {JSWrapper::toType<i32>(ctx, -1)};
 		duk_pop_2(ctx);
 		auto value = JSWrapper::toType<Vec2>(ctx, 0);
+		if (JSCommandBuffer* commands = getCommandBuffer(ctx)) {
+			static const ComponentType cmp_type = reflection::getComponentType("d6_joint");
+			commands->call<PhysicsModule, Vec2>(module, entity, cmp_type, value, [](PhysicsModule* module, EntityRef entity, Vec2 value) { module->setD6JointTwistLimit(entity, value); });
+			return 0;
+		}
 		module->setD6JointTwistLimit(entity, value);
 		return 0;
 	}
@@ -874,6 +1009,11 @@ namespace Lumix {
 		EntityRef entity {JSWrapper::toType<i32>(ctx, -1)};
 		duk_pop_2(ctx);
 		auto value = JSWrapper::toType<Vec2>(ctx, 0);
+		if (JSCommandBuffer* commands = getCommandBuffer(ctx)) {
+			static const ComponentType cmp_type = reflection::getComponentType("d6_joint");
+			commands->call<PhysicsModule, Vec2>(module, entity, cmp_type, value, [](PhysicsModule* module, EntityRef entity, Vec2 value) { module->setD6JointSwingLimit(entity, value); });
+			return 0;
+		}
 		module->setD6JointSwingLimit(entity, value);
 		return 0;
 	}
@@ -904,6 +1044,11 @@ namespace Lumix {
 		EntityRef entity {JSWrapper::toType<i32>(ctx, -1)};
 		duk_pop_2(ctx);
 		auto value = JSWrapper::toType<float>(ctx, 0);
+		if (JSCommandBuffer* commands = getCommandBuffer(ctx)) {
+			static const ComponentType cmp_type = reflection::getComponentType("d6_joint");
+			commands->call<PhysicsModule, float>(module, entity, cmp_type, value, [](PhysicsModule* module, EntityRef entity, float value) { module->setD6JointDamping(entity, value); });
+			return 0;
+		}
 		module->setD6JointDamping(entity, value);
 		return 0;
 	}
@@ -934,6 +1079,11 @@ namespace Lumix {
 		EntityRef entity {JSWrapper::toType<i32>(ctx, -1)};
 		duk_pop_2(ctx);
 		auto value = JSWrapper::toType<float>(ctx, 0);
+		if (JSCommandBuffer* commands = getCommandBuffer(ctx)) {
+			static const ComponentType cmp_type = reflection::getComponentType("d6_joint");
+			commands->call<PhysicsModule, float>(module, entity, cmp_type, value, [](PhysicsModule* module, EntityRef entity, float value) { module->setD6JointStiffness(entity, value); });
+			return 0;
+		}
 		module->setD6JointStiffness(entity, value);
 		return 0;
 	}
@@ -964,6 +1114,11 @@ namespace Lumix {
 		EntityRef entity {JSWrapper::toType<i32>(ctx, -1)};
 		duk_pop_2(ctx);
 		auto value = JSWrapper::toType<float>(ctx, 0);
+		if (JSCommandBuffer* commands = getCommandBuffer(ctx)) {
+			static const ComponentType cmp_type = reflection::getComponentType("d6_joint");
+			commands->call<PhysicsModule, float>(module, entity, cmp_type, value, [](PhysicsModule* module, EntityRef entity, float value) { module->setD6JointRestitution(entity, value); });
+			return 0;
+		}
 		module->setD6JointRestitution(entity, value);
 		return 0;
 	}
@@ -994,6 +1149,11 @@ namespace Lumix {
 		EntityRef entity {JSWrapper::toType<i32>(ctx, -1)};
 		duk_pop_2(ctx);
 		auto value = JSWrapper::toType<EntityPtr>(ctx, 0);
+		if (JSCommandBuffer* commands = getCommandBuffer(ctx)) {
+			static const ComponentType cmp_type = reflection::getComponentType("d6_joint");
+			commands->call<PhysicsModule, EntityPtr>(module, entity, cmp_type, value, [](PhysicsModule* module, EntityRef entity, EntityPtr value) { module->setD6JointConnectedBody(entity, value); });
+			return 0;
+		}
 		module->setD6JointConnectedBody(entity, value);
 		return 0;
 	}
@@ -1024,6 +1184,11 @@ namespace Lumix {
 		EntityRef entity {JSWrapper::toType<i32>(ctx, -1)};
 		duk_pop_2(ctx);
 		auto value = JSWrapper::toType<Vec3>(ctx, 0);
+		if (JSCommandBuffer* commands = getCommandBuffer(ctx)) {
+			static const ComponentType cmp_type = reflection::getComponentType("d6_joint");
+			commands->call<PhysicsModule, Vec3>(module, entity, cmp_type, value, [](PhysicsModule* module, EntityRef entity, Vec3 value) { module->setD6JointAxisPosition(entity, value); });
+			return 0;
+		}
 		module->setD6JointAxisPosition(entity, value);
 		return 0;
 	}
@@ -1054,6 +1219,11 @@ namespace Lumix {
 		EntityRef entity {JSWrapper::toType<i32>(ctx, -1)};
 		duk_pop_2(ctx);
 		auto value = JSWrapper::toType<Vec3>(ctx, 0);
+		if (JSCommandBuffer* commands = getCommandBuffer(ctx)) {
+			static const ComponentType cmp_type = reflection::getComponentType("d6_joint");
+			commands->call<PhysicsModule, Vec3>(module, entity, cmp_type, value, [](PhysicsModule* module, EntityRef entity, Vec3 value) { module->setD6JointAxisDirection(entity, value); });
+			return 0;
+		}
 		module->setD6JointAxisDirection(entity, value);
 		return 0;
 	}
@@ -1084,6 +1254,11 @@ namespace Lumix {
 		EntityRef entity {JSWrapper::toType<i32>(ctx, -1)};
 		duk_pop_2(ctx);
 		auto value = JSWrapper::toType<EntityPtr>(ctx, 0);
+		if (JSCommandBuffer* commands = getCommandBuffer(ctx)) {
+			static const ComponentType cmp_type = reflection::getComponentType("distance_joint");
+			commands->call<PhysicsModule, EntityPtr>(module, entity, cmp_type, value, [](PhysicsModule* module, EntityRef entity, EntityPtr value) { module->setDistanceJointConnectedBody(entity, value); });
+			return 0;
+		}
 		module->setDistanceJointConnectedBody(entity, value);
 		return 0;
 	}
@@ -1114,6 +1289,11 @@ namespace Lumix {
 		EntityRef entity {JSWrapper::toType<i32>(ctx, -1)};
 		duk_pop_2(ctx);
 		auto value = JSWrapper::toType<Vec3>(ctx, 0);
+		if (JSCommandBuffer* commands = getCommandBuffer(ctx)) {
+			static const ComponentType cmp_type = reflection::getComponentType("distance_joint");
+			commands->call<PhysicsModule, Vec3>(module, entity, cmp_type, value, [](PhysicsModule* module, EntityRef entity, Vec3 value) { module->setDistanceJointAxisPosition(entity, value); });
+			return 0;
+		}
 		module->setDistanceJointAxisPosition(entity, value);
 		return 0;
 	}
@@ -1144,6 +1324,11 @@ namespace Lumix {
 		EntityRef entity {JSWrapper::toType<i32>(ctx, -1)};
 		duk_pop_2(ctx);
 		auto value = JSWrapper::toType<float>(ctx, 0);
+		if (JSCommandBuffer* commands = getCommandBuffer(ctx)) {
+			static const ComponentType cmp_type = reflection::getComponentType("distance_joint");
+			commands->call<PhysicsModule, float>(module, entity, cmp_type, value, [](PhysicsModule* module, EntityRef entity, float value) { module->setDistanceJointDamping(entity, value); });
+			return 0;
+		}
 		module->setDistanceJointDamping(entity, value);
 		return 0;
 	}
@@ -1174,6 +1359,11 @@ namespace Lumix {
 		EntityRef entity {JSWrapper::toType<i32>(ctx, -1)};
 		duk_pop_2(ctx);
 		auto value = JSWrapper::toType<float>(ctx, 0);
+		if (JSCommandBuffer* commands = getCommandBuffer(ctx)) {
+			static const ComponentType cmp_type = reflection::getComponentType("distance_joint");
+			commands->call<PhysicsModule, float>(module, entity, cmp_type, value, [](PhysicsModule* module, EntityRef entity, float value) { module->setDistanceJointStiffness(entity, value); });
+			return 0;
+		}
 		module->setDistanceJointStiffness(entity, value);
 		return 0;
 	}
@@ -1204,6 +1394,11 @@ namespace Lumix {
 		EntityRef entity {JSWrapper::toType<i32>(ctx, -1)};
 		duk_pop_2(ctx);
 		auto value = JSWrapper::toType<float>(ctx, 0);
+		if (JSCommandBuffer* commands = getCommandBuffer(ctx)) {
+			static const ComponentType cmp_type = reflection::getComponentType("distance_joint");
+			commands->call<PhysicsModule, float>(module, entity, cmp_type, value, [](PhysicsModule* module, EntityRef entity, float value) { module->setDistanceJointTolerance(entity, value); });
+			return 0;
+		}
 		module->setDistanceJointTolerance(entity, value);
 		return 0;
 	}
@@ -1234,6 +1429,11 @@ namespace Lumix {
 		EntityRef entity {JSWrapper::toType<i32>(ctx, -1)};
 		duk_pop_2(ctx);
 		auto value = JSWrapper::toType<Vec2>(ctx, 0);
+		if (JSCommandBuffer* commands = getCommandBuffer(ctx)) {
+			static const ComponentType cmp_type = reflection::getComponentType("distance_joint");
+			commands->call<PhysicsModule, Vec2>(module, entity, cmp_type, value, [](PhysicsModule* module, EntityRef entity, Vec2 value) { module->setDistanceJointLimits(entity, value); });
+			return 0;
+		}
 		module->setDistanceJointLimits(entity, value);
 		return 0;
 	}
@@ -1278,6 +1478,11 @@ namespace Lumix {
 		EntityRef entity {JSWrapper::toType<i32>(ctx, -1)};
 		duk_pop_2(ctx);
 		auto value = JSWrapper::toType<EntityPtr>(ctx, 0);
+		if (JSCommandBuffer* commands = getCommandBuffer(ctx)) {
+			static const ComponentType cmp_type = reflection::getComponentType("hinge_joint");
+			commands->call<PhysicsModule, EntityPtr>(module, entity, cmp_type, value, [](PhysicsModule* module, EntityRef entity, EntityPtr value) { module->setHingeJointConnectedBody(entity, value); });
+			return 0;
+		}
 		module->setHingeJointConnectedBody(entity, value);
 		return 0;
 	}
@@ -1308,6 +1513,11 @@ namespace Lumix {
 		EntityRef entity {JSWrapper::toType<i32>(ctx, -1)};
 		duk_pop_2(ctx);
 		auto value = JSWrapper::toType<Vec3>(ctx, 0);
+		if (JSCommandBuffer* commands = getCommandBuffer(ctx)) {
+			static const ComponentType cmp_type = reflection::getComponentType("hinge_joint");
+			commands->call<PhysicsModule, Vec3>(module, entity, cmp_type, value, [](PhysicsModule* module, EntityRef entity, Vec3 value) { module->setHingeJointAxisPosition(entity, value); });
+			return 0;
+		}
 		module->setHingeJointAxisPosition(entity, value);
 		return 0;
 	}
@@ -1338,6 +1548,11 @@ namespace Lumix {
 		EntityRef entity {JSWrapper::toType<i32>(ctx, -1)};
 		duk_pop_2(ctx);
 		auto value = JSWrapper::toType<Vec3>(ctx, 0);
+		if (JSCommandBuffer* commands = getCommandBuffer(ctx)) {
+			static const ComponentType cmp_type = reflection::getComponentType("hinge_joint");
+			commands->call<PhysicsModule, Vec3>(module, entity, cmp_type, value, [](PhysicsModule* module, EntityRef entity, Vec3 value) { module->setHingeJointAxisDirection(entity, value); });
+			return 0;
+		}
 		module->setHingeJointAxisDirection(entity, value);
 		return 0;
 	}
@@ -1368,6 +1583,11 @@ namespace Lumix {
 		EntityRef entity {JSWrapper::toType<i32>(ctx, -1)};
 		duk_pop_2(ctx);
 		auto value = JSWrapper::toType<float>(ctx, 0);
+		if (JSCommandBuffer* commands = getCommandBuffer(ctx)) {
+			static const ComponentType cmp_type = reflection::getComponentType("hinge_joint");
+			commands->call<PhysicsModule, float>(module, entity, cmp_type, value, [](PhysicsModule* module, EntityRef entity, float value) { module->setHingeJointDamping(entity, value); });
+			return 0;
+		}
 		module->setHingeJointDamping(entity, value);
 		return 0;
 	}
@@ -1398,6 +1618,11 @@ namespace Lumix {
 		EntityRef entity {JSWrapper::toType<i32>(ctx, -1)};
 		duk_pop_2(ctx);
 		auto value = JSWrapper::toType<float>(ctx, 0);
+		if (JSCommandBuffer* commands = getCommandBuffer(ctx)) {
+			static const ComponentType cmp_type = reflection::getComponentType("hinge_joint");
+			commands->call<PhysicsModule, float>(module, entity, cmp_type, value, [](PhysicsModule* module, EntityRef entity, float value) { module->setHingeJointStiffness(entity, value); });
+			return 0;
+		}
 		module->setHingeJointStiffness(entity, value);
 		return 0;
 	}
@@ -1428,6 +1653,11 @@ namespace Lumix {
 		EntityRef entity {JSWrapper::toType<i32>(ctx, -1)};
 		duk_pop_2(ctx);
 		auto value = JSWrapper::toType<bool>(ctx, 0);
+		if (JSCommandBuffer* commands = getCommandBuffer(ctx)) {
+			static const ComponentType cmp_type = reflection::getComponentType("hinge_joint");
+			commands->call<PhysicsModule, bool>(module, entity, cmp_type, value, [](PhysicsModule* module, EntityRef entity, bool value) { module->setHingeJointUseLimit(entity, value); });
+			return 0;
+		}
 		module->setHingeJointUseLimit(entity, value);
 		return 0;
 	}
@@ -1458,6 +1688,11 @@ namespace Lumix {
 		EntityRef entity {JSWrapper::toType<i32>(ctx, -1)};
 		duk_pop_2(ctx);
 		auto value = JSWrapper::toType<Vec2>(ctx, 0);
+		if (JSCommandBuffer* commands = getCommandBuffer(ctx)) {
+			static const ComponentType cmp_type = reflection::getComponentType("hinge_joint");
+			commands->call<PhysicsModule, Vec2>(module, entity, cmp_type, value, [](PhysicsModule* module, EntityRef entity, Vec2 value) { module->setHingeJointLimit(entity, value); });
+			return 0;
+		}
 		module->setHingeJointLimit(entity, value);
 		return 0;
 	}
@@ -1488,6 +1723,11 @@ namespace Lumix {
 		EntityRef entity {JSWrapper::toType<i32>(ctx, -1)};
 		duk_pop_2(ctx);
 		auto value = JSWrapper::toType<EntityPtr>(ctx, 0);
+		if (JSCommandBuffer* commands = getCommandBuffer(ctx)) {
+			static const ComponentType cmp_type = reflection::getComponentType("spherical_joint");
+			commands->call<PhysicsModule, EntityPtr>(module, entity, cmp_type, value, [](PhysicsModule* module, EntityRef entity, EntityPtr value) { module->setSphericalJointConnectedBody(entity, value); });
+			return 0;
+		}
 		module->setSphericalJointConnectedBody(entity, value);
 		return 0;
 	}
@@ -1518,6 +1758,11 @@ namespace Lumix {
 		EntityRef entity {JSWrapper::toType<i32>(ctx, -1)};
 		duk_pop_2(ctx);
 		auto value = JSWrapper::toType<Vec3>(ctx, 0);
+		if (JSCommandBuffer* commands = getCommandBuffer(ctx)) {
+			static const ComponentType cmp_type = reflection::getComponentType("spherical_joint");
+			commands->call<PhysicsModule, Vec3>(module, entity, cmp_type, value, [](PhysicsModule* module, EntityRef entity, Vec3 value) { module->setSphericalJointAxisPosition(entity, value); });
+			return 0;
+		}
 		module->setSphericalJointAxisPosition(entity, value);
 		return 0;
 	}
@@ -1548,6 +1793,11 @@ namespace Lumix {
 		EntityRef entity {JSWrapper::toType<i32>(ctx, -1)};
 		duk_pop_2(ctx);
 		auto value = JSWrapper::toType<Vec3>(ctx, 0);
+		if (JSCommandBuffer* commands = getCommandBuffer(ctx)) {
+			static const ComponentType cmp_type = reflection::getComponentType("spherical_joint");
+			commands->call<PhysicsModule, Vec3>(module, entity, cmp_type, value, [](PhysicsModule* module, EntityRef entity, Vec3 value) { module->setSphericalJointAxisDirection(entity, value); });
+			return 0;
+		}
 		module->setSphericalJointAxisDirection(entity, value);
 		return 0;
 	}
@@ -1578,6 +1828,11 @@ namespace Lumix {
 		EntityRef entity {JSWrapper::toType<i32>(ctx, -1)};
 		duk_pop_2(ctx);
 		auto value = JSWrapper::toType<bool>(ctx, 0);
+		if (JSCommandBuffer* commands = getCommandBuffer(ctx)) {
+			static const ComponentType cmp_type = reflection::getComponentType("spherical_joint");
+			commands->call<PhysicsModule, bool>(module, entity, cmp_type, value, [](PhysicsModule* module, EntityRef entity, bool value) { module->setSphericalJointUseLimit(entity, value); });
+			return 0;
+		}
 		module->setSphericalJointUseLimit(entity, value);
 		return 0;
 	}
@@ -1608,6 +1863,11 @@ namespace Lumix {
 		EntityRef entity {JSWrapper::toType<i32>(ctx, -1)};
 		duk_pop_2(ctx);
 		auto value = JSWrapper::toType<Vec2>(ctx, 0);
+		if (JSCommandBuffer* commands = getCommandBuffer(ctx)) {
+			static const ComponentType cmp_type = reflection::getComponentType("spherical_joint");
+			commands->call<PhysicsModule, Vec2>(module, entity, cmp_type, value, [](PhysicsModule* module, EntityRef entity, Vec2 value) { module->setSphericalJointLimit(entity, value); });
+			return 0;
+		}
 		module->setSphericalJointLimit(entity, value);
 		return 0;
 	}
@@ -1638,6 +1898,11 @@ namespace Lumix {
 		EntityRef entity {JSWrapper::toType<i32>(ctx, -1)};
 		duk_pop_2(ctx);
 		auto value = JSWrapper::toType<u32>(ctx, 0);
+		if (JSCommandBuffer* commands = getCommandBuffer(ctx)) {
+			static const ComponentType cmp_type = reflection::getComponentType("physical_controller");
+			commands->call<PhysicsModule, u32>(module, entity, cmp_type, value, [](PhysicsModule* module, EntityRef entity, u32 value) { module->setControllerLayer(entity, value); });
+			return 0;
+		}
 		module->setControllerLayer(entity, value);
 		return 0;
 	}
@@ -1668,6 +1933,11 @@ namespace Lumix {
 		EntityRef entity {JSWrapper::toType<i32>(ctx, -1)};
 		duk_pop_2(ctx);
 		auto value = JSWrapper::toType<float>(ctx, 0);
+		if (JSCommandBuffer* commands = getCommandBuffer(ctx)) {
+			static const ComponentType cmp_type = reflection::getComponentType("physical_controller");
+			commands->call<PhysicsModule, float>(module, entity, cmp_type, value, [](PhysicsModule* module, EntityRef entity, float value) { module->setControllerRadius(entity, value); });
+			return 0;
+		}
 		module->setControllerRadius(entity, value);
 		return 0;
 	}
@@ -1698,6 +1968,11 @@ namespace Lumix {
 		EntityRef entity {JSWrapper::toType<i32>(ctx, -1)};
 		duk_pop_2(ctx);
 		auto value = JSWrapper::toType<float>(ctx, 0);
+		if (JSCommandBuffer* commands = getCommandBuffer(ctx)) {
+			static const ComponentType cmp_type = reflection::getComponentType("physical_controller");
+			commands->call<PhysicsModule, float>(module, entity, cmp_type, value, [](PhysicsModule* module, EntityRef entity, float value) { module->setControllerHeight(entity, value); });
+			return 0;
+		}
 		module->setControllerHeight(entity, value);
 		return 0;
 	}
@@ -1728,6 +2003,11 @@ namespace Lumix {
 		EntityRef entity {JSWrapper::toType<i32>(ctx, -1)};
 		duk_pop_2(ctx);
 		auto value = JSWrapper::toType<bool>(ctx, 0);
+		if (JSCommandBuffer* commands = getCommandBuffer(ctx)) {
+			static const ComponentType cmp_type = reflection::getComponentType("physical_controller");
+			commands->call<PhysicsModule, bool>(module, entity, cmp_type, value, [](PhysicsModule* module, EntityRef entity, bool value) { module->setControllerCustomGravity(entity, value); });
+			return 0;
+		}
 		module->setControllerCustomGravity(entity, value);
 		return 0;
 	}
@@ -1758,6 +2038,11 @@ namespace Lumix {
 		EntityRef entity {JSWrapper::toType<i32>(ctx, -1)};
 		duk_pop_2(ctx);
 		auto value = JSWrapper::toType<float>(ctx, 0);
+		if (JSCommandBuffer* commands = getCommandBuffer(ctx)) {
+			static const ComponentType cmp_type = reflection::getComponentType("physical_controller");
+			commands->call<PhysicsModule, float>(module, entity, cmp_type, value, [](PhysicsModule* module, EntityRef entity, float value) { module->setControllerCustomGravityAcceleration(entity, value); });
+			return 0;
+		}
 		module->setControllerCustomGravityAcceleration(entity, value);
 		return 0;
 	}
@@ -1788,6 +2073,11 @@ namespace Lumix {
 		EntityRef entity {JSWrapper::toType<i32>(ctx, -1)};
 		duk_pop_2(ctx);
 		auto value = JSWrapper::toType<bool>(ctx, 0);
+		if (JSCommandBuffer* commands = getCommandBuffer(ctx)) {
+			static const ComponentType cmp_type = reflection::getComponentType("physical_controller");
+			commands->call<PhysicsModule, bool>(module, entity, cmp_type, value, [](PhysicsModule* module, EntityRef entity, bool value) { module->setControllerUseRootMotion(entity, value); });
+			return 0;
+		}
 		module->setControllerUseRootMotion(entity, value);
 		return 0;
 	}
@@ -1846,6 +2136,11 @@ namespace Lumix {
 		EntityRef entity {JSWrapper::toType<i32>(ctx, -1)};
 		duk_pop_2(ctx);
 		auto value = JSWrapper::toType<u32>(ctx, 0);
+		if (JSCommandBuffer* commands = getCommandBuffer(ctx)) {
+			static const ComponentType cmp_type = reflection::getComponentType("rigid_actor");
+			commands->call<PhysicsModule, u32>(module, entity, cmp_type, value, [](PhysicsModule* module, EntityRef entity, u32 value) { module->setActorLayer(entity, value); });
+			return 0;
+		}
 		module->setActorLayer(entity, value);
 		return 0;
 	}
@@ -1876,6 +2171,11 @@ namespace Lumix {
 		EntityRef entity {JSWrapper::toType<i32>(ctx, -1)};
 		duk_pop_2(ctx);
 		auto value = (PhysicsModule::DynamicType)JSWrapper::toType<i32>(ctx, 0);
+		if (JSCommandBuffer* commands = getCommandBuffer(ctx)) {
+			static const ComponentType cmp_type = reflection::getComponentType("rigid_actor");
+			commands->call<PhysicsModule, PhysicsModule::DynamicType>(module, entity, cmp_type, value, [](PhysicsModule* module, EntityRef entity, PhysicsModule::DynamicType value) { module->setActorDynamicType(entity, value); });
+			return 0;
+		}
 		module->setActorDynamicType(entity, value);
 		return 0;
 	}
@@ -1906,6 +2206,11 @@ namespace Lumix {
 		EntityRef entity {JSWrapper::toType<i32>(ctx, -1)};
 		duk_pop_2(ctx);
 		auto value = JSWrapper::toType<bool>(ctx, 0);
+		if (JSCommandBuffer* commands = getCommandBuffer(ctx)) {
+			static const ComponentType cmp_type = reflection::getComponentType("rigid_actor");
+			commands->call<PhysicsModule, bool>(module, entity, cmp_type, value, [](PhysicsModule* module, EntityRef entity, bool value) { module->setActorIsTrigger(entity, value); });
+			return 0;
+		}
 		module->setActorIsTrigger(entity, value);
 		return 0;
 	}
@@ -1936,6 +2241,11 @@ namespace Lumix {
 		EntityRef entity {JSWrapper::toType<i32>(ctx, -1)};
 		duk_pop_2(ctx);
 		auto value = JSWrapper::toType<Path>(ctx, 0);
+		if (JSCommandBuffer* commands = getCommandBuffer(ctx)) {
+			static const ComponentType cmp_type = reflection::getComponentType("rigid_actor");
+			commands->call<PhysicsModule, Path>(module, entity, cmp_type, value, [](PhysicsModule* module, EntityRef entity, Path value) { module->setActorMesh(entity, value); });
+			return 0;
+		}
 		module->setActorMesh(entity, value);
 		return 0;
 	}
@@ -1966,6 +2276,11 @@ namespace Lumix {
 		EntityRef entity {JSWrapper::toType<i32>(ctx, -1)};
 		duk_pop_2(ctx);
 		auto value = JSWrapper::toType<Path>(ctx, 0);
+		if (JSCommandBuffer* commands = getCommandBuffer(ctx)) {
+			static const ComponentType cmp_type = reflection::getComponentType("rigid_actor");
+			commands->call<PhysicsModule, Path>(module, entity, cmp_type, value, [](PhysicsModule* module, EntityRef entity, Path value) { module->setActorMaterial(entity, value); });
+			return 0;
+		}
 		module->setActorMaterial(entity, value);
 		return 0;
 	}
@@ -1996,6 +2311,11 @@ namespace Lumix {
 		EntityRef entity {JSWrapper::toType<i32>(ctx, -1)};
 		duk_pop_2(ctx);
 		auto value = JSWrapper::toType<bool>(ctx, 0);
+		if (JSCommandBuffer* commands = getCommandBuffer(ctx)) {
+			static const ComponentType cmp_type = reflection::getComponentType("rigid_actor");
+			commands->call<PhysicsModule, bool>(module, entity, cmp_type, value, [](PhysicsModule* module, EntityRef entity, bool value) { module->setActorCCD(entity, value); });
+			return 0;
+		}
 		module->setActorCCD(entity, value);
 		return 0;
 	}
@@ -2026,6 +2346,11 @@ namespace Lumix {
 		EntityRef entity {JSWrapper::toType<i32>(ctx, -1)};
 		duk_pop_2(ctx);
 		auto value = JSWrapper::toType<float>(ctx, 0);
+		if (JSCommandBuffer* commands = getCommandBuffer(ctx)) {
+			static const ComponentType cmp_type = reflection::getComponentType("wheel");
+			commands->call<PhysicsModule, float>(module, entity, cmp_type, value, [](PhysicsModule* module, EntityRef entity, float value) { module->setWheelSpringStrength(entity, value); });
+			return 0;
+		}
 		module->setWheelSpringStrength(entity, value);
 		return 0;
 	}
@@ -2056,6 +2381,11 @@ namespace Lumix {
 		EntityRef entity {JSWrapper::toType<i32>(ctx, -1)};
 		duk_pop_2(ctx);
 		auto value = JSWrapper::toType<float>(ctx, 0);
+		if (JSCommandBuffer* commands = getCommandBuffer(ctx)) {
+			static const ComponentType cmp_type = reflection::getComponentType("wheel");
+			commands->call<PhysicsModule, float>(module, entity, cmp_type, value, [](PhysicsModule* module, EntityRef entity, float value) { module->setWheelSpringMaxCompression(entity, value); });
+			return 0;
+		}
 		module->setWheelSpringMaxCompression(entity, value);
 		return 0;
 	}
@@ -2086,6 +2416,11 @@ namespace Lumix {
 		EntityRef entity {JSWrapper::toType<i32>(ctx, -1)};
 		duk_pop_2(ctx);
 		auto value = JSWrapper::toType<float>(ctx, 0);
+		if (JSCommandBuffer* commands = getCommandBuffer(ctx)) {
+			static const ComponentType cmp_type = reflection::getComponentType("wheel");
+			commands->call<PhysicsModule, float>(module, entity, cmp_type, value, [](PhysicsModule* module, EntityRef entity, float value) { module->setWheelSpringMaxDroop(entity, value); });
+			return 0;
+		}
 		module->setWheelSpringMaxDroop(entity, value);
 		return 0;
 	}
@@ -2116,6 +2451,11 @@ namespace Lumix {
 		EntityRef entity {JSWrapper::toType<i32>(ctx, -1)};
 		duk_pop_2(ctx);
 		auto value = JSWrapper::toType<float>(ctx, 0);
+		if (JSCommandBuffer* commands = getCommandBuffer(ctx)) {
+			static const ComponentType cmp_type = reflection::getComponentType("wheel");
+			commands->call<PhysicsModule, float>(module, entity, cmp_type, value, [](PhysicsModule* module, EntityRef entity, float value) { module->setWheelSpringDamperRate(entity, value); });
+			return 0;
+		}
 		module->setWheelSpringDamperRate(entity, value);
 		return 0;
 	}
@@ -2146,6 +2486,11 @@ namespace Lumix {
 		EntityRef entity {JSWrapper::toType<i32>(ctx, -1)};
 		duk_pop_2(ctx);
 		auto value = JSWrapper::toType<float>(ctx, 0);
+		if (JSCommandBuffer* commands = getCommandBuffer(ctx)) {
+			static const ComponentType cmp_type = reflection::getComponentType("wheel");
+			commands->call<PhysicsModule, float>(module, entity, cmp_type, value, [](PhysicsModule* module, EntityRef entity, float value) { module->setWheelRadius(entity, value); });
+			return 0;
+		}
 		module->setWheelRadius(entity, value);
 		return 0;
 	}
@@ -2176,6 +2521,11 @@ namespace Lumix {
 		EntityRef entity {JSWrapper::toType<i32>(ctx, -1)};
 		duk_pop_2(ctx);
 		auto value = JSWrapper::toType<float>(ctx, 0);
+		if (JSCommandBuffer* commands = getCommandBuffer(ctx)) {
+			static const ComponentType cmp_type = reflection::getComponentType("wheel");
+			commands->call<PhysicsModule, float>(module, entity, cmp_type, value, [](PhysicsModule* module, EntityRef entity, float value) { module->setWheelWidth(entity, value); });
+			return 0;
+		}
 		module->setWheelWidth(entity, value);
 		return 0;
 	}
@@ -2206,6 +2556,11 @@ namespace Lumix {
 		EntityRef entity {JSWrapper::toType<i32>(ctx, -1)};
 		duk_pop_2(ctx);
 		auto value = JSWrapper::toType<float>(ctx, 0);
+		if (JSCommandBuffer* commands = getCommandBuffer(ctx)) {
+			static const ComponentType cmp_type = reflection::getComponentType("wheel");
+			commands->call<PhysicsModule, float>(module, entity, cmp_type, value, [](PhysicsModule* module, EntityRef entity, float value) { module->setWheelMass(entity, value); });
+			return 0;
+		}
 		module->setWheelMass(entity, value);
 		return 0;
 	}
@@ -2236,6 +2591,11 @@ namespace Lumix {
 		EntityRef entity {JSWrapper::toType<i32>(ctx, -1)};
 		duk_pop_2(ctx);
 		auto value = JSWrapper::toType<float>(ctx, 0);
+		if (JSCommandBuffer* commands = getCommandBuffer(ctx)) {
+			static const ComponentType cmp_type = reflection::getComponentType("wheel");
+			commands->call<PhysicsModule, float>(module, entity, cmp_type, value, [](PhysicsModule* module, EntityRef entity, float value) { module->setWheelMOI(entity, value); });
+			return 0;
+		}
 		module->setWheelMOI(entity, value);
 		return 0;
 	}
@@ -2266,6 +2626,11 @@ namespace Lumix {
 		EntityRef entity {JSWrapper::toType<i32>(ctx, -1)};
 		duk_pop_2(ctx);
 		auto value = (PhysicsModule::WheelSlot)JSWrapper::toType<i32>(ctx, 0);
+		if (JSCommandBuffer* commands = getCommandBuffer(ctx)) {
+			static const ComponentType cmp_type = reflection::getComponentType("wheel");
+			commands->call<PhysicsModule, PhysicsModule::WheelSlot>(module, entity, cmp_type, value, [](PhysicsModule* module, EntityRef entity, PhysicsModule::WheelSlot value) { module->setWheelSlot(entity, value); });
+			return 0;
+		}
 		module->setWheelSlot(entity, value);
 		return 0;
 	}
@@ -2310,6 +2675,11 @@ namespace Lumix {
 		EntityRef entity {JSWrapper::toType<i32>(ctx, -1)};
 		duk_pop_2(ctx);
 		auto value = JSWrapper::toType<float>(ctx, 0);
+		if (JSCommandBuffer* commands = getCommandBuffer(ctx)) {
+			static const ComponentType cmp_type = reflection::getComponentType("vehicle");
+			commands->call<PhysicsModule, float>(module, entity, cmp_type, value, [](PhysicsModule* module, EntityRef entity, float value) { module->setVehiclePeakTorque(entity, value); });
+			return 0;
+		}
 		module->setVehiclePeakTorque(entity, value);
 		return 0;
 	}
@@ -2340,6 +2710,11 @@ namespace Lumix {
 		EntityRef entity {JSWrapper::toType<i32>(ctx, -1)};
 		duk_pop_2(ctx);
 		auto value = JSWrapper::toType<float>(ctx, 0);
+		if (JSCommandBuffer* commands = getCommandBuffer(ctx)) {
+			static const ComponentType cmp_type = reflection::getComponentType("vehicle");
+			commands->call<PhysicsModule, float>(module, entity, cmp_type, value, [](PhysicsModule* module, EntityRef entity, float value) { module->setVehicleMaxRPM(entity, value); });
+			return 0;
+		}
 		module->setVehicleMaxRPM(entity, value);
 		return 0;
 	}
@@ -2412,6 +2787,11 @@ namespace Lumix {
 		EntityRef entity {JSWrapper::toType<i32>(ctx, -1)};
 		duk_pop_2(ctx);
 		auto value = JSWrapper::toType<Path>(ctx, 0);
+		if (JSCommandBuffer* commands = getCommandBuffer(ctx)) {
+			static const ComponentType cmp_type = reflection::getComponentType("vehicle");
+			commands->call<PhysicsModule, Path>(module, entity, cmp_type, value, [](PhysicsModule* module, EntityRef entity, Path value) { module->setVehicleChassis(entity, value); });
+			return 0;
+		}
 		module->setVehicleChassis(entity, value);
 		return 0;
 	}
@@ -2442,6 +2822,11 @@ namespace Lumix {
 		EntityRef entity {JSWrapper::toType<i32>(ctx, -1)};
 		duk_pop_2(ctx);
 		auto value = JSWrapper::toType<float>(ctx, 0);
+		if (JSCommandBuffer* commands = getCommandBuffer(ctx)) {
+			static const ComponentType cmp_type = reflection::getComponentType("vehicle");
+			commands->call<PhysicsModule, float>(module, entity, cmp_type, value, [](PhysicsModule* module, EntityRef entity, float value) { module->setVehicleMass(entity, value); });
+			return 0;
+		}
 		module->setVehicleMass(entity, value);
 		return 0;
 	}
@@ -2472,6 +2857,11 @@ namespace Lumix {
 		EntityRef entity {JSWrapper::toType<i32>(ctx, -1)};
 		duk_pop_2(ctx);
 		auto value = JSWrapper::toType<float>(ctx, 0);
+		if (JSCommandBuffer* commands = getCommandBuffer(ctx)) {
+			static const ComponentType cmp_type = reflection::getComponentType("vehicle");
+			commands->call<PhysicsModule, float>(module, entity, cmp_type, value, [](PhysicsModule* module, EntityRef entity, float value) { module->setVehicleMOIMultiplier(entity, value); });
+			return 0;
+		}
 		module->setVehicleMOIMultiplier(entity, value);
 		return 0;
 	}
@@ -2502,6 +2892,11 @@ namespace Lumix {
 		EntityRef entity {JSWrapper::toType<i32>(ctx, -1)};
 		duk_pop_2(ctx);
 		auto value = JSWrapper::toType<Vec3>(ctx, 0);
+		if (JSCommandBuffer* commands = getCommandBuffer(ctx)) {
+			static const ComponentType cmp_type = reflection::getComponentType("vehicle");
+			commands->call<PhysicsModule, Vec3>(module, entity, cmp_type, value, [](PhysicsModule* module, EntityRef entity, Vec3 value) { module->setVehicleCenterOfMass(entity, value); });
+			return 0;
+		}
 		module->setVehicleCenterOfMass(entity, value);
 		return 0;
 	}
@@ -2532,6 +2927,11 @@ namespace Lumix {
 		EntityRef entity {JSWrapper::toType<i32>(ctx, -1)};
 		duk_pop_2(ctx);
 		auto value = JSWrapper::toType<u32>(ctx, 0);
+		if (JSCommandBuffer* commands = getCommandBuffer(ctx)) {
+			static const ComponentType cmp_type = reflection::getComponentType("vehicle");
+			commands->call<PhysicsModule, u32>(module, entity, cmp_type, value, [](PhysicsModule* module, EntityRef entity, u32 value) { module->setVehicleWheelsLayer(entity, value); });
+			return 0;
+		}
 		module->setVehicleWheelsLayer(entity, value);
 		return 0;
 	}
@@ -2562,6 +2962,11 @@ namespace Lumix {
 		EntityRef entity {JSWrapper::toType<i32>(ctx, -1)};
 		duk_pop_2(ctx);
 		auto value = JSWrapper::toType<u32>(ctx, 0);
+		if (JSCommandBuffer* commands = getCommandBuffer(ctx)) {
+			static const ComponentType cmp_type = reflection::getComponentType("vehicle");
+			commands->call<PhysicsModule, u32>(module, entity, cmp_type, value, [](PhysicsModule* module, EntityRef entity, u32 value) { module->setVehicleChassisLayer(entity, value); });
+			return 0;
+		}
 		module->setVehicleChassisLayer(entity, value);
 		return 0;
 	}
@@ -2592,6 +2997,11 @@ namespace Lumix {
 		EntityRef entity {JSWrapper::toType<i32>(ctx, -1)};
 		duk_pop_2(ctx);
 		auto value = JSWrapper::toType<Vec3>(ctx, 0);
+		if (JSCommandBuffer* commands = getCommandBuffer(ctx)) {
+			static const ComponentType cmp_type = reflection::getComponentType("physical_instanced_cube");
+			commands->call<PhysicsModule, Vec3>(module, entity, cmp_type, value, [](PhysicsModule* module, EntityRef entity, Vec3 value) { module->setInstancedCubeHalfExtents(entity, value); });
+			return 0;
+		}
 		module->setInstancedCubeHalfExtents(entity, value);
 		return 0;
 	}
@@ -2622,6 +3032,11 @@ namespace Lumix {
 		EntityRef entity {JSWrapper::toType<i32>(ctx, -1)};
 		duk_pop_2(ctx);
 		auto value = JSWrapper::toType<u32>(ctx, 0);
+		if (JSCommandBuffer* commands = getCommandBuffer(ctx)) {
+			static const ComponentType cmp_type = reflection::getComponentType("physical_instanced_cube");
+			commands->call<PhysicsModule, u32>(module, entity, cmp_type, value, [](PhysicsModule* module, EntityRef entity, u32 value) { module->setInstancedCubeLayer(entity, value); });
+			return 0;
+		}
 		module->setInstancedCubeLayer(entity, value);
 		return 0;
 	}
@@ -2652,6 +3067,11 @@ namespace Lumix {
 		EntityRef entity {JSWrapper::toType<i32>(ctx, -1)};
 		duk_pop_2(ctx);
 		auto value = JSWrapper::toType<u32>(ctx, 0);
+		if (JSCommandBuffer* commands = getCommandBuffer(ctx)) {
+			static const ComponentType cmp_type = reflection::getComponentType("physical_instanced_mesh");
+			commands->call<PhysicsModule, u32>(module, entity, cmp_type, value, [](PhysicsModule* module, EntityRef entity, u32 value) { module->setInstancedMeshLayer(entity, value); });
+			return 0;
+		}
 		module->setInstancedMeshLayer(entity, value);
 		return 0;
 	}
@@ -2682,6 +3102,11 @@ namespace Lumix {
 		EntityRef entity {JSWrapper::toType<i32>(ctx, -1)};
 		duk_pop_2(ctx);
 		auto value = JSWrapper::toType<Path>(ctx, 0);
+		if (JSCommandBuffer* commands = getCommandBuffer(ctx)) {
+			static const ComponentType cmp_type = reflection::getComponentType("physical_instanced_mesh");
+			commands->call<PhysicsModule, Path>(module, entity, cmp_type, value, [](PhysicsModule* module, EntityRef entity, Path value) { module->setInstancedMeshGeomPath(entity, value); });
+			return 0;
+		}
 		module->setInstancedMeshGeomPath(entity, value);
 		return 0;
 	}
@@ -2740,6 +3165,11 @@ namespace Lumix {
 		EntityRef entity {JSWrapper::toType<i32>(ctx, -1)};
 		duk_pop_2(ctx);
 		auto value = JSWrapper::toType<Path>(ctx, 0);
+		if (JSCommandBuffer* commands = getCommandBuffer(ctx)) {
+			static const ComponentType cmp_type = reflection::getComponentType("decal");
+			commands->call<RenderModule, Path>(module, entity, cmp_type, value, [](RenderModule* module, EntityRef entity, Path value) { module->setDecalMaterialPath(entity, value); });
+			return 0;
+		}
 		module->setDecalMaterialPath(entity, value);
 		return 0;
 	}
@@ -2770,6 +3200,11 @@ namespace Lumix {
 		EntityRef entity {JSWrapper::toType<i32>(ctx, -1)};
 		duk_pop_2(ctx);
 		auto value = JSWrapper::toType<Vec3>(ctx, 0);
+		if (JSCommandBuffer* commands = getCommandBuffer(ctx)) {
+			static const ComponentType cmp_type = reflection::getComponentType("decal");
+			commands->call<RenderModule, Vec3>(module, entity, cmp_type, value, [](RenderModule* module, EntityRef entity, Vec3 value) { module->setDecalHalfExtents(entity, value); });
+			return 0;
+		}
 		module->setDecalHalfExtents(entity, value);
 		return 0;
 	}
@@ -2800,6 +3235,11 @@ namespace Lumix {
 		EntityRef entity {JSWrapper::toType<i32>(ctx, -1)};
 		duk_pop_2(ctx);
 		auto value = JSWrapper::toType<bool>(ctx, 0);
+		if (JSCommandBuffer* commands = getCommandBuffer(ctx)) {
+			static const ComponentType cmp_type = reflection::getComponentType("environment");
+			commands->call<RenderModule, bool>(module, entity, cmp_type, value, [](RenderModule* module, EntityRef entity, bool value) { module->setEnvironmentCastShadows(entity, value); });
+			return 0;
+		}
 		module->setEnvironmentCastShadows(entity, value);
 		return 0;
 	}
@@ -2830,6 +3270,11 @@ namespace Lumix {
 		EntityRef entity {JSWrapper::toType<i32>(ctx, -1)};
 		duk_pop_2(ctx);
 		auto value = JSWrapper::toType<Path>(ctx, 0);
+		if (JSCommandBuffer* commands = getCommandBuffer(ctx)) {
+			static const ComponentType cmp_type = reflection::getComponentType("environment");
+			commands->call<RenderModule, Path>(module, entity, cmp_type, value, [](RenderModule* module, EntityRef entity, Path value) { module->setEnvironmentSkyTexture(entity, value); });
+			return 0;
+		}
 		module->setEnvironmentSkyTexture(entity, value);
 		return 0;
 	}
@@ -2860,6 +3305,11 @@ namespace Lumix {
 		EntityRef entity {JSWrapper::toType<i32>(ctx, -1)};
 		duk_pop_2(ctx);
 		auto value = JSWrapper::toType<Vec4>(ctx, 0);
+		if (JSCommandBuffer* commands = getCommandBuffer(ctx)) {
+			static const ComponentType cmp_type = reflection::getComponentType("environment");
+			commands->call<RenderModule, Vec4>(module, entity, cmp_type, value, [](RenderModule* module, EntityRef entity, Vec4 value) { module->setEnvironmentShadowmapCascades(entity, value); });
+			return 0;
+		}
 		module->setEnvironmentShadowmapCascades(entity, value);
 		return 0;
 	}
@@ -2890,6 +3340,11 @@ namespace Lumix {
 		EntityRef entity {JSWrapper::toType<i32>(ctx, -1)};
 		duk_pop_2(ctx);
 		auto value = JSWrapper::toType<float>(ctx, 0);
+		if (JSCommandBuffer* commands = getCommandBuffer(ctx)) {
+			static const ComponentType cmp_type = reflection::getComponentType("point_light");
+			commands->call<RenderModule, float>(module, entity, cmp_type, value, [](RenderModule* module, EntityRef entity, float value) { module->setPointLightRange(entity, value); });
+			return 0;
+		}
 		module->setPointLightRange(entity, value);
 		return 0;
 	}
@@ -2920,6 +3375,11 @@ namespace Lumix {
 		EntityRef entity {JSWrapper::toType<i32>(ctx, -1)};
 		duk_pop_2(ctx);
 		auto value = JSWrapper::toType<bool>(ctx, 0);
+		if (JSCommandBuffer* commands = getCommandBuffer(ctx)) {
+			static const ComponentType cmp_type = reflection::getComponentType("point_light");
+			commands->call<RenderModule, bool>(module, entity, cmp_type, value, [](RenderModule* module, EntityRef entity, bool value) { module->setPointLightCastShadows(entity, value); });
+			return 0;
+		}
 		module->setPointLightCastShadows(entity, value);
 		return 0;
 	}
@@ -2950,6 +3410,11 @@ namespace Lumix {
 		EntityRef entity {JSWrapper::toType<i32>(ctx, -1)};
 		duk_pop_2(ctx);
 		auto value = JSWrapper::toType<bool>(ctx, 0);
+		if (JSCommandBuffer* commands = getCommandBuffer(ctx)) {
+			static const ComponentType cmp_type = reflection::getComponentType("point_light");
+			commands->call<RenderModule, bool>(module, entity, cmp_type, value, [](RenderModule* module, EntityRef entity, bool value) { module->setPointLightDynamic(entity, value); });
+			return 0;
+		}
 		module->setPointLightDynamic(entity, value);
 		return 0;
 	}
@@ -2980,6 +3445,11 @@ namespace Lumix {
 		EntityRef entity {JSWrapper::toType<i32>(ctx, -1)};
 		duk_pop_2(ctx);
 		auto value = JSWrapper::toType<bool>(ctx, 0);
+		if (JSCommandBuffer* commands = getCommandBuffer(ctx)) {
+			static const ComponentType cmp_type = reflection::getComponentType("reflection_probe");
+			commands->call<RenderModule, bool>(module, entity, cmp_type, value, [](RenderModule* module, EntityRef entity, bool value) { module->enableReflectionProbe(entity, value); });
+			return 0;
+		}
 		module->enableReflectionProbe(entity, value);
 		return 0;
 	}
@@ -3010,6 +3480,11 @@ namespace Lumix {
 		EntityRef entity {JSWrapper::toType<i32>(ctx, -1)};
 		duk_pop_2(ctx);
 		auto value = JSWrapper::toType<bool>(ctx, 0);
+		if (JSCommandBuffer* commands = getCommandBuffer(ctx)) {
+			static const ComponentType cmp_type = reflection::getComponentType("environment_probe");
+			commands->call<RenderModule, bool>(module, entity, cmp_type, value, [](RenderModule* module, EntityRef entity, bool value) { module->enableEnvironmentProbe(entity, value); });
+			return 0;
+		}
 		module->enableEnvironmentProbe(entity, value);
 		return 0;
 	}
@@ -3040,6 +3515,11 @@ namespace Lumix {
 		EntityRef entity {JSWrapper::toType<i32>(ctx, -1)};
 		duk_pop_2(ctx);
 		auto value = JSWrapper::toType<EntityPtr>(ctx, 0);
+		if (JSCommandBuffer* commands = getCommandBuffer(ctx)) {
+			static const ComponentType cmp_type = reflection::getComponentType("bone_attachment");
+			commands->call<RenderModule, EntityPtr>(module, entity, cmp_type, value, [](RenderModule* module, EntityRef entity, EntityPtr value) { module->setBoneAttachmentParent(entity, value); });
+			return 0;
+		}
 		module->setBoneAttachmentParent(entity, value);
 		return 0;
 	}
@@ -3070,6 +3550,11 @@ namespace Lumix {
 		EntityRef entity {JSWrapper::toType<i32>(ctx, -1)};
 		duk_pop_2(ctx);
 		auto value = JSWrapper::toType<int>(ctx, 0);
+		if (JSCommandBuffer* commands = getCommandBuffer(ctx)) {
+			static const ComponentType cmp_type = reflection::getComponentType("bone_attachment");
+			commands->call<RenderModule, int>(module, entity, cmp_type, value, [](RenderModule* module, EntityRef entity, int value) { module->setBoneAttachmentBone(entity, value); });
+			return 0;
+		}
 		module->setBoneAttachmentBone(entity, value);
 		return 0;
 	}
@@ -3100,6 +3585,11 @@ namespace Lumix {
 		EntityRef entity {JSWrapper::toType<i32>(ctx, -1)};
 		duk_pop_2(ctx);
 		auto value = JSWrapper::toType<Vec3>(ctx, 0);
+		if (JSCommandBuffer* commands = getCommandBuffer(ctx)) {
+			static const ComponentType cmp_type = reflection::getComponentType("bone_attachment");
+			commands->call<RenderModule, Vec3>(module, entity, cmp_type, value, [](RenderModule* module, EntityRef entity, Vec3 value) { module->setBoneAttachmentPosition(entity, value); });
+			return 0;
+		}
 		module->setBoneAttachmentPosition(entity, value);
 		return 0;
 	}
@@ -3130,6 +3620,11 @@ namespace Lumix {
 		EntityRef entity {JSWrapper::toType<i32>(ctx, -1)};
 		duk_pop_2(ctx);
 		auto value = JSWrapper::toType<Vec3>(ctx, 0);
+		if (JSCommandBuffer* commands = getCommandBuffer(ctx)) {
+			static const ComponentType cmp_type = reflection::getComponentType("bone_attachment");
+			commands->call<RenderModule, Vec3>(module, entity, cmp_type, value, [](RenderModule* module, EntityRef entity, Vec3 value) { module->setBoneAttachmentRotation(entity, value); });
+			return 0;
+		}
 		module->setBoneAttachmentRotation(entity, value);
 		return 0;
 	}
@@ -3160,6 +3655,11 @@ namespace Lumix {
 		EntityRef entity {JSWrapper::toType<i32>(ctx, -1)};
 		duk_pop_2(ctx);
 		auto value = JSWrapper::toType<Path>(ctx, 0);
+		if (JSCommandBuffer* commands = getCommandBuffer(ctx)) {
+			static const ComponentType cmp_type = reflection::getComponentType("particle_emitter");
+			commands->call<RenderModule, Path>(module, entity, cmp_type, value, [](RenderModule* module, EntityRef entity, Path value) { module->setParticleEmitterPath(entity, value); });
+			return 0;
+		}
 		module->setParticleEmitterPath(entity, value);
 		return 0;
 	}
@@ -3190,6 +3690,11 @@ namespace Lumix {
 		EntityRef entity {JSWrapper::toType<i32>(ctx, -1)};
 		duk_pop_2(ctx);
 		auto value = JSWrapper::toType<bool>(ctx, 0);
+		if (JSCommandBuffer* commands = getCommandBuffer(ctx)) {
+			static const ComponentType cmp_type = reflection::getComponentType("particle_emitter");
+			commands->call<RenderModule, bool>(module, entity, cmp_type, value, [](RenderModule* module, EntityRef entity, bool value) { module->setParticleEmitterAutodestroy(entity, value); });
+			return 0;
+		}
 		module->setParticleEmitterAutodestroy(entity, value);
 		return 0;
 	}
@@ -3220,6 +3725,11 @@ namespace Lumix {
 		EntityRef entity {JSWrapper::toType<i32>(ctx, -1)};
 		duk_pop_2(ctx);
 		auto value = JSWrapper::toType<Path>(ctx, 0);
+		if (JSCommandBuffer* commands = getCommandBuffer(ctx)) {
+			static const ComponentType cmp_type = reflection::getComponentType("instanced_model");
+			commands->call<RenderModule, Path>(module, entity, cmp_type, value, [](RenderModule* module, EntityRef entity, Path value) { module->setInstancedModelPath(entity, value); });
+			return 0;
+		}
 		module->setInstancedModelPath(entity, value);
 		return 0;
 	}
@@ -3250,6 +3760,11 @@ namespace Lumix {
 		EntityRef entity {JSWrapper::toType<i32>(ctx, -1)};
 		duk_pop_2(ctx);
 		auto value = JSWrapper::toType<bool>(ctx, 0);
+		if (JSCommandBuffer* commands = getCommandBuffer(ctx)) {
+			static const ComponentType cmp_type = reflection::getComponentType("model_instance");
+			commands->call<RenderModule, bool>(module, entity, cmp_type, value, [](RenderModule* module, EntityRef entity, bool value) { module->enableModelInstance(entity, value); });
+			return 0;
+		}
 		module->enableModelInstance(entity, value);
 		return 0;
 	}
@@ -3280,6 +3795,11 @@ namespace Lumix {
 		EntityRef entity {JSWrapper::toType<i32>(ctx, -1)};
 		duk_pop_2(ctx);
 		auto value = JSWrapper::toType<Path>(ctx, 0);
+		if (JSCommandBuffer* commands = getCommandBuffer(ctx)) {
+			static const ComponentType cmp_type = reflection::getComponentType("model_instance");
+			commands->call<RenderModule, Path>(module, entity, cmp_type, value, [](RenderModule* module, EntityRef entity, Path value) { module->setModelInstancePath(entity, value); });
+			return 0;
+		}
 		module->setModelInstancePath(entity, value);
 		return 0;
 	}
@@ -3310,6 +3830,11 @@ namespace Lumix {
 		EntityRef entity {JSWrapper::toType<i32>(ctx, -1)};
 		duk_pop_2(ctx);
 		auto value = JSWrapper::toType<Path>(ctx, 0);
+		if (JSCommandBuffer* commands = getCommandBuffer(ctx)) {
+			static const ComponentType cmp_type = reflection::getComponentType("curve_decal");
+			commands->call<RenderModule, Path>(module, entity, cmp_type, value, [](RenderModule* module, EntityRef entity, Path value) { module->setCurveDecalMaterialPath(entity, value); });
+			return 0;
+		}
 		module->setCurveDecalMaterialPath(entity, value);
 		return 0;
 	}
@@ -3340,6 +3865,11 @@ namespace Lumix {
 		EntityRef entity {JSWrapper::toType<i32>(ctx, -1)};
 		duk_pop_2(ctx);
 		auto value = JSWrapper::toType<float>(ctx, 0);
+		if (JSCommandBuffer* commands = getCommandBuffer(ctx)) {
+			static const ComponentType cmp_type = reflection::getComponentType("curve_decal");
+			commands->call<RenderModule, float>(module, entity, cmp_type, value, [](RenderModule* module, EntityRef entity, float value) { module->setCurveDecalHalfExtents(entity, value); });
+			return 0;
+		}
 		module->setCurveDecalHalfExtents(entity, value);
 		return 0;
 	}
@@ -3370,6 +3900,11 @@ namespace Lumix {
 		EntityRef entity {JSWrapper::toType<i32>(ctx, -1)};
 		duk_pop_2(ctx);
 		auto value = JSWrapper::toType<Vec2>(ctx, 0);
+		if (JSCommandBuffer* commands = getCommandBuffer(ctx)) {
+			static const ComponentType cmp_type = reflection::getComponentType("curve_decal");
+			commands->call<RenderModule, Vec2>(module, entity, cmp_type, value, [](RenderModule* module, EntityRef entity, Vec2 value) { module->setCurveDecalUVScale(entity, value); });
+			return 0;
+		}
 		module->setCurveDecalUVScale(entity, value);
 		return 0;
 	}
@@ -3400,6 +3935,11 @@ namespace Lumix {
 		EntityRef entity {JSWrapper::toType<i32>(ctx, -1)};
 		duk_pop_2(ctx);
 		auto value = JSWrapper::toType<Vec2>(ctx, 0);
+		if (JSCommandBuffer* commands = getCommandBuffer(ctx)) {
+			static const ComponentType cmp_type = reflection::getComponentType("curve_decal");
+			commands->call<RenderModule, Vec2>(module, entity, cmp_type, value, [](RenderModule* module, EntityRef entity, Vec2 value) { module->setCurveDecalBezierP0(entity, value); });
+			return 0;
+		}
 		module->setCurveDecalBezierP0(entity, value);
 		return 0;
 	}
@@ -3430,6 +3970,11 @@ namespace Lumix {
 		EntityRef entity {JSWrapper::toType<i32>(ctx, -1)};
 		duk_pop_2(ctx);
 		auto value = JSWrapper::toType<Vec2>(ctx, 0);
+		if (JSCommandBuffer* commands = getCommandBuffer(ctx)) {
+			static const ComponentType cmp_type = reflection::getComponentType("curve_decal");
+			commands->call<RenderModule, Vec2>(module, entity, cmp_type, value, [](RenderModule* module, EntityRef entity, Vec2 value) { module->setCurveDecalBezierP2(entity, value); });
+			return 0;
+		}
 		module->setCurveDecalBezierP2(entity, value);
 		return 0;
 	}
@@ -3474,6 +4019,11 @@ namespace Lumix {
 		EntityRef entity {JSWrapper::toType<i32>(ctx, -1)};
 		duk_pop_2(ctx);
 		auto value = JSWrapper::toType<Path>(ctx, 0);
+		if (JSCommandBuffer* commands = getCommandBuffer(ctx)) {
+			static const ComponentType cmp_type = reflection::getComponentType("terrain");
+			commands->call<RenderModule, Path>(module, entity, cmp_type, value, [](RenderModule* module, EntityRef entity, Path value) { module->setTerrainMaterialPath(entity, value); });
+			return 0;
+		}
 		module->setTerrainMaterialPath(entity, value);
 		return 0;
 	}
@@ -3504,6 +4054,11 @@ namespace Lumix {
 		EntityRef entity {JSWrapper::toType<i32>(ctx, -1)};
 		duk_pop_2(ctx);
 		auto value = JSWrapper::toType<float>(ctx, 0);
+		if (JSCommandBuffer* commands = getCommandBuffer(ctx)) {
+			static const ComponentType cmp_type = reflection::getComponentType("terrain");
+			commands->call<RenderModule, float>(module, entity, cmp_type, value, [](RenderModule* module, EntityRef entity, float value) { module->setTerrainXZScale(entity, value); });
+			return 0;
+		}
 		module->setTerrainXZScale(entity, value);
 		return 0;
 	}
@@ -3534,6 +4089,11 @@ namespace Lumix {
 		EntityRef entity {JSWrapper::toType<i32>(ctx, -1)};
 		duk_pop_2(ctx);
 		auto value = JSWrapper::toType<u32>(ctx, 0);
+		if (JSCommandBuffer* commands = getCommandBuffer(ctx)) {
+			static const ComponentType cmp_type = reflection::getComponentType("terrain");
+			commands->call<RenderModule, u32>(module, entity, cmp_type, value, [](RenderModule* module, EntityRef entity, u32 value) { module->setTerrainTesselation(entity, value); });
+			return 0;
+		}
 		module->setTerrainTesselation(entity, value);
 		return 0;
 	}
@@ -3564,6 +4124,11 @@ namespace Lumix {
 		EntityRef entity {JSWrapper::toType<i32>(ctx, -1)};
 		duk_pop_2(ctx);
 		auto value = JSWrapper::toType<u32>(ctx, 0);
+		if (JSCommandBuffer* commands = getCommandBuffer(ctx)) {
+			static const ComponentType cmp_type = reflection::getComponentType("terrain");
+			commands->call<RenderModule, u32>(module, entity, cmp_type, value, [](RenderModule* module, EntityRef entity, u32 value) { module->setTerrainBaseGridResolution(entity, value); });
+			return 0;
+		}
 		module->setTerrainBaseGridResolution(entity, value);
 		return 0;
 	}
@@ -3594,6 +4159,11 @@ namespace Lumix {
 		EntityRef entity {JSWrapper::toType<i32>(ctx, -1)};
 		duk_pop_2(ctx);
 		auto value = JSWrapper::toType<float>(ctx, 0);
+		if (JSCommandBuffer* commands = getCommandBuffer(ctx)) {
+			static const ComponentType cmp_type = reflection::getComponentType("terrain");
+			commands->call<RenderModule, float>(module, entity, cmp_type, value, [](RenderModule* module, EntityRef entity, float value) { module->setTerrainYScale(entity, value); });
+			return 0;
+		}
 		module->setTerrainYScale(entity, value);
 		return 0;
 	}
@@ -3624,6 +4194,11 @@ namespace Lumix {
 		EntityRef entity {JSWrapper::toType<i32>(ctx, -1)};
 		duk_pop_2(ctx);
 		auto value = JSWrapper::toType<Path>(ctx, 0);
+		if (JSCommandBuffer* commands = getCommandBuffer(ctx)) {
+			static const ComponentType cmp_type = reflection::getComponentType("procedural_geom");
+			commands->call<RenderModule, Path>(module, entity, cmp_type, value, [](RenderModule* module, EntityRef entity, Path value) { module->setProceduralGeometryMaterial(entity, value); });
+			return 0;
+		}
 		module->setProceduralGeometryMaterial(entity, value);
 		return 0;
 	}
@@ -3654,6 +4229,11 @@ namespace Lumix {
 		EntityRef entity {JSWrapper::toType<i32>(ctx, -1)};
 		duk_pop_2(ctx);
 		auto value = JSWrapper::toType<Path>(ctx, 0);
+		if (JSCommandBuffer* commands = getCommandBuffer(ctx)) {
+			static const ComponentType cmp_type = reflection::getComponentType("ui_3d");
+			commands->call<UIModule, Path>(module, entity, cmp_type, value, [](UIModule* module, EntityRef entity, Path value) { module->setUI3DPath(entity, value); });
+			return 0;
+		}
 		module->setUI3DPath(entity, value);
 		return 0;
 	}
@@ -3684,6 +4264,11 @@ namespace Lumix {
 		EntityRef entity {JSWrapper::toType<i32>(ctx, -1)};
 		duk_pop_2(ctx);
 		auto value = JSWrapper::toType<Vec2>(ctx, 0);
+		if (JSCommandBuffer* commands = getCommandBuffer(ctx)) {
+			static const ComponentType cmp_type = reflection::getComponentType("ui_3d");
+			commands->call<UIModule, Vec2>(module, entity, cmp_type, value, [](UIModule* module, EntityRef entity, Vec2 value) { module->setUI3DVirtualSize(entity, value); });
+			return 0;
+		}
 		module->setUI3DVirtualSize(entity, value);
 		return 0;
 	}
@@ -3714,6 +4299,11 @@ namespace Lumix {
 		EntityRef entity {JSWrapper::toType<i32>(ctx, -1)};
 		duk_pop_2(ctx);
 		auto value = JSWrapper::toType<bool>(ctx, 0);
+		if (JSCommandBuffer* commands = getCommandBuffer(ctx)) {
+			static const ComponentType cmp_type = reflection::getComponentType("ui_3d");
+			commands->call<UIModule, bool>(module, entity, cmp_type, value, [](UIModule* module, EntityRef entity, bool value) { module->setUI3DOrientToCamera(entity, value); });
+			return 0;
+		}
 		module->setUI3DOrientToCamera(entity, value);
 		return 0;
 	}
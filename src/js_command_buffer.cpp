@@ -0,0 +1,142 @@
+#include "js_command_buffer.h"
+
+#include "core/crt.h"
+#include "core/profiler.h"
+#include "engine/world.h"
+
+
+namespace Lumix {
+
+JSCommandBuffer::JSCommandBuffer(IAllocator& allocator)
+	: m_data(allocator)
+	, m_records(allocator)
+	, m_destroyed(allocator)
+{}
+
+void JSCommandBuffer::clear() {
+	m_data.clear();
+	m_record_count = 0;
+	m_destroyed.clear();
+}
+
+u64 JSCommandBuffer::beginRecord(Type type, EntityRef entity, IModule* module, const void* key, ApplyFunction apply) {
+	// keep headers aligned, they are read in place
+	while (m_data.size() % alignof(Header) != 0) m_data.write(u8(0));
+	const u64 offset = m_data.size();
+	Header header;
+	header.type = type;
+	header.entity = entity;
+	header.module = module;
+	header.key = key;
+	header.apply = apply;
+	header.size = 0;
+	m_data.write(header);
+	++m_record_count;
+	return offset;
+}
+
+void JSCommandBuffer::endRecord(u64 header_offset) {
+	Header* header = (Header*)(m_data.getMutableData() + header_offset);
+	header->size = u32(m_data.size() - header_offset - sizeof(Header));
+}
+
+void JSCommandBuffer::setPosition(EntityRef entity, const DVec3& value) {
+	const u64 offset = beginRecord(Type::POSITION, entity, nullptr, nullptr, nullptr);
+	m_data.write(value);
+	endRecord(offset);
+}
+
+void JSCommandBuffer::setRotation(EntityRef entity, const Quat& value) {
+	const u64 offset = beginRecord(Type::ROTATION, entity, nullptr, nullptr, nullptr);
+	m_data.write(value);
+	endRecord(offset);
+}
+
+void JSCommandBuffer::setScale(EntityRef entity, const Vec3& value) {
+	const u64 offset = beginRecord(Type::SCALE, entity, nullptr, nullptr, nullptr);
+	m_data.write(value);
+	endRecord(offset);
+}
+
+void JSCommandBuffer::removeEntity(EntityRef entity) {
+	if (m_record_count == 0) return;
+	auto iter = m_destroyed.find(entity);
+	if (iter.isValid()) iter.value() = m_record_count;
+	else m_destroyed.insert(entity, m_record_count);
+}
+
+void JSCommandBuffer::apply(World& world) {
+	PROFILE_FUNCTION();
+	if (m_data.empty()) return;
+
+	m_records.clear();
+	const u8* data = m_data.data();
+	u64 pos = 0;
+	for (u32 index = 0; pos < m_data.size(); ++index) {
+		pos = (pos + alignof(Header) - 1) & ~u64(alignof(Header) - 1);
+		const Header* header = (const Header*)(data + pos);
+		pos += sizeof(Header) + header->size;
+		// written before the entity was destroyed
+		auto iter = m_destroyed.find(header->entity);
+		if (iter.isValid() && index < iter.value()) continue;
+		m_records.push({header, index});
+	}
+	profiler::pushInt("writes", m_records.size());
+
+	// same writes are next to each other, the last one is the last in the run; nullptr module (transforms) go first
+	qsort(m_records.begin(), m_records.size(), sizeof(Record), [](const void* a, const void* b) -> int {
+		const Record& ra = *(const Record*)a;
+		const Record& rb = *(const Record*)b;
+		const Header& ha = *ra.header;
+		const Header& hb = *rb.header;
+		if (ha.module != hb.module) return (uintptr)ha.module < (uintptr)hb.module ? -1 : 1;
+		if (ha.type != hb.type) return ha.type < hb.type ? -1 : 1;
+		if (ha.key != hb.key) return (uintptr)ha.key < (uintptr)hb.key ? -1 : 1;
+		if (ha.entity.index != hb.entity.index) return ha.entity.index < hb.entity.index ? -1 : 1;
+		return ra.index < rb.index ? -1 : 1;
+	});
+
+	// records are sorted by module, so each module is looked up once
+	const IModule* checked_module = nullptr;
+	bool module_alive = false;
+	for (i32 i = 0, c = m_records.size(); i < c; ++i) {
+		const Header& header = *m_records[i].header;
+		if (header.module && header.module != checked_module) {
+			checked_module = header.module;
+			module_alive = false;
+			for (const UniquePtr<IModule>& module : world.getModules()) {
+				if (module.get() == header.module) module_alive = true;
+			}
+		}
+		if (header.module && !module_alive) continue;
+		if (i + 1 < c) {
+			const Header& next = *m_records[i + 1].header;
+			const bool overwritten = next.module == header.module
+				&& next.type == header.type
+				&& next.key == header.key
+				&& next.entity == header.entity;
+			if (overwritten) continue;
+		}
+		if (!world.hasEntity(header.entity)) continue;
+
+		InputMemoryStream blob(&header + 1, header.size);
+		switch (header.type) {
+			case Type::POSITION: world.setPosition(header.entity, blob.read<DVec3>()); break;
+			case Type::ROTATION: world.setRotation(header.entity, blob.read<Quat>()); break;
+			case Type::SCALE: world.setScale(header.entity, blob.read<Vec3>()); break;
+			case Type::PROPERTY:
+			case Type::CALL: {
+				// both start with the component type
+				ComponentType cmp_type;
+				memcpy(&cmp_type, &header + 1, sizeof(cmp_type));
+				if (cmp_type != INVALID_COMPONENT_TYPE && !world.hasComponent(header.entity, cmp_type)) break;
+				header.apply(header.module, header.entity, header.key, blob);
+				break;
+			}
+		}
+	}
+	m_records.clear();
+}
+
+
+} // namespace Lumix
@@ -0,0 +1,129 @@
+#pragma once
+
+
+#include "core/array.h"
+#include "core/hash_map.h"
+#include "core/math.h"
+#include "core/path.h"
+#include "core/stream.h"
+#include "engine/reflection.h"
+
+
+namespace Lumix
+{
+
+struct World;
+
+// world writes recorded by scripts, applied later on the main thread
+// writes are coalesced, only the last write to each entity's property is applied
+// applied writes are grouped by module, transforms go first, so the order of writes to different properties is not kept
+// records keep raw module and property pointers, apply or clear the buffer in the same update of the world which recorded it;
+// writes to modules which are not in the world anymore are skipped, property descriptors must outlive the buffer
+struct JSCommandBuffer {
+	enum class Type : u8 {
+		POSITION,
+		ROTATION,
+		SCALE,
+		PROPERTY,
+		CALL
+	};
+
+	// reads the value following the command and sets it
+	using ApplyFunction = void (*)(IModule* module, EntityRef entity, const void* key, InputMemoryStream& blob);
+
+	explicit JSCommandBuffer(IAllocator& allocator);
+
+	void setPosition(EntityRef entity, const DVec3& value);
+	void setRotation(EntityRef entity, const Quat& value);
+	void setScale(EntityRef entity, const Vec3& value);
+	template <typename T> void setProperty(const ComponentUID& cmp, const reflection::Property<T>& prop, const T& value);
+	// setter is the key, it must be the same function for the same property, e.g. a captureless lambda
+	// the write is dropped if the entity does not have cmp_type when the buffer is applied, unless it's INVALID_COMPONENT_TYPE
+	template <typename M, typename T> void call(M* module, EntityRef entity, ComponentType cmp_type, const T& value, void (*setter)(M*, EntityRef, T));
+
+	// drops the writes recorded for the entity so far, call it when the entity is destroyed before the buffer is applied
+	void removeEntity(EntityRef entity);
+	// writes to entities or components which do not exist anymore are skipped
+	void apply(World& world);
+	bool empty() const { return m_data.empty(); }
+	void clear();
+
+private:
+	struct Header {
+		Type type;
+		EntityRef entity;
+		IModule* module;
+		// what's written, writes with the same module, key and entity are coalesced
+		const void* key;
+		ApplyFunction apply;
+		// of the value following the header
+		u32 size;
+	};
+
+	struct Record {
+		const Header* header;
+		// order of the write
+		u32 index;
+	};
+
+	template <typename T> struct Value {
+		static void write(OutputMemoryStream& blob, const T& value) { blob.write(value); }
+		static T read(InputMemoryStream& blob) { return blob.read<T>(); }
+	};
+
+	template <typename T>
+	static void applyProperty(IModule* module, EntityRef entity, const void* key, InputMemoryStream& blob) {
+		ComponentUID cmp;
+		cmp.entity = entity;
+		cmp.module = module;
+		cmp.type = blob.read<ComponentType>();
+		const T value = Value<T>::read(blob);
+		((const reflection::Property<T>*)key)->set(cmp, -1, value);
+	}
+
+	template <typename M, typename T>
+	static void applyCall(IModule* module, EntityRef entity, const void* key, InputMemoryStream& blob) {
+		blob.read<ComponentType>();
+		auto setter = (void (*)(M*, EntityRef, T))key;
+		setter(static_cast<M*>(module), entity, Value<T>::read(blob));
+	}
+
+	u64 beginRecord(Type type, EntityRef entity, IModule* module, const void* key, ApplyFunction apply);
+	void endRecord(u64 header_offset);
+
+	OutputMemoryStream m_data;
+	u32 m_record_count = 0;
+	Array<Record> m_records;
+	// destroyed entity -> number of records written before it was destroyed, the entity can be reused later
+	HashMap<EntityRef, u32> m_destroyed;
+};
+
+template <> struct JSCommandBuffer::Value<Path> {
+	static void write(OutputMemoryStream& blob, const Path& value) { blob.writeString(value.c_str()); }
+	static Path read(InputMemoryStream& blob) { return Path(blob.readString()); }
+};
+
+// points to the command buffer, valid until it's cleared
+template <> struct JSCommandBuffer::Value<const char*> {
+	static void write(OutputMemoryStream& blob, const char* value) { blob.writeString(value); }
+	static const char* read(InputMemoryStream& blob) { return blob.readString(); }
+};
+
+template <typename T>
+void JSCommandBuffer::setProperty(const ComponentUID& cmp, const reflection::Property<T>& prop, const T& value) {
+	const u64 offset = beginRecord(Type::PROPERTY, *cmp.entity, cmp.module, &prop, &applyProperty<T>);
+	m_data.write(cmp.type);
+	Value<T>::write(m_data, value);
+	endRecord(offset);
+}
+
+template <typename M, typename T>
+void JSCommandBuffer::call(M* module, EntityRef entity, ComponentType cmp_type, const T& value, void (*setter)(M*, EntityRef, T)) {
+	const u64 offset = beginRecord(Type::CALL, entity, module, (const void*)setter, &applyCall<M, T>);
+	m_data.write(cmp_type);
+	Value<T>::write(m_data, value);
+	endRecord(offset);
+}
+
+
+} // namespace Lumix
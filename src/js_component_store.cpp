@@ -0,0 +1,291 @@
+#include "js_component_store.h"
+
+#include "core/crt.h"
+#include "core/log.h"
+#include "engine/world.h"
+#include "js_wrapper.h"
+
+
+namespace Lumix {
+
+static const char* BUFFERS_KEY = "c_buffers";
+static const char* STORE_KEY = "c_store";
+static constexpr u32 MIN_CAPACITY = 64;
+
+static const struct {
+	const char* name;
+	JSComponentStore::Type type;
+	u32 size;
+	duk_uint_t view;
+} TYPES[] = {
+	{"i8", JSComponentStore::Type::I8, 1, DUK_BUFOBJ_INT8ARRAY},
+	{"u8", JSComponentStore::Type::U8, 1, DUK_BUFOBJ_UINT8ARRAY},
+	{"i16", JSComponentStore::Type::I16, 2, DUK_BUFOBJ_INT16ARRAY},
+	{"u16", JSComponentStore::Type::U16, 2, DUK_BUFOBJ_UINT16ARRAY},
+	{"i32", JSComponentStore::Type::I32, 4, DUK_BUFOBJ_INT32ARRAY},
+	{"u32", JSComponentStore::Type::U32, 4, DUK_BUFOBJ_UINT32ARRAY},
+	{"f32", JSComponentStore::Type::F32, 4, DUK_BUFOBJ_FLOAT32ARRAY},
+	{"f64", JSComponentStore::Type::F64, 8, DUK_BUFOBJ_FLOAT64ARRAY},
+};
+
+JSComponentStore::JSComponentStore(const char* name, IAllocator& allocator)
+	: m_name(name)
+	, m_columns(allocator)
+	, m_rows(allocator)
+{
+	ASSERT(stringLength(name) <= MAX_NAME_LENGTH);
+}
+
+bool JSComponentStore::parseType(const char* name, Type& type) {
+	for (const auto& t : TYPES) {
+		if (equalStrings(t.name, name)) {
+			type = t.type;
+			return true;
+		}
+	}
+	return false;
+}
+
+u32 JSComponentStore::getSize(Type type) {
+	ASSERT((u32)type < lengthOf(TYPES));
+	return TYPES[(u32)type].size;
+}
+
+bool JSComponentStore::addColumn(const char* name, Type type) {
+	Column column;
+	if (stringLength(name) > MAX_NAME_LENGTH) return false;
+	for (const Column& c : m_columns) {
+		if (equalStrings(c.name, name)) return false;
+	}
+	copyString(Span(column.name.data), name);
+	column.type = type;
+	m_columns.push(column);
+	return true;
+}
+
+bool JSComponentStore::hasSameColumns(const JSComponentStore& rhs) const {
+	if (m_columns.size() != rhs.m_columns.size()) return false;
+	for (i32 i = 0; i < m_columns.size(); ++i) {
+		if (m_columns[i].type != rhs.m_columns[i].type) return false;
+		if (!equalStrings(m_columns[i].name, rhs.m_columns[i].name)) return false;
+	}
+	return true;
+}
+
+i32 JSComponentStore::getRow(EntityRef entity) const {
+	auto iter = m_rows.find(entity);
+	return iter.isValid() ? (i32)iter.value() : -1;
+}
+
+// entity objects or entity indices, as passed to system scripts
+static EntityRef toEntity(duk_context* ctx, duk_idx_t idx) {
+	if (duk_is_number(ctx, idx)) return EntityRef{duk_get_int(ctx, idx)};
+	return JSWrapper::toType<EntityRef>(ctx, idx);
+}
+
+// [] -> [this], throws if the store was destroyed with its module
+static JSComponentStore* getThisStore(duk_context* ctx) {
+	duk_push_this(ctx);
+	duk_get_prop_string(ctx, -1, STORE_KEY);
+	auto* store = (JSComponentStore*)duk_get_pointer(ctx, -1);
+	duk_pop(ctx);
+	if (!store) duk_error(ctx, DUK_ERR_ERROR, "component store was destroyed");
+	return store;
+}
+
+static duk_ret_t jsAdd(duk_context* ctx) {
+	const EntityRef entity = toEntity(ctx, 0);
+	JSComponentStore* store = getThisStore(ctx);
+	duk_push_int(ctx, store->add(ctx, -1, entity));
+	return 1;
+}
+
+static duk_ret_t jsRemove(duk_context* ctx) {
+	const EntityRef entity = toEntity(ctx, 0);
+	JSComponentStore* store = getThisStore(ctx);
+	duk_push_boolean(ctx, store->remove(ctx, -1, entity));
+	return 1;
+}
+
+static duk_ret_t jsRow(duk_context* ctx) {
+	const EntityRef entity = toEntity(ctx, 0);
+	JSComponentStore* store = getThisStore(ctx);
+	duk_push_int(ctx, store->getRow(entity));
+	return 1;
+}
+
+static duk_ret_t jsCount(duk_context* ctx) {
+	JSComponentStore* store = getThisStore(ctx);
+	duk_push_uint(ctx, store->size());
+	return 1;
+}
+
+void JSComponentStore::createObject(duk_context* ctx) {
+	duk_push_object(ctx);
+	duk_push_pointer(ctx, this);
+	duk_put_prop_string(ctx, -2, STORE_KEY);
+	duk_push_string(ctx, m_name);
+	duk_put_prop_string(ctx, -2, "name");
+
+	duk_push_array(ctx);
+	for (u32 i = 0; i <= (u32)m_columns.size(); ++i) {
+		duk_push_dynamic_buffer(ctx, 0);
+		duk_put_prop_index(ctx, -2, i);
+	}
+	duk_put_prop_string(ctx, -2, BUFFERS_KEY);
+	duk_push_object(ctx);
+	duk_put_prop_string(ctx, -2, "columns");
+
+	duk_push_c_function(ctx, &jsAdd, 1);
+	duk_put_prop_string(ctx, -2, "add");
+	duk_push_c_function(ctx, &jsRemove, 1);
+	duk_put_prop_string(ctx, -2, "remove");
+	duk_push_c_function(ctx, &jsRow, 1);
+	duk_put_prop_string(ctx, -2, "row");
+	duk_push_c_function(ctx, &jsCount, 0);
+	duk_put_prop_string(ctx, -2, "count");
+
+	// values live in the buffers, so there are no rows without the object
+	ASSERT(m_size == 0);
+	grow(ctx, -1, MIN_CAPACITY);
+}
+
+void JSComponentStore::detachObject(duk_context* ctx, duk_idx_t obj_idx) {
+	obj_idx = duk_normalize_index(ctx, obj_idx);
+	duk_push_pointer(ctx, nullptr);
+	duk_put_prop_string(ctx, obj_idx, STORE_KEY);
+}
+
+u8* JSComponentStore::getBufferData(duk_context* ctx, duk_idx_t obj_idx, u32 buffer) const {
+	duk_get_prop_string(ctx, obj_idx, BUFFERS_KEY);
+	duk_get_prop_index(ctx, -1, buffer);
+	u8* data = (u8*)duk_get_buffer_data(ctx, -1, nullptr);
+	duk_pop_2(ctx);
+	return data;
+}
+
+// resizing keeps the values, views are created again because their length is fixed, old views still see the values they cover
+void JSComponentStore::grow(duk_context* ctx, duk_idx_t obj_idx, u32 capacity) {
+	obj_idx = duk_normalize_index(ctx, obj_idx);
+	duk_get_prop_string(ctx, obj_idx, BUFFERS_KEY);
+	duk_get_prop_string(ctx, obj_idx, "columns");
+	for (u32 i = 0; i <= (u32)m_columns.size(); ++i) {
+		const u32 size = i == 0 ? sizeof(i32) : getSize(m_columns[i - 1].type);
+		const duk_uint_t view = i == 0 ? DUK_BUFOBJ_INT32ARRAY : TYPES[(u32)m_columns[i - 1].type].view;
+		duk_get_prop_index(ctx, -2, i);
+		duk_resize_buffer(ctx, -1, capacity * size);
+		duk_push_buffer_object(ctx, -1, 0, capacity * size, view);
+		if (i == 0) duk_put_prop_string(ctx, obj_idx, "entities");
+		else duk_put_prop_string(ctx, -3, m_columns[i - 1].name);
+		duk_pop(ctx);
+	}
+	duk_pop_2(ctx);
+	m_capacity = capacity;
+}
+
+i32 JSComponentStore::add(duk_context* ctx, duk_idx_t obj_idx, EntityRef entity) {
+	const i32 existing = getRow(entity);
+	if (existing >= 0) return existing;
+
+	obj_idx = duk_normalize_index(ctx, obj_idx);
+	if (m_size == m_capacity) grow(ctx, obj_idx, maximum(m_capacity * 2, MIN_CAPACITY));
+
+	const u32 row = m_size;
+	++m_size;
+	m_rows.insert(entity, row);
+	memcpy(getBufferData(ctx, obj_idx, 0) + row * sizeof(i32), &entity.index, sizeof(i32));
+	for (u32 i = 0; i < (u32)m_columns.size(); ++i) {
+		const u32 size = getSize(m_columns[i].type);
+		memset(getBufferData(ctx, obj_idx, i + 1) + row * size, 0, size);
+	}
+	return row;
+}
+
+bool JSComponentStore::remove(duk_context* ctx, duk_idx_t obj_idx, EntityRef entity) {
+	auto iter = m_rows.find(entity);
+	if (!iter.isValid()) return false;
+
+	obj_idx = duk_normalize_index(ctx, obj_idx);
+	const u32 row = iter.value();
+	const u32 last = m_size - 1;
+	m_rows.erase(iter);
+	--m_size;
+	if (row == last) return true;
+
+	for (u32 i = 0; i <= (u32)m_columns.size(); ++i) {
+		const u32 size = i == 0 ? sizeof(i32) : getSize(m_columns[i - 1].type);
+		u8* data = getBufferData(ctx, obj_idx, i);
+		memcpy(data + row * size, data + last * size, size);
+	}
+	i32 moved;
+	memcpy(&moved, getBufferData(ctx, obj_idx, 0) + row * sizeof(i32), sizeof(moved));
+	m_rows[EntityRef{moved}] = row;
+	return true;
+}
+
+void JSComponentStore::serializeSchema(OutputMemoryStream& blob) const {
+	blob.writeString(m_name);
+	blob.write((u32)m_columns.size());
+	for (const Column& column : m_columns) {
+		blob.writeString(column.name);
+		blob.write(column.type);
+	}
+}
+
+JSComponentStore* JSComponentStore::deserializeSchema(InputMemoryStream& blob, IAllocator& allocator) {
+	const char* store_name = blob.readString();
+	if (stringLength(store_name) > MAX_NAME_LENGTH) return nullptr;
+
+	JSComponentStore* store = LUMIX_NEW(allocator, JSComponentStore)(store_name, allocator);
+	const u32 count = blob.read<u32>();
+	for (u32 i = 0; i < count; ++i) {
+		const char* name = blob.readString();
+		const Type type = blob.read<Type>();
+		if ((u32)type >= lengthOf(TYPES) || !store->addColumn(name, type)) {
+			LUMIX_DELETE(allocator, store);
+			return nullptr;
+		}
+	}
+	return store;
+}
+
+void JSComponentStore::serializeRows(duk_context* ctx, duk_idx_t obj_idx, OutputMemoryStream& blob) const {
+	blob.write(m_size);
+	for (u32 i = 0; i <= (u32)m_columns.size(); ++i) {
+		const u32 size = i == 0 ? sizeof(i32) : getSize(m_columns[i - 1].type);
+		blob.write(getBufferData(ctx, obj_idx, i), m_size * size);
+	}
+}
+
+void JSComponentStore::deserializeRows(duk_context* ctx, duk_idx_t obj_idx, InputMemoryStream& blob, const EntityMap& entity_map) {
+	obj_idx = duk_normalize_index(ctx, obj_idx);
+	const u32 count = blob.read<u32>();
+	const u8* entities = (const u8*)blob.skip(count * sizeof(i32));
+	for (u32 j = 0; j < count; ++j) {
+		EntityPtr entity;
+		memcpy(&entity.index, entities + j * sizeof(i32), sizeof(i32));
+		entity = entity_map.get(entity);
+		if (entity.isValid()) add(ctx, obj_idx, *entity);
+	}
+
+	for (u32 i = 0; i < (u32)m_columns.size(); ++i) {
+		const u32 size = getSize(m_columns[i].type);
+		const u8* values = (const u8*)blob.skip(count * size);
+		u8* data = getBufferData(ctx, obj_idx, i + 1);
+		for (u32 j = 0; j < count; ++j) {
+			EntityPtr entity;
+			memcpy(&entity.index, entities + j * sizeof(i32), sizeof(i32));
+			entity = entity_map.get(entity);
+			if (entity.isValid()) memcpy(data + m_rows[*entity] * size, values + j * size, size);
+		}
+	}
+}
+
+void JSComponentStore::skipRows(InputMemoryStream& blob, const JSComponentStore& schema) {
+	const u32 count = blob.read<u32>();
+	blob.skip(count * sizeof(i32));
+	for (const Column& column : schema.m_columns) blob.skip(count * getSize(column.type));
+}
+
+
+} // namespace Lumix
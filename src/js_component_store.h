@@ -0,0 +1,84 @@
+#pragma once
+
+
+#include "core/array.h"
+#include "core/hash_map.h"
+#include "core/stream.h"
+#include "core/string.h"
+#include "duktape/duktape.h"
+
+
+namespace Lumix
+{
+
+struct EntityMap;
+
+// component defined by scripts, e.g. Lumix.defineComponent("health", {hp: "f32", team: "u8"})
+// values are stored as struct of arrays, one row per entity, rows are kept packed by moving the last row to the removed one
+// columns are dynamic buffers in the heap, so scripts read and write them as typed arrays without copies
+// functions with duk_idx_t obj_idx take the store's script object, see createObject
+struct JSComponentStore {
+	enum class Type : u8 {
+		I8,
+		U8,
+		I16,
+		U16,
+		I32,
+		U32,
+		F32,
+		F64
+	};
+
+	// of store's and columns' names
+	static constexpr u32 MAX_NAME_LENGTH = 31;
+
+	struct Column {
+		StaticString<MAX_NAME_LENGTH + 1> name;
+		Type type;
+	};
+
+	// name must not be longer than MAX_NAME_LENGTH
+	JSComponentStore(const char* name, IAllocator& allocator);
+
+	static bool parseType(const char* name, Type& type);
+	static u32 getSize(Type type);
+
+	const char* getName() const { return m_name; }
+	// only before the object is created
+	bool addColumn(const char* name, Type type);
+	bool hasSameColumns(const JSComponentStore& rhs) const;
+	i32 getRow(EntityRef entity) const;
+	u32 size() const { return m_size; }
+
+	// [] -> [object]
+	void createObject(duk_context* ctx);
+	// functions of the object throw after this, the store can be destroyed
+	void detachObject(duk_context* ctx, duk_idx_t obj_idx);
+	// returns the entity's row, values of a new row are zero
+	i32 add(duk_context* ctx, duk_idx_t obj_idx, EntityRef entity);
+	bool remove(duk_context* ctx, duk_idx_t obj_idx, EntityRef entity);
+
+	// name and columns
+	void serializeSchema(OutputMemoryStream& blob) const;
+	// returns nullptr if the schema is invalid, rows following it can not be read then
+	static JSComponentStore* deserializeSchema(InputMemoryStream& blob, IAllocator& allocator);
+	void serializeRows(duk_context* ctx, duk_idx_t obj_idx, OutputMemoryStream& blob) const;
+	// rows are added to the existing ones
+	void deserializeRows(duk_context* ctx, duk_idx_t obj_idx, InputMemoryStream& blob, const EntityMap& entity_map);
+	// rows of a store with other columns
+	static void skipRows(InputMemoryStream& blob, const JSComponentStore& schema);
+
+private:
+	// buffer 0 has entity indices, buffer i + 1 has values of column i
+	u8* getBufferData(duk_context* ctx, duk_idx_t obj_idx, u32 buffer) const;
+	void grow(duk_context* ctx, duk_idx_t obj_idx, u32 capacity);
+
+	StaticString<MAX_NAME_LENGTH + 1> m_name;
+	Array<Column> m_columns;
+	HashMap<EntityRef, u32> m_rows;
+	u32 m_size = 0;
+	u32 m_capacity = 0;
+};
+
+
+} // namespace Lumix
@@ -0,0 +1,292 @@
+#include "js_compute_jobs.h"
+
+#include "core/crt.h"
+#include "core/log.h"
+#include "core/profiler.h"
+#include "engine/file_system.h"
+
+
+namespace Lumix {
+
+// stash property of caller's heap with callbacks, keyed by job id
+static const char* CALLBACKS_KEY = "c_compute_jobs";
+// stash property of compute heap with evaluated modules, keyed by path
+static const char* MODULES_KEY = "c_modules";
+// stash property of compute heap with the running job
+static const char* JOB_KEY = "c_job";
+static constexpr u32 MAX_HEAPS = 8;
+
+JSComputeJobs::JSComputeJobs(FileSystem& fs, IAllocator& allocator, InitHeapFunction init_heap, duk_fatal_function fatal_handler)
+	: m_allocator(allocator)
+	, m_filesystem(fs)
+	, m_init_heap(init_heap)
+	, m_fatal_handler(fatal_handler)
+	, m_sources(allocator)
+	, m_heaps(allocator)
+	, m_free_heaps(allocator)
+	, m_queued(allocator)
+	, m_finished(allocator)
+	, m_to_deliver(allocator)
+{}
+
+JSComputeJobs::~JSComputeJobs() {
+	jobs::wait(&m_counter);
+	for (Job* job : m_queued) destroyJob(job);
+	for (Job* job : m_finished) destroyJob(job);
+	m_queued.clear();
+	m_finished.clear();
+	for (Heap* heap : m_heaps) {
+		duk_destroy_heap(heap->ctx);
+		LUMIX_DELETE(m_allocator, heap);
+	}
+	for (Source* source : m_sources) LUMIX_DELETE(m_allocator, source);
+}
+
+void JSComputeJobs::destroyJob(Job* job) {
+	if (job->heap) m_free_heaps.push(job->heap);
+	LUMIX_DELETE(m_allocator, job);
+}
+
+// sources are read and modules evaluated again on demand, so changed modules are picked up; heaps are kept
+void JSComputeJobs::invalidateModules() {
+	ASSERT(m_queued.empty() && m_finished.empty());
+	for (Heap* heap : m_heaps) {
+		duk_push_global_stash(heap->ctx);
+		duk_del_prop_string(heap->ctx, -1, MODULES_KEY);
+		duk_pop(heap->ctx);
+	}
+	for (Source* source : m_sources) LUMIX_DELETE(m_allocator, source);
+	m_sources.clear();
+}
+
+const JSComputeJobs::Source* JSComputeJobs::getSource(const char* module_path) {
+	const Path path(module_path, ".js");
+	for (const Source* source : m_sources) {
+		if (source->path == path) return source;
+	}
+
+	Source* source = LUMIX_NEW(m_allocator, Source)(m_allocator);
+	if (!m_filesystem.getContentSync(path, source->code)) {
+		LUMIX_DELETE(m_allocator, source);
+		return nullptr;
+	}
+	source->path = path;
+	m_sources.push(source);
+	return source;
+}
+
+u32 JSComputeJobs::run(const void* owner, duk_context* ctx, const char* module_path, const char* function, Span<const u8> payload, duk_idx_t callback_idx) {
+	if (stringLength(function) > MAX_FUNCTION_NAME_LENGTH) return 0;
+	const Source* source = getSource(module_path);
+	if (!source) return 0;
+
+	Job* job = LUMIX_NEW(m_allocator, Job)(m_allocator);
+	job->id = m_next_id++;
+	if (m_next_id == 0) m_next_id = 1;
+	job->owner = owner;
+	job->caller = ctx;
+	job->source = source;
+	copyString(Span(job->function.data), function);
+	job->input.write(payload.begin(), payload.length());
+	m_queued.push(job);
+
+	callback_idx = duk_normalize_index(ctx, callback_idx);
+	duk_push_global_stash(ctx);
+	if (!duk_get_prop_string(ctx, -1, CALLBACKS_KEY)) {
+		duk_pop(ctx);
+		duk_push_object(ctx);
+		duk_dup(ctx, -1);
+		duk_put_prop_string(ctx, -3, CALLBACKS_KEY);
+	}
+	duk_dup(ctx, callback_idx);
+	duk_put_prop_index(ctx, -2, job->id);
+	duk_pop_2(ctx);
+	return job->id;
+}
+
+JSComputeJobs::Heap* JSComputeJobs::popFreeHeap() {
+	if (!m_free_heaps.empty()) {
+		Heap* heap = m_free_heaps.back();
+		m_free_heaps.pop();
+		return heap;
+	}
+
+	const u32 max_heaps = minimum((u32)jobs::getWorkersCount(), MAX_HEAPS);
+	if ((u32)m_heaps.size() >= max_heaps) return nullptr;
+
+	Heap* heap = LUMIX_NEW(m_allocator, Heap)(m_allocator);
+	heap->ctx = duk_create_heap(&JSAllocator::dukAlloc, &JSAllocator::dukRealloc, &JSAllocator::dukFree, &heap->allocator, m_fatal_handler);
+	m_init_heap(heap->ctx);
+	m_heaps.push(heap);
+	return heap;
+}
+
+void JSComputeJobs::dispatch() {
+	PROFILE_FUNCTION();
+	// in the order of run
+	while (!m_queued.empty()) {
+		Heap* heap = popFreeHeap();
+		if (!heap) break;
+
+		Job* job = m_queued[0];
+		m_queued.erase(0);
+		job->heap = heap;
+		jobs::runLambda([this, job](){
+			execute(*job);
+			jobs::MutexGuard guard(m_mutex);
+			m_finished.push(job);
+		}, &m_counter);
+	}
+}
+
+// pushes module's exports
+static void pushExports(duk_context* ctx, const Path& path, const OutputMemoryStream& code) {
+	duk_push_global_stash(ctx);
+	if (!duk_get_prop_string(ctx, -1, MODULES_KEY)) {
+		duk_pop(ctx);
+		duk_push_object(ctx);
+		duk_dup(ctx, -1);
+		duk_put_prop_string(ctx, -3, MODULES_KEY);
+	}
+	if (duk_get_prop_string(ctx, -1, path.c_str())) {
+		duk_replace(ctx, -3);
+		duk_pop(ctx);
+		return;
+	}
+	duk_pop(ctx);
+
+	// same as require
+	duk_compile_lstring(ctx, DUK_COMPILE_EVAL, (const char*)code.data(), code.size());
+	duk_call(ctx, 0);
+	duk_dup(ctx, -1);
+	duk_put_prop_string(ctx, -3, path.c_str());
+	duk_replace(ctx, -3);
+	duk_pop(ctx);
+}
+
+duk_ret_t JSComputeJobs::executeSafe(duk_context* ctx, void* udata) {
+	Job& job = *(Job*)udata;
+	pushExports(ctx, job.source->path, job.source->code);
+	if (!duk_get_prop_string(ctx, -1, job.function)) {
+		return duk_error(ctx, DUK_ERR_TYPE_ERROR, "%s does not export function %s", job.source->path.c_str(), (const char*)job.function);
+	}
+
+	void* payload = duk_push_fixed_buffer(ctx, job.input.size());
+	memcpy(payload, job.input.data(), job.input.size());
+	duk_cbor_decode(ctx, -1, 0);
+	duk_call(ctx, 1);
+
+	duk_cbor_encode(ctx, -1, 0);
+	duk_size_t size;
+	const void* result = duk_get_buffer_data(ctx, -1, &size);
+	job.output.write(result, size);
+	return 0;
+}
+
+void JSComputeJobs::execute(Job& job) {
+	PROFILE_FUNCTION();
+	profiler::pushString(job.function);
+	duk_context* ctx = job.heap->ctx;
+	duk_push_global_stash(ctx);
+	duk_push_pointer(ctx, &job);
+	duk_put_prop_string(ctx, -2, JOB_KEY);
+	duk_pop(ctx);
+	if (duk_safe_call(ctx, &executeSafe, &job, 0, 1) != 0) {
+		const char* error = duk_safe_to_stacktrace(ctx, -1);
+		job.failed = true;
+		job.output.clear();
+		job.output.write(error, stringLength(error) + 1);
+	}
+	duk_pop(ctx);
+
+	// voluntary GC is disabled, refcounting frees most garbage, collect cycles once the heap doubles
+	Heap& heap = *job.heap;
+	const u64 live_bytes = heap.allocator.getStats().live_bytes;
+	if (live_bytes > maximum((u64)4 * 1024 * 1024, heap.live_bytes_after_gc * 2)) {
+		duk_gc(ctx, 0);
+		heap.live_bytes_after_gc = heap.allocator.getStats().live_bytes;
+	}
+}
+
+int JSComputeJobs::logError(duk_context* ctx) {
+	const char* msg = duk_safe_to_string(ctx, 0);
+	duk_push_global_stash(ctx);
+	duk_get_prop_string(ctx, -1, JOB_KEY);
+	Job* job = (Job*)duk_get_pointer(ctx, -1);
+	duk_pop_2(ctx);
+	if (job) job->log.write(msg, stringLength(msg) + 1);
+	return 0;
+}
+
+void JSComputeJobs::deliver(const void* owner) {
+	PROFILE_FUNCTION();
+	{
+		jobs::MutexGuard guard(m_mutex);
+		for (i32 i = m_finished.size() - 1; i >= 0; --i) {
+			if (m_finished[i]->owner != owner) continue;
+			m_to_deliver.push(m_finished[i]);
+			m_finished.erase(i);
+		}
+	}
+	if (m_to_deliver.empty()) return;
+
+	// all jobs of the owner are started from the same heap
+	duk_context* ctx = m_to_deliver[0]->caller;
+	duk_push_global_stash(ctx);
+	duk_get_prop_string(ctx, -1, CALLBACKS_KEY);
+	// in the order jobs finished
+	for (i32 i = m_to_deliver.size() - 1; i >= 0; --i) {
+		Job* job = m_to_deliver[i];
+		InputMemoryStream log(job->log);
+		while (log.getPosition() < log.size()) Lumix::logError(log.readString());
+		duk_get_prop_index(ctx, -1, job->id);
+		duk_del_prop_index(ctx, -2, job->id);
+		if (job->failed) {
+			duk_push_undefined(ctx);
+			duk_push_string(ctx, (const char*)job->output.data());
+		}
+		else {
+			void* result = duk_push_fixed_buffer(ctx, job->output.size());
+			memcpy(result, job->output.data(), job->output.size());
+			duk_cbor_decode(ctx, -1, 0);
+			duk_push_undefined(ctx);
+		}
+		if (duk_pcall(ctx, 2) != 0) {
+			Lumix::logError(duk_safe_to_stacktrace(ctx, -1));
+		}
+		duk_pop(ctx);
+		destroyJob(job);
+	}
+	duk_pop_2(ctx);
+	m_to_deliver.clear();
+}
+
+// other owners can have callbacks in the same heap, so only the job's one is removed
+void JSComputeJobs::removeCallback(const Job& job) {
+	duk_context* ctx = job.caller;
+	duk_push_global_stash(ctx);
+	if (duk_get_prop_string(ctx, -1, CALLBACKS_KEY)) duk_del_prop_index(ctx, -1, job.id);
+	duk_pop_2(ctx);
+}
+
+void JSComputeJobs::cancel(const void* owner) {
+	PROFILE_FUNCTION();
+	jobs::wait(&m_counter);
+	for (i32 i = m_queued.size() - 1; i >= 0; --i) {
+		if (m_queued[i]->owner != owner) continue;
+		removeCallback(*m_queued[i]);
+		destroyJob(m_queued[i]);
+		m_queued.erase(i);
+	}
+	for (i32 i = m_finished.size() - 1; i >= 0; --i) {
+		if (m_finished[i]->owner != owner) continue;
+		removeCallback(*m_finished[i]);
+		destroyJob(m_finished[i]);
+		m_finished.erase(i);
+	}
+
+	if (m_queued.empty() && m_finished.empty()) invalidateModules();
+}
+
+
+} // namespace Lumix
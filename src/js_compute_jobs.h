@@ -0,0 +1,105 @@
+#pragma once
+
+
+#include "core/array.h"
+#include "core/job_system.h"
+#include "core/path.h"
+#include "core/stream.h"
+#include "core/string.h"
+#include "js_allocator.h"
+
+
+namespace Lumix
+{
+
+struct FileSystem;
+
+// runs functions exported by JS modules in separate heaps on job threads, see Lumix.jobs.run
+// payloads and results are passed as CBOR, results are delivered on the main thread after the job finishes
+struct JSComputeJobs {
+	// registers API of a new compute heap
+	using InitHeapFunction = void (*)(duk_context* ctx);
+	// longer names are rejected by run
+	static constexpr u32 MAX_FUNCTION_NAME_LENGTH = 63;
+
+	JSComputeJobs(FileSystem& fs, IAllocator& allocator, InitHeapFunction init_heap, duk_fatal_function fatal_handler);
+	~JSComputeJobs();
+
+	// owner identifies who started the job, several owners can share one ctx
+	// callback is called with (result, error) by deliver(owner), returns 0 if the module can't be read or the function name is too long
+	u32 run(const void* owner, duk_context* ctx, const char* module_path, const char* function, Span<const u8> payload, duk_idx_t callback_idx);
+	// starts queued jobs, main thread
+	void dispatch();
+	// calls callbacks of finished jobs started by owner, main thread
+	void deliver(const void* owner);
+	// waits for running jobs and drops jobs started by owner, modules are read again in the next run
+	// heaps are kept until shutdown
+	void cancel(const void* owner);
+	// Lumix.logError of compute heaps, messages are logged on the main thread by deliver
+	static int logError(duk_context* ctx);
+
+private:
+	struct Heap {
+		explicit Heap(IAllocator& allocator) : allocator(allocator) {}
+
+		JSAllocator allocator;
+		duk_context* ctx = nullptr;
+		u64 live_bytes_after_gc = 0;
+	};
+
+	struct Source {
+		explicit Source(IAllocator& allocator) : code(allocator) {}
+
+		Path path;
+		OutputMemoryStream code;
+	};
+
+	struct Job {
+		explicit Job(IAllocator& allocator)
+			: input(allocator)
+			, output(allocator)
+			, log(allocator)
+		{}
+
+		u32 id;
+		const void* owner;
+		// heap which started the job, the callback lives there
+		duk_context* caller;
+		const Source* source;
+		StaticString<MAX_FUNCTION_NAME_LENGTH + 1> function;
+		// CBOR
+		OutputMemoryStream input;
+		// CBOR result or error message
+		OutputMemoryStream output;
+		// null terminated messages from Lumix.logError
+		OutputMemoryStream log;
+		bool failed = false;
+		Heap* heap = nullptr;
+	};
+
+	const Source* getSource(const char* module_path);
+	Heap* popFreeHeap();
+	void execute(Job& job);
+	static duk_ret_t executeSafe(duk_context* ctx, void* udata);
+	void destroyJob(Job* job);
+	static void removeCallback(const Job& job);
+	void invalidateModules();
+
+	IAllocator& m_allocator;
+	FileSystem& m_filesystem;
+	InitHeapFunction m_init_heap;
+	duk_fatal_function m_fatal_handler;
+	Array<Source*> m_sources;
+	Array<Heap*> m_heaps;
+	Array<Heap*> m_free_heaps;
+	Array<Job*> m_queued;
+	// written by job threads, guarded by m_mutex
+	Array<Job*> m_finished;
+	Array<Job*> m_to_deliver;
+	jobs::Mutex m_mutex;
+	jobs::Counter m_counter;
+	u32 m_next_id = 1;
+};
+
+
+} // namespace Lumix
@@ -0,0 +1,210 @@
+#include "js_heap_snapshot.h"
+
+#include "core/crt.h"
+
+
+namespace Lumix {
+
+static constexpr u32 SNAPSHOT_MAGIC = 0x5348534A; // 'JSHS'
+static constexpr u32 SNAPSHOT_VERSION = 0;
+
+JSHeapSnapshot::JSHeapSnapshot(IAllocator& allocator)
+	: allocator(allocator)
+	, nodes(allocator)
+	, strings(allocator)
+	, m_string_map(allocator)
+	, m_node_map(allocator)
+{}
+
+void JSHeapSnapshot::clear() {
+	nodes.clear();
+	strings.clear();
+	m_string_map.clear();
+	m_node_map.clear();
+}
+
+u32 JSHeapSnapshot::addString(StringView str) {
+	const StableHash hash(str);
+	auto iter = m_string_map.find(hash);
+	if (iter.isValid()) return iter.value();
+
+	const u32 idx = strings.size();
+	strings.emplace(str, allocator);
+	m_string_map.insert(hash, idx);
+	return idx;
+}
+
+// value on the top of the stack
+static u32 getSize(duk_context* ctx) {
+	duk_inspect_value(ctx, -1);
+	u64 size = 0;
+	static const char* fields[] = { "hbytes", "pbytes", "bcbytes", "dbytes" };
+	for (const char* field : fields) {
+		duk_get_prop_string(ctx, -1, field);
+		size += (u64)duk_get_number_default(ctx, -1, 0);
+		duk_pop(ctx);
+	}
+	duk_pop(ctx);
+	return (u32)size;
+}
+
+// own data property of the object on the top of the stack, without calling getters; pushes undefined if there's none
+static void getOwnValue(duk_context* ctx, const char* key) {
+	duk_push_string(ctx, key);
+	duk_get_prop_desc(ctx, -2, 0);
+	if (duk_is_object(ctx, -1)) {
+		duk_get_prop_string(ctx, -1, "value");
+		duk_remove(ctx, -2);
+	}
+}
+
+// value on the top of the stack
+u32 JSHeapSnapshot::getTypeName(duk_context* ctx) {
+	if (duk_is_string(ctx, -1)) return addString("(string)");
+	if (duk_is_buffer(ctx, -1)) return addString("(buffer)");
+	if (duk_is_function(ctx, -1)) return addString("Function");
+
+	// name of prototype.constructor, e.g. class name
+	duk_get_prototype(ctx, -1);
+	if (duk_is_object(ctx, -1)) {
+		getOwnValue(ctx, "constructor");
+		if (duk_is_function(ctx, -1)) {
+			getOwnValue(ctx, "name");
+			if (duk_is_string(ctx, -1)) {
+				duk_size_t len;
+				const char* name = duk_get_lstring(ctx, -1, &len);
+				if (len > 0) {
+					const u32 res = addString(StringView(name, (u32)len));
+					duk_pop_3(ctx);
+					return res;
+				}
+			}
+			duk_pop(ctx);
+		}
+		duk_pop(ctx);
+	}
+	duk_pop(ctx);
+	return addString("Object");
+}
+
+void JSHeapSnapshot::addNode(duk_context* ctx, duk_idx_t idx, u32 parent, u32 edge) {
+	// null for values which are not allocated on the heap
+	void* ptr = duk_get_heapptr(ctx, idx);
+	if (!ptr) return;
+
+	const u64 id = (u64)(uintptr)ptr;
+	if (m_node_map.find(id).isValid()) return;
+
+	m_node_map.insert(id, nodes.size());
+	duk_dup(ctx, idx);
+	Node& node = nodes.emplace();
+	node.id = id;
+	node.parent = parent;
+	node.edge = edge;
+	node.type = getTypeName(ctx);
+	node.self_size = getSize(ctx);
+	node.retained_size = node.self_size;
+	duk_pop(ctx);
+}
+
+void JSHeapSnapshot::addRoot(duk_context* ctx, const char* name) {
+	addNode(ctx, -1, NO_PARENT, addString(name));
+}
+
+void JSHeapSnapshot::capture(duk_context* ctx) {
+	const duk_idx_t top = duk_get_top(ctx);
+	// nodes are the queue, new ones are appended while walking
+	for (u32 i = 0; i < (u32)nodes.size(); ++i) {
+		duk_push_heapptr(ctx, (void*)(uintptr)nodes[i].id);
+		if (!duk_is_object(ctx, -1)) {
+			duk_pop(ctx);
+			continue;
+		}
+
+		duk_get_prototype(ctx, -1);
+		addNode(ctx, -1, i, addString("__proto__"));
+		duk_pop(ctx);
+
+		duk_enum(ctx, -1, DUK_ENUM_OWN_PROPERTIES_ONLY | DUK_ENUM_INCLUDE_NONENUMERABLE | DUK_ENUM_INCLUDE_HIDDEN | DUK_ENUM_INCLUDE_SYMBOLS);
+		while (duk_next(ctx, -1, 0)) {
+			// [obj enum key]
+			duk_size_t len;
+			const char* key = duk_get_lstring(ctx, -1, &len);
+			// hidden and symbol keys start with an invalid utf8 byte
+			const bool is_symbol = key && len > 0 && (u8)key[0] >= 0x80;
+			const u32 edge = addString(is_symbol ? StringView("(symbol)") : key ? StringView(key, (u32)len) : StringView("?"));
+
+			addNode(ctx, -1, i, edge);
+			// descriptor does not call getters
+			duk_dup(ctx, -1);
+			duk_get_prop_desc(ctx, -4, 0);
+			if (duk_is_object(ctx, -1)) {
+				duk_get_prop_string(ctx, -1, "value");
+				addNode(ctx, -1, i, edge);
+				duk_pop(ctx);
+				duk_get_prop_string(ctx, -1, "get");
+				addNode(ctx, -1, i, addString("(getter)"));
+				duk_pop(ctx);
+				duk_get_prop_string(ctx, -1, "set");
+				addNode(ctx, -1, i, addString("(setter)"));
+				duk_pop(ctx);
+			}
+			duk_pop_2(ctx);
+		}
+		duk_pop_2(ctx);
+	}
+	ASSERT(duk_get_top(ctx) == top);
+
+	// retainers always precede retained values
+	for (i32 i = nodes.size() - 1; i >= 0; --i) {
+		const Node& node = nodes[i];
+		if (node.parent != NO_PARENT) nodes[node.parent].retained_size += node.retained_size;
+	}
+}
+
+i32 JSHeapSnapshot::find(u64 id) const {
+	auto iter = m_node_map.find(id);
+	return iter.isValid() ? (i32)iter.value() : -1;
+}
+
+void JSHeapSnapshot::getRetainerPath(u32 node_idx, Span<char> out) const {
+	copyString(out, "");
+	// walk to the root and prepend edges
+	for (u32 i = node_idx; i != NO_PARENT; i = nodes[i].parent) {
+		const char* edge = strings[nodes[i].edge].c_str();
+		StaticString<512> tmp(edge, i == node_idx ? "" : ".", out.begin());
+		copyString(out, tmp);
+	}
+}
+
+void JSHeapSnapshot::serialize(OutputMemoryStream& blob) const {
+	blob.write(SNAPSHOT_MAGIC);
+	blob.write(SNAPSHOT_VERSION);
+	blob.write((u32)strings.size());
+	for (const String& str : strings) blob.writeString(str.c_str());
+	blob.write((u32)nodes.size());
+	blob.write(nodes.begin(), nodes.byte_size());
+}
+
+bool JSHeapSnapshot::deserialize(InputMemoryStream& blob) {
+	clear();
+	if (blob.read<u32>() != SNAPSHOT_MAGIC) return false;
+	if (blob.read<u32>() != SNAPSHOT_VERSION) return false;
+
+	const u32 string_count = blob.read<u32>();
+	for (u32 i = 0; i < string_count && !blob.hasOverflow(); ++i) {
+		addString(blob.readString());
+	}
+	const u32 node_count = blob.read<u32>();
+	if (blob.hasOverflow() || blob.remaining() < node_count * sizeof(Node)) return false;
+
+	nodes.resize(node_count);
+	blob.read(nodes.begin(), nodes.byte_size());
+	for (u32 i = 0; i < node_count; ++i) {
+		m_node_map.insert(nodes[i].id, i);
+	}
+	return strings.size() == string_count;
+}
+
+
+} // namespace Lumix
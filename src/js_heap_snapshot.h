@@ -0,0 +1,63 @@
+#pragma once
+
+
+#include "core/array.h"
+#include "core/hash.h"
+#include "core/hash_map.h"
+#include "core/stream.h"
+#include "core/string.h"
+#include "duktape/duktape.h"
+
+
+namespace Lumix
+{
+
+// values reachable from roots, walked breadth first
+// each value has one retainer, the one through which it was first reached, so retainer paths are the shortest ones
+// retained size of a value is the size of all values first reached through it
+struct JSHeapSnapshot {
+	static constexpr u32 NO_PARENT = 0xffFFffFF;
+
+	struct Node {
+		// heap pointer, stable for the lifetime of the value, so it can be matched between snapshots
+		u64 id;
+		// index of the retainer, NO_PARENT for roots
+		u32 parent;
+		// index in strings, name of the constructor
+		u32 type;
+		// index in strings, name of the property in the retainer, name of the root for roots
+		u32 edge;
+		u32 self_size;
+		u64 retained_size;
+	};
+
+	explicit JSHeapSnapshot(IAllocator& allocator);
+
+	void clear();
+	// value on the top of the stack, it's not popped
+	void addRoot(duk_context* ctx, const char* name);
+	// walks everything reachable from roots
+	void capture(duk_context* ctx);
+	void serialize(OutputMemoryStream& blob) const;
+	bool deserialize(InputMemoryStream& blob);
+
+	const char* getString(u32 idx) const { return strings[idx].c_str(); }
+	// index of the node with the id, -1 if there's none
+	i32 find(u64 id) const;
+	void getRetainerPath(u32 node_idx, Span<char> out) const;
+
+	IAllocator& allocator;
+	Array<Node> nodes;
+	Array<String> strings;
+
+private:
+	u32 addString(StringView str);
+	void addNode(duk_context* ctx, duk_idx_t idx, u32 parent, u32 edge);
+	u32 getTypeName(duk_context* ctx);
+
+	HashMap<StableHash, u32> m_string_map;
+	HashMap<u64, u32> m_node_map;
+};
+
+
+} // namespace Lumix
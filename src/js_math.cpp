@@ -0,0 +1,347 @@
+#include "js_math.h"
+
+#include "core/crt.h"
+#include "core/math.h"
+#include "core/simd.h"
+#include "js_wrapper.h"
+
+
+namespace Lumix {
+
+// [] -> [out], out is the array at out_idx if there is one, otherwise a new array
+static void pushResult(duk_context* ctx, duk_idx_t out_idx, const double* values, u32 count) {
+	if (duk_is_object(ctx, out_idx)) duk_dup(ctx, out_idx);
+	else duk_push_array(ctx);
+	for (u32 i = 0; i < count; ++i) {
+		duk_push_number(ctx, values[i]);
+		duk_put_prop_index(ctx, -2, i);
+	}
+}
+
+static void pushResult(duk_context* ctx, duk_idx_t out_idx, const DVec3& v) {
+	const double values[] = {v.x, v.y, v.z};
+	pushResult(ctx, out_idx, values, lengthOf(values));
+}
+
+static void pushResult(duk_context* ctx, duk_idx_t out_idx, const Quat& q) {
+	const double values[] = {q.x, q.y, q.z, q.w};
+	pushResult(ctx, out_idx, values, lengthOf(values));
+}
+
+static DVec3 toVec3(duk_context* ctx, duk_idx_t idx) {
+	if (!duk_is_object(ctx, idx)) duk_error(ctx, DUK_ERR_TYPE_ERROR, "argument %d is not a vector", (i32)idx);
+	return JSWrapper::toType<DVec3>(ctx, idx);
+}
+
+static Quat toQuat(duk_context* ctx, duk_idx_t idx) {
+	if (!duk_is_object(ctx, idx)) duk_error(ctx, DUK_ERR_TYPE_ERROR, "argument %d is not a quaternion", (i32)idx);
+	return JSWrapper::toType<Quat>(ctx, idx);
+}
+
+static double dotProduct(const DVec3& a, const DVec3& b) { return a.x * b.x + a.y * b.y + a.z * b.z; }
+
+static DVec3 crossProduct(const DVec3& a, const DVec3& b) {
+	return DVec3(a.y * b.z - a.z * b.y, a.z * b.x - a.x * b.z, a.x * b.y - a.y * b.x);
+}
+
+static duk_ret_t jsAdd(duk_context* ctx) {
+	pushResult(ctx, 2, toVec3(ctx, 0) + toVec3(ctx, 1));
+	return 1;
+}
+
+static duk_ret_t jsSub(duk_context* ctx) {
+	pushResult(ctx, 2, toVec3(ctx, 0) - toVec3(ctx, 1));
+	return 1;
+}
+
+static duk_ret_t jsScale(duk_context* ctx) {
+	pushResult(ctx, 2, toVec3(ctx, 0) * duk_require_number(ctx, 1));
+	return 1;
+}
+
+static duk_ret_t jsDot(duk_context* ctx) {
+	duk_push_number(ctx, dotProduct(toVec3(ctx, 0), toVec3(ctx, 1)));
+	return 1;
+}
+
+static duk_ret_t jsCross(duk_context* ctx) {
+	pushResult(ctx, 2, crossProduct(toVec3(ctx, 0), toVec3(ctx, 1)));
+	return 1;
+}
+
+static duk_ret_t jsLength(duk_context* ctx) {
+	duk_push_number(ctx, length(toVec3(ctx, 0)));
+	return 1;
+}
+
+static duk_ret_t jsDistance(duk_context* ctx) {
+	duk_push_number(ctx, length(toVec3(ctx, 0) - toVec3(ctx, 1)));
+	return 1;
+}
+
+// zero vector stays zero
+static duk_ret_t jsNormalize(duk_context* ctx) {
+	const DVec3 v = toVec3(ctx, 0);
+	const double len = length(v);
+	pushResult(ctx, 1, len > 0 ? v * (1 / len) : v);
+	return 1;
+}
+
+static duk_ret_t jsLerp(duk_context* ctx) {
+	const DVec3 a = toVec3(ctx, 0);
+	const DVec3 b = toVec3(ctx, 1);
+	pushResult(ctx, 3, a + (b - a) * duk_require_number(ctx, 2));
+	return 1;
+}
+
+static duk_ret_t jsQuatMul(duk_context* ctx) {
+	pushResult(ctx, 2, toQuat(ctx, 0) * toQuat(ctx, 1));
+	return 1;
+}
+
+static duk_ret_t jsQuatRotate(duk_context* ctx) {
+	pushResult(ctx, 2, toQuat(ctx, 0).rotate(toVec3(ctx, 1)));
+	return 1;
+}
+
+static duk_ret_t jsQuatFromAxisAngle(duk_context* ctx) {
+	const DVec3 axis = toVec3(ctx, 0);
+	pushResult(ctx, 2, Quat(Vec3((float)axis.x, (float)axis.y, (float)axis.z), (float)duk_require_number(ctx, 1)));
+	return 1;
+}
+
+static duk_ret_t jsQuatConjugate(duk_context* ctx) {
+	pushResult(ctx, 1, toQuat(ctx, 0).conjugated());
+	return 1;
+}
+
+static duk_ret_t jsQuatNlerp(duk_context* ctx) {
+	pushResult(ctx, 3, nlerp(toQuat(ctx, 0), toQuat(ctx, 1), (float)duk_require_number(ctx, 2)));
+	return 1;
+}
+
+// Float32Array or Float64Array
+struct NumberArray {
+	void* data = nullptr;
+	u32 count = 0;
+	bool is_double = false;
+};
+
+static bool isInstanceOf(duk_context* ctx, duk_idx_t idx, const char* constructor) {
+	duk_get_global_string(ctx, constructor);
+	const bool res = duk_instanceof(ctx, idx, -1);
+	duk_pop(ctx);
+	return res;
+}
+
+static NumberArray toNumberArray(duk_context* ctx, duk_idx_t idx) {
+	NumberArray res;
+	if (!duk_is_buffer_data(ctx, idx) || !duk_is_object(ctx, idx)) {
+		duk_error(ctx, DUK_ERR_TYPE_ERROR, "argument %d is not Float32Array or Float64Array", (i32)idx);
+	}
+	if (isInstanceOf(ctx, idx, "Float64Array")) res.is_double = true;
+	else if (!isInstanceOf(ctx, idx, "Float32Array")) {
+		duk_error(ctx, DUK_ERR_TYPE_ERROR, "argument %d is not Float32Array or Float64Array", (i32)idx);
+	}
+	duk_size_t size;
+	res.data = duk_get_buffer_data(ctx, idx, &size);
+	res.count = u32(size / (res.is_double ? sizeof(double) : sizeof(float)));
+	return res;
+}
+
+// [] -> [out], out is the typed array at out_idx if there is one, otherwise a new one of the same type as `like`
+static NumberArray pushOutArray(duk_context* ctx, duk_idx_t out_idx, const NumberArray& like, u32 count) {
+	if (duk_is_object(ctx, out_idx)) {
+		NumberArray out = toNumberArray(ctx, out_idx);
+		if (out.is_double != like.is_double) duk_error(ctx, DUK_ERR_TYPE_ERROR, "out has a different type");
+		if (out.count < count) duk_error(ctx, DUK_ERR_RANGE_ERROR, "out is too small, %d numbers needed", (i32)count);
+		duk_dup(ctx, out_idx);
+		return out;
+	}
+	const u32 size = like.is_double ? sizeof(double) : sizeof(float);
+	NumberArray out;
+	out.data = duk_push_fixed_buffer(ctx, count * size);
+	out.count = count;
+	out.is_double = like.is_double;
+	duk_push_buffer_object(ctx, -1, 0, count * size, like.is_double ? DUK_BUFOBJ_FLOAT64ARRAY : DUK_BUFOBJ_FLOAT32ARRAY);
+	duk_remove(ctx, -2);
+	return out;
+}
+
+static void store3(float* dst, float4 v) {
+	float tmp[4];
+	memcpy(tmp, &v, sizeof(tmp));
+	memcpy(dst, tmp, sizeof(float) * 3);
+}
+
+// column major
+static void transformPoints(const float* points, const float* m, float* out, u32 count) {
+	const float4 c0 = f4LoadUnaligned(m);
+	const float4 c1 = f4LoadUnaligned(m + 4);
+	const float4 c2 = f4LoadUnaligned(m + 8);
+	const float4 c3 = f4LoadUnaligned(m + 12);
+	for (u32 i = 0; i < count; ++i) {
+		const float* p = points + i * 3;
+		const float4 xy = f4Add(f4Mul(c0, f4Splat(p[0])), f4Mul(c1, f4Splat(p[1])));
+		const float4 z1 = f4Add(f4Mul(c2, f4Splat(p[2])), c3);
+		store3(out + i * 3, f4Add(xy, z1));
+	}
+}
+
+static void transformPoints(const double* points, const float* m, double* out, u32 count) {
+	for (u32 i = 0; i < count; ++i) {
+		const double x = points[i * 3];
+		const double y = points[i * 3 + 1];
+		const double z = points[i * 3 + 2];
+		for (u32 j = 0; j < 3; ++j) {
+			out[i * 3 + j] = m[j] * x + m[4 + j] * y + m[8 + j] * z + m[12 + j];
+		}
+	}
+}
+
+static void lerpArrays(const float* a, const float* b, float t, float* out, u32 count) {
+	const float4 t4 = f4Splat(t);
+	u32 i = 0;
+	for (; i + 4 <= count; i += 4) {
+		const float4 va = f4LoadUnaligned(a + i);
+		const float4 r = f4Add(va, f4Mul(f4Sub(f4LoadUnaligned(b + i), va), t4));
+		memcpy(out + i, &r, sizeof(r));
+	}
+	for (; i < count; ++i) out[i] = a[i] + (b[i] - a[i]) * t;
+}
+
+static void lerpArrays(const double* a, const double* b, double t, double* out, u32 count) {
+	for (u32 i = 0; i < count; ++i) out[i] = a[i] + (b[i] - a[i]) * t;
+}
+
+// 4 points at once are 3 float4, the point is repeated in the same layout
+static void distanceSquaredMany(const float* points, const DVec3& point, float* out, u32 count) {
+	const float p[] = {(float)point.x, (float)point.y, (float)point.z};
+	const float pattern[12] = {p[0], p[1], p[2], p[0], p[1], p[2], p[0], p[1], p[2], p[0], p[1], p[2]};
+	const float4 p0 = f4LoadUnaligned(pattern);
+	const float4 p1 = f4LoadUnaligned(pattern + 4);
+	const float4 p2 = f4LoadUnaligned(pattern + 8);
+	u32 i = 0;
+	for (; i + 4 <= count; i += 4) {
+		const float* src = points + i * 3;
+		const float4 d0 = f4Sub(f4LoadUnaligned(src), p0);
+		const float4 d1 = f4Sub(f4LoadUnaligned(src + 4), p1);
+		const float4 d2 = f4Sub(f4LoadUnaligned(src + 8), p2);
+		float sq[12];
+		const float4 s0 = f4Mul(d0, d0);
+		const float4 s1 = f4Mul(d1, d1);
+		const float4 s2 = f4Mul(d2, d2);
+		memcpy(sq, &s0, sizeof(s0));
+		memcpy(sq + 4, &s1, sizeof(s1));
+		memcpy(sq + 8, &s2, sizeof(s2));
+		for (u32 j = 0; j < 4; ++j) out[i + j] = sq[j * 3] + sq[j * 3 + 1] + sq[j * 3 + 2];
+	}
+	for (; i < count; ++i) {
+		const float* src = points + i * 3;
+		const float dx = src[0] - p[0];
+		const float dy = src[1] - p[1];
+		const float dz = src[2] - p[2];
+		out[i] = dx * dx + dy * dy + dz * dz;
+	}
+}
+
+static void distanceSquaredMany(const double* points, const DVec3& point, double* out, u32 count) {
+	for (u32 i = 0; i < count; ++i) {
+		const double* src = points + i * 3;
+		const double dx = src[0] - point.x;
+		const double dy = src[1] - point.y;
+		const double dz = src[2] - point.z;
+		out[i] = dx * dx + dy * dy + dz * dz;
+	}
+}
+
+// Lumix.math.matrix(position, rotation, scale, out), column major Float32Array(16), scale is optional
+static duk_ret_t jsMatrix(duk_context* ctx) {
+	const DVec3 pos = toVec3(ctx, 0);
+	const Quat q = toQuat(ctx, 1);
+	const DVec3 s = duk_is_object(ctx, 2) ? toVec3(ctx, 2) : DVec3(1, 1, 1);
+
+	float m[16] = {
+		float((1 - 2 * (q.y * q.y + q.z * q.z)) * s.x), float(2 * (q.x * q.y + q.w * q.z) * s.x), float(2 * (q.x * q.z - q.w * q.y) * s.x), 0,
+		float(2 * (q.x * q.y - q.w * q.z) * s.y), float((1 - 2 * (q.x * q.x + q.z * q.z)) * s.y), float(2 * (q.y * q.z + q.w * q.x) * s.y), 0,
+		float(2 * (q.x * q.z + q.w * q.y) * s.z), float(2 * (q.y * q.z - q.w * q.x) * s.z), float((1 - 2 * (q.x * q.x + q.y * q.y)) * s.z), 0,
+		(float)pos.x, (float)pos.y, (float)pos.z, 1
+	};
+
+	const NumberArray f32;
+	NumberArray out = pushOutArray(ctx, 3, f32, lengthOf(m));
+	if (out.is_double) return duk_error(ctx, DUK_ERR_TYPE_ERROR, "matrix must be Float32Array");
+	memcpy(out.data, m, sizeof(m));
+	return 1;
+}
+
+// Lumix.math.transformPoints(points, matrix, out), out is optional, it can be points
+static duk_ret_t jsTransformPoints(duk_context* ctx) {
+	const NumberArray points = toNumberArray(ctx, 0);
+	const NumberArray m = toNumberArray(ctx, 1);
+	if (m.is_double || m.count < 16) return duk_error(ctx, DUK_ERR_TYPE_ERROR, "matrix must be Float32Array(16)");
+	const u32 count = points.count / 3;
+	NumberArray out = pushOutArray(ctx, 2, points, count * 3);
+	if (points.is_double) transformPoints((const double*)points.data, (const float*)m.data, (double*)out.data, count);
+	else transformPoints((const float*)points.data, (const float*)m.data, (float*)out.data, count);
+	return 1;
+}
+
+// Lumix.math.lerpArrays(a, b, t, out), out is optional, it can be a or b
+static duk_ret_t jsLerpArrays(duk_context* ctx) {
+	const NumberArray a = toNumberArray(ctx, 0);
+	const NumberArray b = toNumberArray(ctx, 1);
+	const double t = duk_require_number(ctx, 2);
+	if (a.is_double != b.is_double || a.count != b.count) return duk_error(ctx, DUK_ERR_TYPE_ERROR, "arrays must have the same type and length");
+	NumberArray out = pushOutArray(ctx, 3, a, a.count);
+	if (a.is_double) lerpArrays((const double*)a.data, (const double*)b.data, t, (double*)out.data, a.count);
+	else lerpArrays((const float*)a.data, (const float*)b.data, (float)t, (float*)out.data, a.count);
+	return 1;
+}
+
+// Lumix.math.distanceSquaredMany(points, point, out), out gets one number per point, it's optional
+static duk_ret_t jsDistanceSquaredMany(duk_context* ctx) {
+	const NumberArray points = toNumberArray(ctx, 0);
+	const DVec3 point = toVec3(ctx, 1);
+	const u32 count = points.count / 3;
+	NumberArray out = pushOutArray(ctx, 2, points, count);
+	if (points.is_double) distanceSquaredMany((const double*)points.data, point, (double*)out.data, count);
+	else distanceSquaredMany((const float*)points.data, point, (float*)out.data, count);
+	return 1;
+}
+
+void registerMathAPI(duk_context* ctx) {
+	static const struct {
+		const char* name;
+		duk_c_function function;
+	} FUNCTIONS[] = {
+		{"add", &jsAdd},
+		{"sub", &jsSub},
+		{"scale", &jsScale},
+		{"dot", &jsDot},
+		{"cross", &jsCross},
+		{"length", &jsLength},
+		{"distance", &jsDistance},
+		{"normalize", &jsNormalize},
+		{"lerp", &jsLerp},
+		{"quatMul", &jsQuatMul},
+		{"quatRotate", &jsQuatRotate},
+		{"quatFromAxisAngle", &jsQuatFromAxisAngle},
+		{"quatConjugate", &jsQuatConjugate},
+		{"quatNlerp", &jsQuatNlerp},
+		{"matrix", &jsMatrix},
+		{"transformPoints", &jsTransformPoints},
+		{"lerpArrays", &jsLerpArrays},
+		{"distanceSquaredMany", &jsDistanceSquaredMany},
+	};
+
+	duk_push_object(ctx);
+	for (const auto& f : FUNCTIONS) {
+		duk_push_c_function(ctx, f.function, DUK_VARARGS);
+		duk_put_prop_string(ctx, -2, f.name);
+	}
+	duk_put_prop_string(ctx, -2, "math");
+}
+
+
+} // namespace Lumix
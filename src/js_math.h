@@ -0,0 +1,19 @@
+#pragma once
+
+
+#include "duktape/duktape.h"
+
+
+namespace Lumix
+{
+
+// Lumix.math, vector math implemented natively
+// vectors are arrays as everywhere else in the API, [x, y, z] and quaternions [x, y, z, w]
+// functions returning a vector take an optional out array which is filled and returned, so scripts can reuse it
+// batch kernels take Float32Array or Float64Array with packed x, y, z and don't create any objects per element
+// there is no engine state involved, so it's registered in all kinds of heaps
+// [obj] -> [obj], sets obj.math
+void registerMathAPI(duk_context* ctx);
+
+
+} // namespace Lumix
@@ -9,18 +9,58 @@ namespace Lumix {
 const ResourceType JSScript::TYPE("js_script");
 
 
+// directive prologue, like "use strict", can be preceded only by whitespace and line comments
+static bool hasDirective(StringView src, const char* directive) {
+	const char* c = src.begin;
+	for (;;) {
+		while (c != src.end && isWhitespace(*c)) ++c;
+		if (src.end - c < 2 || c[0] != '/' || c[1] != '/') break;
+		while (c != src.end && *c != '\n') ++c;
+	}
+	if (c == src.end || (*c != '"' && *c != '\'')) return false;
+
+	const u32 len = stringLength(directive);
+	if (u32(src.end - c) < len + 2) return false;
+	return c[len + 1] == *c && equalStrings(StringView(c + 1, len), directive);
+}
+
+
+i32 JSScript::Schema::find(StableHash name_hash) const {
+	for (i32 i = 0, c = properties.size(); i < c; ++i) {
+		if (properties[i].name_hash == name_hash) return i;
+	}
+	return -1;
+}
+
+const char* JSScript::Schema::findMethod(RuntimeHash name_hash) const {
+	auto iter = methods.find(name_hash);
+	return iter.isValid() ? method_names[iter.value()].c_str() : nullptr;
+}
+
+void JSScript::Schema::clear() {
+	properties.clear();
+	methods.clear();
+	method_names.clear();
+	values_size = 0;
+	is_detected = false;
+}
+
 JSScript::JSScript(const Path& path, ResourceManager& resource_manager, IAllocator& allocator)
 	: Resource(path, resource_manager, allocator)
-	, m_source_code(allocator) {}
+	, m_source_code(allocator)
+	, m_schema(allocator) {}
 
 JSScript::~JSScript() {}
 
 void JSScript::unload() {
 	m_source_code = "";
+	m_schema.is_detected = false;
 }
 
 bool JSScript::load(Span<const u8> mem) {
 	m_source_code = StringView((const char*)mem.begin(), (u32)mem.length());
+	m_is_parallel = hasDirective(m_source_code, "use parallel");
+	m_schema.is_detected = false;
 	return true;
 }
 
@@ -2,9 +2,11 @@
 
 
 #include "core/array.h"
+#include "core/hash_map.h"
 #include "core/string.h"
 #include "engine/resource.h"
 #include "engine/resource_manager.h"
+#include "js_script_system.h"
 
 
 namespace Lumix {
@@ -13,6 +15,37 @@ namespace Lumix {
 struct JSScript final : public Resource {
 	static const ResourceType TYPE;
 
+	// properties detected on the object returned by the script, all instances of the script share them
+	struct Schema {
+		struct Property : JSScriptModule::Property {
+			Property(StringView name, IAllocator& allocator)
+				: name(name, allocator)
+			{}
+
+			String name;
+		};
+
+		explicit Schema(IAllocator& allocator)
+			: properties(allocator)
+			, methods(allocator)
+			, method_names(allocator)
+		{}
+
+		i32 find(StableHash name_hash) const;
+		// name of the object's function, nullptr if there's none
+		const char* findMethod(RuntimeHash name_hash) const;
+		void clear();
+
+		Array<Property> properties;
+		// functions of the object, index in method_names by name hash, so message handlers are looked up without touching the heap
+		HashMap<RuntimeHash, u32> methods;
+		Array<String> method_names;
+		// size of all fixed size value slots, strings are stored after them
+		u32 values_size = 0;
+		// the layout is kept after unload, until the script is detected again, so instances can still read their values
+		bool is_detected = false;
+	};
+
 	JSScript(const Path& path, ResourceManager& resource_manager, IAllocator& allocator);
 	virtual ~JSScript();
 
@@ -20,9 +53,14 @@ struct JSScript final : public Resource {
 	void unload() override;
 	bool load(Span<const u8> mem) override;
 	const char* getSourceCode() const { return m_source_code.c_str(); }
+	Schema& getSchema() { return m_schema; }
+	// "use parallel" directive, instances run in worker heaps
+	bool isParallel() const { return m_is_parallel; }
 
 private:
 	String m_source_code;
+	Schema m_schema;
+	bool m_is_parallel = false;
 };
 
 
@@ -1,8 +1,9 @@
 #include "JS_script_system.h"
 #include "core/array.h"
-#include "core/associative_array.h"
 #include "core/hash.h"
+#include "core/job_system.h"
 #include "core/log.h"
+#include "core/os.h"
 #include "core/path.h"
 #include "core/profiler.h"
 #include "core/stream.h"
@@ -15,8 +16,14 @@
 #include "engine/resource_manager.h"
 #include "engine/world.h"
 #include "imgui/imgui.h"
+#include "js_command_buffer.h"
+#include "js_component_store.h"
+#include "js_compute_jobs.h"
+#include "js_heap_snapshot.h"
+#include "js_math.h"
 #include "js_script_manager.h"
 #include "js_wrapper.h"
+#include "physics/physics_module.h"
 
 #undef EOF
 
@@ -34,6 +41,205 @@ inline const char* fromCString(StringView input, EntityPtr& value) {
 }
 
 static const ComponentType JS_SCRIPT_TYPE = reflection::getComponentType("js_script");
+// stash property with modules loaded by require, keyed by path
+static const char* REQUIRE_CACHE = "require_cache";
+// stash property with callbacks of timers, keyed by timer id
+static const char* TIMERS_KEY = "c_timers";
+// stash property with Duktape.Thread of coroutines, keyed by coroutine id
+static const char* COROUTINES_KEY = "c_coroutines";
+// stash property with values of queued coroutine wakeups, keyed by wakeup's value id
+static const char* COROUTINE_VALUES_KEY = "c_coroutine_values";
+// stash property with handlers of engine events, keyed by subscription id
+static const char* EVENT_HANDLERS_KEY = "c_event_handlers";
+// stash property with payloads of queued messages, keyed by payload id
+static const char* MESSAGES_KEY = "c_messages";
+// stash property with arrays passed to system scripts, keyed by system's views id
+static const char* SYSTEMS_KEY = "c_systems";
+// stash property with script objects of component stores, keyed by pointer to the store
+static const char* COMPONENT_STORES_KEY = "c_component_stores";
+// stash property with completion callbacks of tweens, keyed by tween id
+static const char* TWEENS_KEY = "c_tweens";
+// stash property with the object returned by COROUTINE_API_SRC
+static const char* COROUTINE_API_KEY = "c_coroutine_api";
+
+// what a coroutine yields, [CoroutineWait, argument], see COROUTINE_API_SRC
+enum class CoroutineWait : i32 {
+	TIME,
+	FRAMES,
+	RESOURCE,
+	SIGNAL,
+	DONE
+};
+
+// value animated by a tween, see Lumix.tween
+enum class TweenTarget : u8 {
+	POSITION,
+	ROTATION,
+	SCALE,
+	// reflected component properties
+	FLOAT,
+	VEC2,
+	VEC3,
+	VEC4
+};
+
+enum class Easing : u8 {
+	LINEAR,
+	IN_QUAD,
+	OUT_QUAD,
+	IN_OUT_QUAD,
+	IN_CUBIC,
+	OUT_CUBIC,
+	IN_OUT_CUBIC,
+	SMOOTHSTEP
+};
+
+// in the order of Easing
+static const char* EASING_NAMES[] = {"linear", "inQuad", "outQuad", "inOutQuad", "inCubic", "outCubic", "inOutCubic", "smoothstep"};
+
+// t is from [0, 1], so is the result
+static float ease(Easing easing, float t) {
+	switch (easing) {
+		case Easing::LINEAR: return t;
+		case Easing::IN_QUAD: return t * t;
+		case Easing::OUT_QUAD: return t * (2 - t);
+		case Easing::IN_OUT_QUAD: return t < 0.5f ? 2 * t * t : -1 + (4 - 2 * t) * t;
+		case Easing::IN_CUBIC: return t * t * t;
+		case Easing::OUT_CUBIC: return (t - 1) * (t - 1) * (t - 1) + 1;
+		case Easing::IN_OUT_CUBIC: return t < 0.5f ? 4 * t * t * t : (t - 1) * (2 * t - 2) * (2 * t - 2) + 1;
+		case Easing::SMOOTHSTEP: return t * t * (3 - 2 * t);
+	}
+	ASSERT(false);
+	return t;
+}
+
+// yield works only if there are no native calls between it and resume, so these are in JS
+static const char* COROUTINE_API_SRC = R"#(
+(function() {
+	var Thread = Duktape.Thread;
+	Lumix.wait = function(seconds) { return Thread.yield([0, seconds]); };
+	Lumix.waitFrames = function(frames) { return Thread.yield([1, frames]); };
+	Lumix.waitResource = function(resource) { return Thread.yield([2, resource]); };
+	Lumix.waitSignal = function(name) { return Thread.yield([3, name]); };
+	return {
+		create: function(fn, self) {
+			return new Thread(function() {
+				fn.call(self);
+				return [4];
+			});
+		},
+		resume: function(thread, value) { return Thread.resume(thread, value); }
+	};
+})()
+)#";
+
+enum class JSScriptModuleVersion : i32 {
+	SCHEMA_ROWS,
+	COMPONENT_STORES,
+
+	LATEST
+};
+
+// strings and arrays live in an arena after fixed size slots in instance's values, strings are null-terminated
+struct ArenaSlot {
+	u32 offset;
+	// in bytes, without the null terminator
+	u32 size;
+};
+
+static bool isStringType(JSScriptModule::Property::Type type) {
+	return type == JSScriptModule::Property::STRING || type == JSScriptModule::Property::RESOURCE;
+}
+
+static bool isArrayType(JSScriptModule::Property::Type type) {
+	switch (type) {
+		case JSScriptModule::Property::F32_ARRAY:
+		case JSScriptModule::Property::F64_ARRAY:
+		case JSScriptModule::Property::I32_ARRAY: return true;
+		default: return false;
+	}
+}
+
+// number of floats in vector types, 0 for other types
+static u32 getVectorSize(JSScriptModule::Property::Type type) {
+	switch (type) {
+		case JSScriptModule::Property::VEC2: return 2;
+		case JSScriptModule::Property::VEC3: return 3;
+		case JSScriptModule::Property::VEC4:
+		case JSScriptModule::Property::COLOR:
+		case JSScriptModule::Property::QUAT: return 4;
+		default: return 0;
+	}
+}
+
+static u32 getValueSlotSize(JSScriptModule::Property::Type type) {
+	switch (type) {
+		case JSScriptModule::Property::BOOLEAN: return sizeof(bool);
+		case JSScriptModule::Property::NUMBER: return sizeof(double);
+		case JSScriptModule::Property::ENTITY: return sizeof(EntityPtr);
+		case JSScriptModule::Property::VEC2:
+		case JSScriptModule::Property::VEC3:
+		case JSScriptModule::Property::VEC4:
+		case JSScriptModule::Property::COLOR:
+		case JSScriptModule::Property::QUAT: return getVectorSize(type) * sizeof(float);
+		case JSScriptModule::Property::STRING:
+		case JSScriptModule::Property::RESOURCE:
+		case JSScriptModule::Property::F32_ARRAY:
+		case JSScriptModule::Property::F64_ARRAY:
+		case JSScriptModule::Property::I32_ARRAY: return sizeof(ArenaSlot);
+	}
+	ASSERT(false);
+	return 0;
+}
+
+static duk_uint_t getBufferObjectType(JSScriptModule::Property::Type type) {
+	switch (type) {
+		case JSScriptModule::Property::F32_ARRAY: return DUK_BUFOBJ_FLOAT32ARRAY;
+		case JSScriptModule::Property::F64_ARRAY: return DUK_BUFOBJ_FLOAT64ARRAY;
+		case JSScriptModule::Property::I32_ARRAY: return DUK_BUFOBJ_INT32ARRAY;
+		default: ASSERT(false); return DUK_BUFOBJ_ARRAYBUFFER;
+	}
+}
+
+static const char* getTypedArrayConstructor(JSScriptModule::Property::Type type) {
+	switch (type) {
+		case JSScriptModule::Property::F32_ARRAY: return "Float32Array";
+		case JSScriptModule::Property::F64_ARRAY: return "Float64Array";
+		case JSScriptModule::Property::I32_ARRAY: return "Int32Array";
+		default: ASSERT(false); return nullptr;
+	}
+}
+
+// tagged values of fixed size types are raw slots, strings are null-terminated and arrays are prefixed by their size in bytes
+static void writeTaggedValue(OutputMemoryStream& tagged, JSScriptModule::Property::Type type, const u8* values, u32 offset) {
+	if (!isStringType(type) && !isArrayType(type)) {
+		tagged.write(values + offset, getValueSlotSize(type));
+		return;
+	}
+
+	ArenaSlot slot;
+	memcpy(&slot, values + offset, sizeof(slot));
+	if (isArrayType(type)) tagged.write(slot.size);
+	tagged.write(values + slot.offset, slot.size);
+	if (isStringType(type)) tagged.write('\0');
+}
+
+static void skipTaggedValue(InputMemoryStream& blob, JSScriptModule::Property::Type type) {
+	if (isStringType(type)) blob.readString();
+	else if (isArrayType(type)) blob.skip(blob.read<u32>());
+	else blob.skip(getValueSlotSize(type));
+}
+
+// duk_instanceof throws if the value is not an object
+static bool isTypedArray(duk_context* ctx, duk_idx_t idx, JSScriptModule::Property::Type type) {
+	if (!duk_is_buffer_data(ctx, idx) || !duk_is_object(ctx, idx)) return false;
+
+	idx = duk_normalize_index(ctx, idx);
+	duk_get_global_string(ctx, getTypedArrayConstructor(type));
+	const bool res = duk_instanceof(ctx, idx, -1);
+	duk_pop(ctx);
+	return res;
+}
 
 namespace JSImGui {
 int Text(duk_context* ctx) {
@@ -127,6 +333,60 @@ int LabelText(duk_context* ctx) {
 } // namespace JSImGui
 
 
+struct JSScriptModuleImpl;
+
+// Duktape heap with its allocator, shared by all worlds or owned by one world
+struct JSHeap {
+	explicit JSHeap(IAllocator& allocator) : allocator(allocator) {}
+	~JSHeap() {
+		if (ctx) duk_destroy_heap(ctx);
+	}
+
+	JSAllocator allocator;
+	duk_context* ctx = nullptr;
+	JSGCStats gc_stats;
+	os::Timer gc_frame_timer;
+	// if set, world writes are recorded here instead of being applied
+	JSCommandBuffer* commands = nullptr;
+	// script instance whose code runs, it owns timers created meanwhile
+	JSScriptModuleImpl* module = nullptr;
+	uintptr instance = 0;
+	// worker heaps: components whose properties can be read, see JSScriptSystem::setParallelReadable
+	const Array<ComponentType>* readable = nullptr;
+	// if set, errors are recorded here and logged on the main thread
+	OutputMemoryStream* log = nullptr;
+	// ids of timers and coroutines are unique in the heap, worlds can share it
+	u32 generateID() {
+		const u32 id = next_id++;
+		if (next_id == 0) next_id = 1;
+		return id;
+	}
+	u32 next_id = 1;
+};
+
+static const char* HEAP_KEY = "c_heap";
+static constexpr u32 MAX_WORKER_HEAPS = 8;
+
+static JSHeap& getHeap(duk_context* ctx) {
+	duk_push_global_stash(ctx);
+	duk_get_prop_string(ctx, -1, HEAP_KEY);
+	JSHeap* heap = (JSHeap*)duk_get_pointer(ctx, -1);
+	duk_pop_2(ctx);
+	ASSERT(heap);
+	return *heap;
+}
+
+// if set, world writes should be recorded instead of being applied
+static JSCommandBuffer* getCommandBuffer(duk_context* ctx) {
+	return getHeap(ctx).commands;
+}
+
+static void reportError(JSHeap& heap, const char* msg) {
+	if (heap.log) heap.log->write(msg, stringLength(msg) + 1);
+	else logError(msg);
+}
+
+
 static int ptrJSConstructor(duk_context* ctx) {
 	if (!duk_is_constructor_call(ctx)) return DUK_RET_TYPE_ERROR;
 
@@ -137,6 +397,8 @@ static int ptrJSConstructor(duk_context* ctx) {
 	return 0;
 }
 
+// defined after JSScriptModuleImpl, keeps its name index up to date
+static void renameEntity(World& world, EntityRef entity, const char* name);
 
 static int entityProxySetter(duk_context* ctx) {
 	duk_get_prop_string(ctx, 0, "c_world");
@@ -147,18 +409,35 @@ static int entityProxySetter(duk_context* ctx) {
 
 	duk_pop_2(ctx);
 
+	JSCommandBuffer* commands = getCommandBuffer(ctx);
 	const char* prop_name = duk_get_string(ctx, 1);
 	if (equalStrings(prop_name, "rotation")) {
 		Quat r = JSWrapper::toType<Quat>(ctx, 2);
-		world->setRotation(entity, r);
+		if (commands) commands->setRotation(entity, r);
+		else world->setRotation(entity, r);
 	}
 	else if (equalStrings(prop_name, "position")) {
 		DVec3 v = JSWrapper::toType<DVec3>(ctx, 2);
-		world->setPosition(entity, v);
+		if (commands) commands->setPosition(entity, v);
+		else world->setPosition(entity, v);
 	}
 	else if (equalStrings(prop_name, "scale")) {
 		Vec3 v = JSWrapper::toType<Vec3>(ctx, 2);
-		world->setScale(entity, v);
+		if (commands) commands->setScale(entity, v);
+		else world->setScale(entity, v);
+	}
+	else if (equalStrings(prop_name, "name")) {
+		const char* name = JSWrapper::toType<const char*>(ctx, 2);
+		// parallel scripts must not touch the world nor the module's name index
+		IModule* module = world->getModule(JS_SCRIPT_TYPE);
+		if (commands && module) {
+			commands->call<IModule, const char*>(module, entity, INVALID_COMPONENT_TYPE, name, [](IModule* module, EntityRef entity, const char* value) {
+				renameEntity(module->getWorld(), entity, value);
+			});
+		}
+		else {
+			renameEntity(*world, entity, name);
+		}
 	}
 	else {
 		duk_push_sprintf(ctx, " trying to set unknown property %s", prop_name);
@@ -197,6 +476,18 @@ static int entityProxyGetter(duk_context* ctx) {
 		JSWrapper::push(ctx, world->getScale(entity));
 		return 1;
 	}
+	if (equalStrings(prop_name, "name")) {
+		duk_push_string(ctx, world->getEntityName(entity));
+		return 1;
+	}
+	const bool is_parent = equalStrings(prop_name, "parent");
+	const bool is_first_child = !is_parent && equalStrings(prop_name, "firstChild");
+	if (is_parent || is_first_child || equalStrings(prop_name, "nextSibling")) {
+		const EntityPtr related = is_parent ? world->getParent(entity) : is_first_child ? world->getFirstChild(entity) : world->getNextSibling(entity);
+		if (related.isValid()) JSWrapper::pushEntity(ctx, related, world);
+		else duk_push_null(ctx);
+		return 1;
+	}
 	if (!reflection::componentTypeExists(prop_name)) return 0;
 
 	ComponentType cmp_type = reflection::getComponentType(prop_name);
@@ -273,16 +564,16 @@ static void registerJSObject(duk_context* ctx, const char* prototype, const char
 }
 
 
+// constructor is put in the object on the top of the stack
 static void registerJSComponent(duk_context* ctx, ComponentType cmp_type, const char* name, duk_c_function constructor) {
 	duk_push_c_function(ctx, constructor, DUK_VARARGS);
 
 	duk_push_object(ctx); // prototype
-	duk_put_prop_string(ctx, -2, "prototype");
-
 	duk_push_int(ctx, cmp_type.index);
 	duk_put_prop_string(ctx, -2, "c_cmptype");
+	duk_put_prop_string(ctx, -2, "prototype");
 
-	duk_put_global_string(ctx, name);
+	duk_put_prop_string(ctx, -2, name);
 }
 
 
@@ -327,24 +618,124 @@ struct JSScriptManager final : public ResourceManager {
 	IAllocator& m_allocator;
 };
 
+// sums sizes of heap values reachable from roots, each value is counted only for the first root which reaches it
+// getters are not called and values captured only by closures are not reached, so the sizes are approximate
+struct JSHeapWalker {
+	JSHeapWalker(duk_context* ctx, IAllocator& allocator)
+		: m_ctx(ctx)
+		, m_visited(allocator)
+		, m_stack(allocator)
+	{}
+
+	// walks from the value on the top of the stack, does not pop it
+	void walk(JSMemoryItem& item) {
+		JSWrapper::DebugGuard guard(m_ctx);
+		push(-1);
+		while (!m_stack.empty()) {
+			void* ptr = m_stack.back();
+			m_stack.pop();
+			duk_push_heapptr(m_ctx, ptr);
+			item.bytes += getSize();
+			++item.objects;
+
+			if (duk_is_object(m_ctx, -1)) {
+				duk_get_prototype(m_ctx, -1);
+				push(-1);
+				duk_pop(m_ctx);
+
+				duk_enum(m_ctx, -1, DUK_ENUM_OWN_PROPERTIES_ONLY | DUK_ENUM_INCLUDE_NONENUMERABLE | DUK_ENUM_INCLUDE_HIDDEN | DUK_ENUM_INCLUDE_SYMBOLS);
+				while (duk_next(m_ctx, -1, 0)) {
+					// [obj enum key]
+					push(-1);
+					// descriptor does not call getters
+					duk_get_prop_desc(m_ctx, -3, 0);
+					if (duk_is_object(m_ctx, -1)) {
+						static const char* fields[] = { "value", "get", "set" };
+						for (const char* field : fields) {
+							duk_get_prop_string(m_ctx, -1, field);
+							push(-1);
+							duk_pop(m_ctx);
+						}
+					}
+					duk_pop(m_ctx);
+				}
+				duk_pop(m_ctx);
+			}
+			duk_pop(m_ctx);
+		}
+	}
+
+	void push(duk_idx_t idx) {
+		// null for values which are not allocated on the heap
+		void* ptr = duk_get_heapptr(m_ctx, idx);
+		if (!ptr) return;
+
+		const u64 key = (u64)(uintptr)ptr;
+		if (m_visited.find(key).isValid()) return;
+
+		m_visited.insert(key, true);
+		m_stack.push(ptr);
+	}
+
+	// value on the top of the stack
+	u64 getSize() {
+		duk_inspect_value(m_ctx, -1);
+		u64 size = 0;
+		static const char* fields[] = { "hbytes", "pbytes", "bcbytes", "dbytes" };
+		for (const char* field : fields) {
+			duk_get_prop_string(m_ctx, -1, field);
+			size += (u64)duk_get_number_default(m_ctx, -1, 0);
+			duk_pop(m_ctx);
+		}
+		duk_pop(m_ctx);
+		return size;
+	}
+
+	duk_context* m_ctx;
+	HashMap<u64, bool> m_visited;
+	Array<void*> m_stack;
+};
+
+
 struct JSScriptSystemImpl final : JSScriptSystem {
 	explicit JSScriptSystemImpl(Engine& engine);
 	virtual ~JSScriptSystemImpl();
 	void initBegin() override;
-	duk_context* getGlobalContext() override { return m_global_context; }
+	duk_context* getGlobalContext() override { return m_heap.ctx; }
+	const JSAllocator::Stats& getHeapStats(duk_context* ctx) override { return getHeap(ctx).allocator.getStats(); }
+	const JSGCStats& getGCStats(duk_context* ctx) override { return getHeap(ctx).gc_stats; }
+	void collectGarbage(duk_context* ctx, bool compact) override { collectGarbage(getHeap(ctx), compact); }
+	void setGCFrameBudget(float ms) override { m_gc_frame_budget_ms = ms; }
+	void setPerWorldHeaps(bool enable) override { m_per_world_heaps = enable; }
+	void setParallelReadable(ComponentType type, bool readable) override;
+	void createHeap(JSHeap& heap);
+	UniquePtr<JSHeap> createWorkerHeap();
+	void collectGarbage(JSHeap& heap, bool compact);
+	void updateGC(JSHeap& heap);
+	void pushHeapCounters(JSHeap& heap);
 
 	void serialize(OutputMemoryStream& serializer) const override {}
 	bool deserialize(i32 version, InputMemoryStream& serializer) override { return version == 0; }
 	void createModules(World& world) override;
 	const char* getName() const override { return "js_script"; }
 	JSScriptManager& getScriptManager() { return m_script_manager; }
-	void registerGlobalAPI();
-	void registerImGuiAPI();
+	void registerGlobalAPI(duk_context* ctx, bool is_worker);
+	static void registerComputeAPI(duk_context* ctx);
+	void registerImGuiAPI(duk_context* ctx);
 
 	Engine& m_engine;
 	IAllocator& m_allocator;
 	JSScriptManager m_script_manager;
-	duk_context* m_global_context;
+	// shared by worlds, unless m_per_world_heaps is set
+	JSHeap m_heap;
+	JSComputeJobs m_compute_jobs;
+	u32 m_heap_live_counter;
+	u32 m_heap_reserved_counter;
+	u32 m_gc_pause_counter;
+	float m_gc_frame_budget_ms = 1000 / 60.f;
+	bool m_per_world_heaps = false;
+	// read by worker heaps while the main thread waits for them
+	Array<ComponentType> m_parallel_readable;
 
 	static inline JSScriptSystemImpl* s_instance = nullptr;
 };
@@ -356,14 +747,208 @@ struct JSScriptModuleImpl final : public JSScriptModule{
 		uintptr id;
 	};
 
+	// values of all properties of an instance are in one buffer
+	// resolved - fixed size slots laid out by script's schema, followed by an arena with strings
+	// unresolved - schema is not known yet, u32 count followed by (name hash, u8 type, value) records
+	// unresolved with m_row_layout - row loaded before the schema was detected, it's used as is if the schema matches the layout
 	struct ScriptInstance {
 		explicit ScriptInstance(IAllocator& allocator)
-			: m_properties(allocator)
+			: m_values(allocator)
 			, m_script(nullptr) {}
 
 		JSScript* m_script;
-		Array<Property> m_properties;
+		OutputMemoryStream m_values;
+		bool m_values_resolved = false;
+		// index in m_row_layouts, -1 if m_values are not a row
+		i32 m_row_layout = -1;
 		uintptr m_id;
+		// index in m_workers, -1 if the instance is in module's heap
+		i32 m_worker = -1;
+		// PhysicsHook flags, functions the script defines
+		u8 m_physics_hooks = 0;
+	};
+
+	enum PhysicsHook : u8 {
+		CONTACT = 1 << 0,
+		TRIGGER_ENTER = 1 << 1,
+		TRIGGER_EXIT = 1 << 2
+	};
+
+	// layout of rows in a loaded world, props are in m_row_layout_props
+	struct RowLayout {
+		u32 first_prop;
+		u32 num_props;
+	};
+
+	struct TriggerEvent {
+		EntityRef trigger;
+		EntityRef other;
+		bool touch_lost;
+	};
+
+	struct Tween {
+		u32 id;
+		EntityRef entity;
+		TweenTarget target;
+		Easing easing;
+		bool has_callback;
+		// reflection::Property<float>, <Vec2>, <Vec3> or <Vec4> if target is a component property
+		const void* property;
+		ComponentType cmp_type;
+		IModule* module;
+		double from[4];
+		double to[4];
+		float time;
+		float duration;
+		// instance which created the tween, `this` of the callback
+		uintptr owner;
+	};
+
+	// heap with parallel scripts, updated on a job thread
+	// writes are recorded in commands during the update and applied on the main thread afterwards
+	struct Worker {
+		explicit Worker(IAllocator& allocator)
+			: updates(allocator)
+			, commands(allocator)
+			, log(allocator)
+		{}
+
+		UniquePtr<JSHeap> heap;
+		Array<ContextRef> updates;
+		JSCommandBuffer commands;
+		// null terminated error messages
+		OutputMemoryStream log;
+	};
+
+	struct TaggedValue {
+		StableHash name_hash;
+		Property::Type type;
+		// offset of the value in unresolved instance's values
+		u32 offset;
+	};
+
+	// setTimeout and setInterval, callback is in stash's TIMERS_KEY object
+	// also coroutines waiting for time or frames, id is then the coroutine's
+	struct Timer {
+		// ms since the game started, frame number for frame waits
+		double time;
+		double interval;
+		u32 id;
+		bool repeat;
+		bool is_coroutine;
+		// instance which created the timer, `this` of the callback
+		uintptr owner;
+	};
+
+	struct ResourceWait {
+		u32 coroutine;
+		Resource* resource;
+	};
+
+	struct SignalWait {
+		u32 coroutine;
+		RuntimeHash name;
+	};
+
+	// resume requested while a coroutine runs, the main context can't be called then
+	struct CoroutineWake {
+		u32 coroutine;
+		// in COROUTINE_VALUES_KEY, 0 is undefined
+		u32 value;
+	};
+
+	static constexpr u32 MAX_EVENT_ARGS = 8;
+
+	// fixed size, so posting does not allocate except when the queue grows
+	struct QueuedEvent {
+		RuntimeHash type;
+		EntityPtr entity;
+		u32 arg_count;
+		// index of the next queued event of the same type, -1 if there's none
+		i32 next;
+		JSEventArg args[MAX_EVENT_ARGS];
+	};
+
+	// handler is in stash's EVENT_HANDLERS_KEY object
+	struct EventSubscription {
+		RuntimeHash type;
+		// INVALID_ENTITY for events of all entities
+		EntityPtr entity;
+		uintptr owner;
+		u32 id;
+		bool removed;
+	};
+
+	// Lumix.send and Lumix.broadcast
+	struct Message {
+		// INVALID_ENTITY for broadcast
+		EntityPtr target;
+		// handlers are found by it in receivers' schemas
+		RuntimeHash name_hash;
+		// key in stash's MESSAGES_KEY object, 0 if there's no payload
+		u32 payload;
+		// order of sending
+		u32 seq;
+	};
+
+	struct MessageReceiver {
+		EntityRef entity;
+		uintptr instance;
+	};
+
+	static constexpr u32 MAX_QUERY_COMPONENTS = 8;
+
+	// entities with all the components, see world.query
+	struct EntityQuery {
+		explicit EntityQuery(IAllocator& allocator) : entities(allocator) {}
+
+		// sorted by index
+		ComponentType types[MAX_QUERY_COMPONENTS];
+		u32 type_count;
+		Array<i32> entities;
+		// rebuilt on the next query, set when a component of one of the types is created or destroyed
+		bool dirty;
+	};
+
+	// see addSystem
+	struct SystemScript {
+		JSScript* script;
+		// key of the object returned by the script in the stash, owner of its timers, coroutines and subscriptions
+		uintptr id;
+		// key in stash's SYSTEMS_KEY object
+		u32 views_id;
+		// number of entities the views were created for
+		u32 views_count;
+		ComponentType types[MAX_QUERY_COMPONENTS];
+		u32 type_count;
+		// the script wants typed array views of the entities' transforms
+		bool transforms;
+		bool started;
+		// failed to start, it's not updated
+		bool failed;
+		// removed during updateSystems, erased after the loop
+		bool removed;
+	};
+
+	// code of the instance runs in the heap
+	struct InstanceScope {
+		InstanceScope(JSHeap& heap, JSScriptModuleImpl* module, uintptr instance)
+			: heap(heap)
+			, prev_module(heap.module)
+			, prev_instance(heap.instance)
+		{
+			heap.module = module;
+			heap.instance = instance;
+		}
+
+		~InstanceScope() {
+			heap.module = prev_module;
+			heap.instance = prev_instance;
+		}
+
+		JSHeap& heap;
+		JSScriptModuleImpl* prev_module;
+		uintptr prev_instance;
 	};
 
 
@@ -374,21 +959,15 @@ struct JSScriptModuleImpl final : public JSScriptModule{
 			, m_entity(entity) {}
 
 
-		static int getProperty(ScriptInstance& inst, StableHash hash) {
-			for (int i = 0, c = inst.m_properties.size(); i < c; ++i) {
-				if (inst.m_properties[i].name_hash == hash) return i;
-			}
-			return -1;
-		}
-
-
 		void onScriptLoaded(Resource::State old_state, Resource::State new_state, Resource& resource) {
-			duk_context* ctx = m_module.m_system.m_global_context;
 			for (auto& script : m_scripts) {
-				if (!script.m_script) continue;
-				if (!script.m_script->isReady()) continue;
 				if (script.m_script != &resource) continue;
 
+				// (READY, READY) is reported when the observer is bound to a loaded script, the schema is the same
+				if (old_state == Resource::State::READY && new_state != Resource::State::READY) {
+					// new version of the script can have different schema
+					m_module.unresolveValues(script);
+				}
 				if (new_state == Resource::State::READY) {
 					m_module.onScriptLoaded(m_entity, script, false);
 				}
@@ -432,6 +1011,13 @@ struct JSScriptModuleImpl final : public JSScriptModule{
 
 public:
 	~JSScriptModuleImpl() {
+		m_world.componentAdded().unbind<&JSScriptModuleImpl::onComponentChanged>(this);
+		m_world.componentDestroyed().unbind<&JSScriptModuleImpl::onComponentChanged>(this);
+		m_world.entityDestroyed().unbind<&JSScriptModuleImpl::onEntityDestroyed>(this);
+		m_world.entityCreated().unbind<&JSScriptModuleImpl::onEntityCreated>(this);
+		m_system.m_compute_jobs.cancel(this);
+		destroyComponentStores();
+		for (SystemScript& system : m_system_scripts) system.script->decRefCount();
 		Path invalid_path;
 		for (auto* script_cmp : m_scripts) {
 			if (!script_cmp) continue;
@@ -443,23 +1029,62 @@ public:
 		}
 	}
 
-	JSScriptModuleImpl(JSScriptSystemImpl& system, World& ctx)
+	JSScriptModuleImpl(JSScriptSystemImpl& system, World& ctx, UniquePtr<JSHeap>&& own_heap)
 		: m_system(system)
+		, m_own_heap(own_heap.move())
+		, m_heap(m_own_heap ? m_own_heap.get() : &system.m_heap)
 		, m_world(ctx)
 		, m_scripts(system.m_allocator)
 		, m_updates(system.m_allocator)
 		, m_input_handlers(system.m_allocator)
-		, m_property_names(system.m_allocator)
+		, m_values_scratch(system.m_allocator)
+		, m_tagged_values(system.m_allocator)
+		, m_row_layouts(system.m_allocator)
+		, m_row_layout_props(system.m_allocator)
+		, m_workers(system.m_allocator)
+		, m_commands(system.m_allocator)
+		, m_timers(system.m_allocator)
+		, m_expired_timers(system.m_allocator)
+		, m_coroutines(system.m_allocator)
+		, m_frame_waits(system.m_allocator)
+		, m_resource_waits(system.m_allocator)
+		, m_coroutine_resources(system.m_allocator)
+		, m_signal_waits(system.m_allocator)
+		, m_coroutine_wakes(system.m_allocator)
+		, m_ready_coroutines(system.m_allocator)
+		, m_events(system.m_allocator)
+		, m_delivered_events(system.m_allocator)
+		, m_event_chains(system.m_allocator)
+		, m_event_subscriptions(system.m_allocator)
+		, m_contacts(system.m_allocator)
+		, m_triggers(system.m_allocator)
+		, m_hook_instances(system.m_allocator)
+		, m_messages(system.m_allocator)
+		, m_delivered_messages(system.m_allocator)
+		, m_message_receivers(system.m_allocator)
+		, m_queries(system.m_allocator)
+		, m_name_index(system.m_allocator)
+		, m_unnamed_entities(system.m_allocator)
+		, m_tweens(system.m_allocator)
+		, m_finished_tweens(system.m_allocator)
+		, m_system_scripts(system.m_allocator)
+		, m_system_entities(system.m_allocator)
+		, m_system_transforms(system.m_allocator)
+		, m_component_stores(system.m_allocator)
 		, m_is_game_running(false)
 		, m_is_api_registered(false) {
 		m_function_call.is_in_progress = false;
 
+		m_world.componentAdded().bind<&JSScriptModuleImpl::onComponentChanged>(this);
+		m_world.componentDestroyed().bind<&JSScriptModuleImpl::onComponentChanged>(this);
+		m_world.entityDestroyed().bind<&JSScriptModuleImpl::onEntityDestroyed>(this);
+		m_world.entityCreated().bind<&JSScriptModuleImpl::onEntityCreated>(this);
 		registerAPI();
 	}
 
 
 	const char* getName() const override { return "js_script"; }
-	int getVersion() const override { return -1; }
+	int getVersion() const override { return (i32)JSScriptModuleVersion::LATEST; }
 
 	JSExecuteResult execute(EntityRef entity, i32 scr_index, StringView code) override {
 		auto iter = m_scripts.find(entity);
@@ -470,7 +1095,8 @@ public:
 
 		ScriptInstance& script = script_cmp->m_scripts[scr_index];
 
-		duk_context* ctx = m_system.m_global_context;
+		duk_context* ctx = getContext(script);
+		InstanceScope scope(getInstanceHeap(script), this, script.m_id);
 
 		if (duk_pcompile_lstring(ctx, DUK_COMPILE_EVAL, code.begin, code.size()) != 0) {
 			logError("Compile failed: ", duk_safe_to_stacktrace(ctx, -1));
@@ -496,7 +1122,7 @@ public:
 		auto* script_cmp = m_scripts[entity];
 		auto& script = script_cmp->m_scripts[scr_index];
 
-		duk_context* ctx = m_system.m_global_context;
+		duk_context* ctx = getContext(script);
 
 		duk_push_global_stash(ctx);
 		duk_push_pointer(ctx, (void*)script.m_id);
@@ -528,6 +1154,7 @@ public:
 		m_function_call.is_in_progress = false;
 
 		auto& script = m_function_call.cmp->m_scripts[m_function_call.scr_index];
+		InstanceScope scope(getInstanceHeap(script), this, script.m_id);
 
 		if (duk_pcall_method(m_function_call.context, m_function_call.parameter_count) == DUK_EXEC_ERROR) {
 			const char* error = duk_safe_to_string(m_function_call.context, -1);
@@ -537,291 +1164,797 @@ public:
 	}
 
 
-	int getPropertyCount(EntityRef entity, int scr_index) override { return m_scripts[entity]->m_scripts[scr_index].m_properties.size(); }
+	int getPropertyCount(EntityRef entity, int scr_index) override {
+		const ScriptInstance& inst = m_scripts[entity]->m_scripts[scr_index];
+		return inst.m_values_resolved ? inst.m_script->getSchema().properties.size() : 0;
+	}
 
 
-	const char* getPropertyName(EntityRef entity, int scr_index, int prop_index) override { return getPropertyName(m_scripts[entity]->m_scripts[scr_index].m_properties[prop_index].name_hash); }
+	const JSScript::Schema::Property& getSchemaProperty(EntityRef entity, int scr_index, int prop_index) {
+		const ScriptInstance& inst = m_scripts[entity]->m_scripts[scr_index];
+		ASSERT(inst.m_values_resolved);
+		return inst.m_script->getSchema().properties[prop_index];
+	}
 
 
-	ResourceType getPropertyResourceType(EntityRef entity, int scr_index, int prop_index) override { return m_scripts[entity]->m_scripts[scr_index].m_properties[prop_index].resource_type; }
+	const char* getPropertyName(EntityRef entity, int scr_index, int prop_index) override { return getSchemaProperty(entity, scr_index, prop_index).name.c_str(); }
 
 
-	Property::Type getPropertyType(EntityRef entity, int scr_index, int prop_index) override { return m_scripts[entity]->m_scripts[scr_index].m_properties[prop_index].type; }
+	ResourceType getPropertyResourceType(EntityRef entity, int scr_index, int prop_index) override { return getSchemaProperty(entity, scr_index, prop_index).resource_type; }
 
 
-	void getScriptData(EntityRef entity, OutputMemoryStream& blob) override {
-		/*auto* scr = m_scripts[entity];
-		blob.write(scr->m_scripts.size());
-		for (int i = 0; i < scr->m_scripts.size(); ++i) {
-			auto& inst = scr->m_scripts[i];
-			blob.writeString(inst.m_script ? inst.m_script->getPath().c_str() : "");
-			blob.write(inst.m_properties.size());
-			for (auto& prop : inst.m_properties) {
-				blob.write(prop.name_hash);
-				blob.write(prop.type);
-				char tmp[1024];
-				tmp[0] = '\0';
-				const char* prop_name = getPropertyName(prop.name_hash);
-				if (prop_name) getPropertyValue(entity, i, getPropertyName(prop.name_hash), tmp, lengthOf(tmp));
-				blob.writeString(prop_name ? tmp : prop.stored_value.c_str());
-			}
-		}*/
-		ASSERT(false);
-	}
+	Property::Type getPropertyType(EntityRef entity, int scr_index, int prop_index) override { return getSchemaProperty(entity, scr_index, prop_index).type; }
 
 
-	duk_context* getGlobalContext() override { return m_system.m_global_context; }
+	// blob contains the number of scripts, then tagged records of each script
+	void getScriptData(EntityRef entity, OutputMemoryStream& blob) override {
+		ScriptComponent* cmp = m_scripts[entity];
+		blob.write((u32)cmp->m_scripts.size());
+		for (ScriptInstance& inst : cmp->m_scripts) writeScriptData(inst, blob);
+	}
 
 	void setScriptData(EntityRef entity, InputMemoryStream& blob) override {
-		ASSERT(false); // TODO
-					   /*
-					   auto* scr = m_scripts[entity];
-					   int count;
-					   blob.read(count);
-					   for (int i = 0; i < count; ++i)
-					   {
-						   int idx = addScript(cmp);
-						   auto& inst = scr->m_scripts[idx];
-						   char tmp[MAX_PATH_LENGTH];
-						   blob.readString(tmp, lengthOf(tmp));
-						   setScriptPath(cmp, idx, Path(tmp));
-			   
-						   int prop_count;
-						   blob.read(prop_count);
-						   for (int j = 0; j < prop_count; ++j)
-						   {
-							   u32 hash;
-							   blob.read(hash);
-							   int prop_index = scr->getProperty(inst, hash);
-							   if (prop_index < 0)
-							   {
-								   scr->m_scripts[idx].m_properties.emplace(m_system.m_allocator);
-								   prop_index = scr->m_scripts[idx].m_properties.size() - 1;
-							   }
-							   auto& prop = scr->m_scripts[idx].m_properties[prop_index];
-							   prop.name_hash = hash;
-							   blob.read(prop.type);
-							   char tmp[1024];
-							   blob.readString(tmp, lengthOf(tmp));
-							   prop.stored_value = tmp;
-							   if (scr->m_scripts[idx].m_state) applyProperty(scr->m_scripts[idx], prop, tmp);
-						   }
-					   }
-					   */
+		ScriptComponent* cmp = m_scripts[entity];
+		const u32 count = blob.read<u32>();
+		for (u32 i = 0; i < count; ++i) {
+			if (i < (u32)cmp->m_scripts.size()) readScriptData(cmp->m_scripts[i], blob);
+			else skipTaggedValues(blob);
+		}
 	}
 
+	// tagged records, the same as values of instances which are not resolved yet
+	void writeScriptData(ScriptInstance& inst, OutputMemoryStream& blob) {
+		if (!inst.m_values_resolved) {
+			tagPendingRow(inst);
+			if (inst.m_values.empty()) blob.write((u32)0);
+			else blob.write(inst.m_values.data(), inst.m_values.size());
+			return;
+		}
 
-
-	World& getWorld() override { return m_world; }
-
-
-	void getInstanceName(IModule& module, char* out_str, int size) {
-		copyString(Span(out_str, size), "g_module_");
-		catString(Span(out_str, size), module.getSystem().getName());
+		const JSScript::Schema& schema = inst.m_script->getSchema();
+		writeRow(inst, schema, m_values_scratch);
+		rowToTagged(toSpan(schema.properties), toSpan(m_values_scratch), blob);
 	}
 
 
-	void registerAPI() {
-		if (m_is_api_registered) return;
-		m_is_api_registered = true;
-
-		duk_context* ctx = m_system.m_global_context;
-		registerGlobalVariable(ctx, "World", "g_world", &m_world);
+	duk_context* getGlobalContext() override { return m_heap->ctx; }
+	duk_context* getScriptContext(EntityRef entity, i32 scr_index) override { return getContext(m_scripts[entity]->m_scripts[scr_index]); }
 
-		Array<UniquePtr<IModule>>& modules = m_world.getModules();
-		for (UniquePtr<IModule>& module : modules) {
-			StaticString<50> type_name(module->getSystem().getName(), "_module");
-			char inst_name[50];
-			getInstanceName(*module, inst_name, lengthOf(inst_name));
-			registerJSObject(ctx, "ModuleBase", type_name, &ptrJSConstructor);
-			registerGlobalVariable(ctx, type_name, inst_name, module.get());
+	static void skipTaggedValues(InputMemoryStream& blob) {
+		const u32 count = blob.read<u32>();
+		for (u32 i = 0; i < count; ++i) {
+			blob.skip(sizeof(StableHash));
+			skipTaggedValue(blob, (Property::Type)blob.read<u8>());
 		}
 	}
 
+	void readScriptData(ScriptInstance& inst, InputMemoryStream& blob) {
+		const u64 begin = blob.getPosition();
+		skipTaggedValues(blob);
+		const Span<const u8> data((const u8*)blob.getData() + begin, u32(blob.getPosition() - begin));
 
-	const char* getPropertyName(StableHash name_hash) const {
-		int idx = m_property_names.find(name_hash);
-		if (idx >= 0) return m_property_names.at(idx).c_str();
-		return nullptr;
-	}
-
-	void applyProperty(duk_context* ctx, ScriptInstance& script, Property& prop, InputMemoryStream value) {
-		const char* name = getPropertyName(prop.name_hash);
-		if (!name) return;
-
-		duk_push_global_stash(ctx);
-		duk_push_pointer(ctx, (void*)script.m_id);
-		duk_get_prop(ctx, -2);
-
-		if (prop.type == Property::ENTITY) {
-			duk_get_global_string(ctx, "Entity");
-			duk_push_pointer(ctx, &m_world);
-			EntityPtr e = value.read<EntityPtr>();
-			JSWrapper::push(ctx, e.index);
-			duk_new(ctx, 2);			
-		}
-		else if (prop.type == Property::BOOLEAN) {
-			bool b = value.read<bool>() != 0;
-			duk_push_boolean(ctx, b);
-		}
-		else if (prop.type == Property::NUMBER) {
-			duk_push_number(ctx, value.read<double>());
-		}
-		else if (prop.type == Property::STRING) {
-			duk_push_string(ctx, value.readString());
+		if (inst.m_values_resolved) {
+			applyTaggedValues(inst, data);
 		}
 		else {
-			ASSERT(false);
+			// resolved when the script is started
+			inst.m_row_layout = -1;
+			inst.m_values.clear();
+			inst.m_values.write(data.begin(), data.length());
 		}
-
-		duk_put_prop_string(ctx, -2, name);
-		duk_pop_2(ctx);
-	}
-
-	const char* getPropertyName(EntityRef entity, int scr_index, int index) const {
-		auto& script = m_scripts[entity]->m_scripts[scr_index];
-
-		return getPropertyName(script.m_properties[index].name_hash);
 	}
 
 
-	int getPropertyCount(EntityRef entity, int scr_index) const {
-		auto& script = m_scripts[entity]->m_scripts[scr_index];
-
-		return script.m_properties.size();
-	}
-
-	static int getScriptIndex(ScriptComponent& scr, ScriptInstance& inst) { return int(&inst - &scr.m_scripts[0]); }
+	// writes tagged values to slots and to the object of a started instance
+	void applyTaggedValues(ScriptInstance& inst, Span<const u8> data) {
+		const JSScript::Schema& schema = inst.m_script->getSchema();
+		duk_context* ctx = getContext(inst);
+		duk_push_global_stash(ctx);
+		duk_push_pointer(ctx, (void*)inst.m_id);
+		duk_get_prop(ctx, -2);
+		const bool has_object = duk_is_object(ctx, -1);
 
+		InputMemoryStream blob(data.begin(), data.length());
+		const u32 count = blob.read<u32>();
+		for (u32 i = 0; i < count; ++i) {
+			const StableHash name_hash = blob.read<StableHash>();
+			const Property::Type type = (Property::Type)blob.read<u8>();
+			const u8* value = (const u8*)blob.getData() + blob.getPosition();
+			skipTaggedValue(blob, type);
 
-	void clearInstance(ScriptComponent& scr, ScriptInstance& inst) {
-		int scr_idx = getScriptIndex(scr, inst);
-		auto* call = beginFunctionCall(scr.m_entity, scr_idx, "onDestroy");
-		if (call) endFunctionCall();
+			const i32 prop_idx = schema.find(name_hash);
+			if (prop_idx < 0 || schema.properties[prop_idx].type != type) continue;
 
-		for (int i = 0; i < m_updates.size(); ++i) {
-			if (m_updates[i].id == inst.m_id) {
-				m_updates.swapAndPop(i);
-				break;
-			}
-		}
+			const JSScript::Schema::Property& prop = schema.properties[prop_idx];
+			setSlotFromTagged(inst.m_values, type, prop.offset, value);
 
-		for (int i = 0; i < m_input_handlers.size(); ++i) {
-			if (m_input_handlers[i].id == inst.m_id) {
-				m_input_handlers.swapAndPop(i);
-				break;
+			if (has_object) {
+				pushSlotValue(ctx, type, inst.m_values, prop.offset);
+				duk_put_prop_string(ctx, -2, prop.name.c_str());
 			}
 		}
-
-		duk_context* ctx = m_system.m_global_context;
-		duk_push_global_stash(ctx);
-		duk_push_pointer(ctx, (void*)inst.m_id);
-		duk_del_prop(ctx, -2);
-		duk_pop(ctx);
-
-		inst.m_properties.clear();
+		duk_pop_2(ctx);
+		compactValues(inst.m_values, schema, m_values_scratch);
 	}
 
 
-	void setScriptPathInternal(ScriptComponent& cmp, ScriptInstance& inst, const Path& path) {
-		if (inst.m_script) {
-			clearInstance(cmp, inst);
-			auto& cb = inst.m_script->getObserverCb();
-			cb.unbind<&ScriptComponent::onScriptLoaded>(&cmp);
-			inst.m_script->decRefCount();
-		}
-		ResourceManagerHub& rm = m_system.m_engine.getResourceManager();
-		inst.m_script = path.isEmpty() ? nullptr : rm.load<JSScript>(path);
-		if (inst.m_script) {
-			inst.m_script->onLoaded<&ScriptComponent::onScriptLoaded>(&cmp);
-		}
-	}
+	void getMemoryReport(JSMemoryReport& report) override {
+		PROFILE_FUNCTION();
+		duk_context* ctx = m_heap->ctx;
+		JSWrapper::DebugGuard guard(ctx);
+		JSHeapWalker walker(ctx, m_system.m_allocator);
 
+		// shared API first, so it's not attributed to scripts which reference it
+		duk_push_global_object(ctx);
+		walker.walk(report.global);
+		duk_pop(ctx);
 
-	void detectProperties(ScriptInstance& inst, EntityRef entity) {
-		duk_context* ctx = m_system.m_global_context;
 		duk_push_global_stash(ctx);
-		duk_push_pointer(ctx, (void*)inst.m_id);
-		duk_get_prop(ctx, -2); //[stash, id] -> [stash, obj]
-
-		duk_enum(ctx, -1, 0);
-		u32 valid_properties[256];
-		memset(valid_properties, 0, (inst.m_properties.size() + 7) / 8);
-		while (duk_next(ctx, -1, 1))
-		{
-			// [... enum key value]
-			if (inst.m_properties.size() > sizeof(valid_properties) * 8) {
-				logError("Too many properties in ", inst.m_script->getPath(), ", entity ", entity.index, ". Some will be ignored.");
-				inst.m_properties.shrink(sizeof(valid_properties) * 8);
-			}
-
-			if (duk_is_function(ctx, -1)) {
+		if (duk_get_prop_string(ctx, -1, REQUIRE_CACHE)) {
+			duk_enum(ctx, -1, DUK_ENUM_OWN_PROPERTIES_ONLY);
+			while (duk_next(ctx, -1, 1)) {
+				JSMemoryItem& item = report.modules.emplace();
+				item.path = Path(duk_get_string(ctx, -2), ".js");
+				walker.walk(item);
 				duk_pop_2(ctx);
-				continue;
 			}
+			duk_pop(ctx);
+		}
+		duk_pop(ctx);
 
-			bool is_entity = false;
-			if (duk_is_object(ctx, -1)) {
-				// duk_instanceof throws, so we use c_entity to detect entities
-				is_entity = duk_get_prop_string(ctx, -1, "c_entity");
+		for (ScriptComponent* script_cmp : m_scripts) {
+			for (ScriptInstance& inst : script_cmp->m_scripts) {
+				// worker heaps are not walked
+				if (!inst.m_script || inst.m_worker >= 0) continue;
+
+				JSMemoryItem& item = report.instances.emplace();
+				item.path = inst.m_script->getPath();
+				item.entity = script_cmp->m_entity;
+				item.scr_index = getScriptIndex(*script_cmp, inst);
+				duk_push_pointer(ctx, (void*)inst.m_id);
+				duk_get_prop(ctx, -2);
+				walker.walk(item);
 				duk_pop(ctx);
-				if (!is_entity) {
-					duk_pop_2(ctx);
-					continue;
-				}
-			}
 
-			auto& allocator = m_system.m_allocator;
-			const char* prop_name = duk_get_string(ctx, -2);
-			const StableHash hash(prop_name);
-			if (m_property_names.find(hash) < 0)
-			{
-				m_property_names.emplace(hash, prop_name, allocator);
-			}
-			int prop_index = ScriptComponent::getProperty(inst, hash);
-			if (prop_index >= 0)
-			{
-				valid_properties[prop_index / 8] |= 1 << (prop_index % 8);
-				Property& existing_prop = inst.m_properties[prop_index];
-				InputMemoryStream blob(existing_prop.stored_value);
-				applyProperty(ctx, inst, existing_prop, blob);
-			}
-			else
-			{
-				prop_index = inst.m_properties.size();
-				if (prop_index < sizeof(valid_properties) * 8) {
-					valid_properties[prop_index / 8] |= 1 << (prop_index % 8);
-					auto& prop = inst.m_properties.emplace(allocator);
-					switch (duk_get_type(ctx, -1)) {
-						case DUK_TYPE_BOOLEAN: prop.type = Property::BOOLEAN; break;
-						case DUK_TYPE_STRING: prop.type = Property::STRING; break;
-						case DUK_TYPE_NUMBER: prop.type = Property::NUMBER; break;
-						default: prop.type = is_entity ? Property::ENTITY : Property::NUMBER; break;
+				JSMemoryItem* script_item = nullptr;
+				for (JSMemoryItem& i : report.scripts) {
+					if (i.path == item.path) {
+						script_item = &i;
+						break;
 					}
-					prop.name_hash = hash;
 				}
-				else {
-					logError("Too many properties in ", inst.m_script->getPath(), ", entity ", entity.index
-						, ". Some will be ignored.");
+				if (!script_item) {
+					script_item = &report.scripts.emplace();
+					script_item->path = item.path;
 				}
+				script_item->bytes += item.bytes;
+				script_item->objects += item.objects;
 			}
-			duk_pop_2(ctx);
 		}
-		duk_pop_3(ctx); // [stash obj enum] -> []
+		duk_pop(ctx);
 
-		for (i32 i = inst.m_properties.size() - 1; i >= 0; --i) {
-			if (valid_properties[i / 8] & (1 << (i % 8))) continue;
-			inst.m_properties.swapAndPop(i);
+		report.heap_live_bytes = m_heap->allocator.getStats().live_bytes;
+
+		profiler::pushInt("JS global (KB)", i32(report.global.bytes / 1024));
+		for (const JSMemoryItem& item : report.scripts) {
+			profiler::pushString(StaticString<512>(item.path.c_str(), ": ", u32(item.bytes / 1024), " KB"));
+		}
+		for (const JSMemoryItem& item : report.modules) {
+			profiler::pushString(StaticString<512>(item.path.c_str(), ": ", u32(item.bytes / 1024), " KB"));
 		}
 	}
 
-	void onScriptLoaded(EntityRef entity, ScriptInstance& instance, bool is_restart) {
-		startScript(entity, instance, is_restart);
-	}
 
-	void startScript(EntityRef entity, ScriptInstance& instance, bool is_restart) {
-		duk_context* ctx = m_system.m_global_context;
+	void setDeferredWrites(bool enable) override { m_deferred_writes = enable; }
+	bool areWritesDeferred() const override { return m_deferred_writes; }
+
+	void captureHeapSnapshot(JSHeapSnapshot& snapshot) override {
+		PROFILE_FUNCTION();
+		duk_context* ctx = m_heap->ctx;
 		JSWrapper::DebugGuard guard(ctx);
+		snapshot.clear();
+
+		duk_push_global_object(ctx);
+		snapshot.addRoot(ctx, "global");
+		duk_pop(ctx);
+
+		duk_push_global_stash(ctx);
+		if (duk_get_prop_string(ctx, -1, REQUIRE_CACHE)) {
+			duk_enum(ctx, -1, DUK_ENUM_OWN_PROPERTIES_ONLY);
+			while (duk_next(ctx, -1, 1)) {
+				snapshot.addRoot(ctx, StaticString<512>("require(\"", duk_get_string(ctx, -2), "\")"));
+				duk_pop_2(ctx);
+			}
+			duk_pop(ctx);
+		}
+		duk_pop(ctx);
+
+		for (ScriptComponent* script_cmp : m_scripts) {
+			for (ScriptInstance& inst : script_cmp->m_scripts) {
+				// worker heaps are not walked
+				if (!inst.m_script || inst.m_worker >= 0) continue;
+
+				const i32 scr_index = getScriptIndex(*script_cmp, inst);
+				duk_push_pointer(ctx, (void*)inst.m_id);
+				duk_get_prop(ctx, -2);
+				snapshot.addRoot(ctx, StaticString<512>("entity ", script_cmp->m_entity.index, "[", scr_index, "] ", inst.m_script->getPath().c_str()));
+				duk_pop(ctx);
+			}
+		}
+		snapshot.addRoot(ctx, "stash");
+		duk_pop(ctx);
+
+		snapshot.capture(ctx);
+	}
+
+
+	World& getWorld() override { return m_world; }
+
+
+	void getInstanceName(IModule& module, char* out_str, int size) {
+		copyString(Span(out_str, size), "g_module_");
+		catString(Span(out_str, size), module.getSystem().getName());
+	}
+
+
+	void registerAPI() {
+		if (m_is_api_registered) return;
+		m_is_api_registered = true;
+
+		duk_context* ctx = m_heap->ctx;
+		registerGlobalVariable(ctx, "World", "g_world", &m_world);
+
+		Array<UniquePtr<IModule>>& modules = m_world.getModules();
+		for (UniquePtr<IModule>& module : modules) {
+			StaticString<50> type_name(module->getSystem().getName(), "_module");
+			char inst_name[50];
+			getInstanceName(*module, inst_name, lengthOf(inst_name));
+			registerJSObject(ctx, "ModuleBase", type_name, &ptrJSConstructor);
+			registerGlobalVariable(ctx, type_name, inst_name, module.get());
+		}
+	}
+
+
+	void pushSlotValue(duk_context* ctx, Property::Type type, const OutputMemoryStream& values, u32 offset) {
+		const u8* slot = values.data() + offset;
+		switch (type) {
+			case Property::BOOLEAN: duk_push_boolean(ctx, *slot != 0); break;
+			case Property::NUMBER: {
+				double v;
+				memcpy(&v, slot, sizeof(v));
+				duk_push_number(ctx, v);
+				break;
+			}
+			case Property::ENTITY: {
+				EntityPtr e;
+				memcpy(&e, slot, sizeof(e));
+				JSWrapper::pushEntity(ctx, e, &m_world);
+				break;
+			}
+			case Property::VEC2:
+			case Property::VEC3:
+			case Property::VEC4:
+			case Property::COLOR:
+			case Property::QUAT: {
+				float v[4];
+				const u32 count = getVectorSize(type);
+				memcpy(v, slot, count * sizeof(float));
+				duk_push_array(ctx);
+				for (u32 i = 0; i < count; ++i) {
+					duk_push_number(ctx, v[i]);
+					duk_put_prop_index(ctx, -2, i);
+				}
+				break;
+			}
+			case Property::STRING:
+			case Property::RESOURCE: {
+				ArenaSlot str;
+				memcpy(&str, slot, sizeof(str));
+				duk_push_lstring(ctx, (const char*)values.data() + str.offset, str.size);
+				break;
+			}
+			case Property::F32_ARRAY:
+			case Property::F64_ARRAY:
+			case Property::I32_ARRAY: {
+				ArenaSlot arr;
+				memcpy(&arr, slot, sizeof(arr));
+				void* data = duk_push_fixed_buffer(ctx, arr.size);
+				memcpy(data, values.data() + arr.offset, arr.size);
+				duk_push_buffer_object(ctx, -1, 0, arr.size, getBufferObjectType(type));
+				duk_remove(ctx, -2);
+				break;
+			}
+		}
+	}
+
+	// overwrites slot's data in place if it fits, otherwise appends it to the arena; zero offset means the slot has no data yet
+	static void setSlotData(OutputMemoryStream& values, u32 offset, const void* data, u32 size) {
+		ArenaSlot slot;
+		memcpy(&slot, values.data() + offset, sizeof(slot));
+		if (slot.offset != 0 && size <= slot.size) {
+			memmove(values.getMutableData() + slot.offset, data, size);
+			values.getMutableData()[slot.offset + size] = '\0';
+		}
+		else {
+			slot.offset = (u32)values.size();
+			values.write(data, size);
+			values.write('\0');
+		}
+		slot.size = size;
+		memcpy(values.getMutableData() + offset, &slot, sizeof(slot));
+	}
+
+	// drops data of overwritten slots once they take more than live data
+	static void compactValues(OutputMemoryStream& values, const JSScript::Schema& schema, OutputMemoryStream& tmp) {
+		u64 live_size = schema.values_size;
+		for (const JSScript::Schema::Property& prop : schema.properties) {
+			if (!isStringType(prop.type) && !isArrayType(prop.type)) continue;
+			ArenaSlot slot;
+			memcpy(&slot, values.data() + prop.offset, sizeof(slot));
+			live_size += slot.size + 1;
+		}
+		if (values.size() <= live_size * 2) return;
+
+		tmp.clear();
+		tmp.resize(schema.values_size);
+		if (schema.values_size > 0) memcpy(tmp.getMutableData(), values.data(), schema.values_size);
+		const ArenaSlot empty = {};
+		for (const JSScript::Schema::Property& prop : schema.properties) {
+			if (!isStringType(prop.type) && !isArrayType(prop.type)) continue;
+			ArenaSlot slot;
+			memcpy(&slot, values.data() + prop.offset, sizeof(slot));
+			memcpy(tmp.getMutableData() + prop.offset, &empty, sizeof(empty));
+			setSlotData(tmp, prop.offset, values.data() + slot.offset, slot.size);
+		}
+		values.clear();
+		values.write(tmp.data(), tmp.size());
+	}
+
+	static void setSlotFromTagged(OutputMemoryStream& values, Property::Type type, u32 offset, const u8* tagged) {
+		if (isStringType(type)) {
+			setSlotData(values, offset, tagged, stringLength((const char*)tagged));
+		}
+		else if (isArrayType(type)) {
+			u32 size;
+			memcpy(&size, tagged, sizeof(size));
+			setSlotData(values, offset, tagged + sizeof(size), size);
+		}
+		else {
+			memcpy(values.getMutableData() + offset, tagged, getValueSlotSize(type));
+		}
+	}
+
+	// reads property from the object on the top of the stack to its slot, slot is left untouched if the value has different type
+	static bool storeSlotValue(duk_context* ctx, const JSScript::Schema::Property& prop, OutputMemoryStream& values) {
+		duk_get_prop_string(ctx, -1, prop.name.c_str());
+		bool stored = true;
+		switch (prop.type) {
+			case Property::BOOLEAN:
+				stored = duk_is_boolean(ctx, -1);
+				if (stored) values.getMutableData()[prop.offset] = duk_get_boolean(ctx, -1) ? 1 : 0;
+				break;
+			case Property::NUMBER: {
+				stored = duk_is_number(ctx, -1);
+				const double v = duk_get_number(ctx, -1);
+				if (stored) memcpy(values.getMutableData() + prop.offset, &v, sizeof(v));
+				break;
+			}
+			case Property::ENTITY: {
+				EntityPtr e = INVALID_ENTITY;
+				if (duk_is_object(ctx, -1)) {
+					if (duk_get_prop_string(ctx, -1, "c_entity")) e.index = duk_get_int(ctx, -1);
+					duk_pop(ctx);
+				}
+				else {
+					stored = duk_is_null_or_undefined(ctx, -1);
+				}
+				if (stored) memcpy(values.getMutableData() + prop.offset, &e, sizeof(e));
+				break;
+			}
+			case Property::VEC2:
+			case Property::VEC3:
+			case Property::VEC4:
+			case Property::COLOR:
+			case Property::QUAT: {
+				float v[4];
+				const u32 count = getVectorSize(prop.type);
+				stored = JSWrapper::getVector(ctx, -1, count, v);
+				if (stored) memcpy(values.getMutableData() + prop.offset, v, count * sizeof(float));
+				break;
+			}
+			case Property::RESOURCE:
+				// value returned by Lumix.resource
+				if (duk_is_object(ctx, -1)) {
+					duk_get_prop_string(ctx, -1, "path");
+					duk_remove(ctx, -2);
+				}
+				// fallthrough
+			case Property::STRING: {
+				stored = duk_is_string(ctx, -1);
+				duk_size_t len = 0;
+				const char* str = duk_get_lstring(ctx, -1, &len);
+				if (stored) setSlotData(values, prop.offset, str, (u32)len);
+				break;
+			}
+			case Property::F32_ARRAY:
+			case Property::F64_ARRAY:
+			case Property::I32_ARRAY: {
+				stored = isTypedArray(ctx, -1, prop.type);
+				duk_size_t size = 0;
+				const void* data = stored ? duk_get_buffer_data(ctx, -1, &size) : nullptr;
+				if (stored) setSlotData(values, prop.offset, data, (u32)size);
+				break;
+			}
+		}
+		duk_pop(ctx);
+		return stored;
+	}
+
+	// packs values of a resolved instance to `row`, in the same layout as they are in memory, with only live strings in the arena
+	void writeRow(const ScriptInstance& inst, const JSScript::Schema& schema, OutputMemoryStream& row) {
+		row.clear();
+		row.resize(schema.values_size);
+		if (schema.values_size > 0) memcpy(row.getMutableData(), inst.m_values.data(), schema.values_size);
+		// slots still point to the instance's arena, data is appended to the row's arena below
+		const ArenaSlot empty = {};
+		for (const JSScript::Schema::Property& prop : schema.properties) {
+			if (isStringType(prop.type) || isArrayType(prop.type)) memcpy(row.getMutableData() + prop.offset, &empty, sizeof(empty));
+		}
+
+		duk_context* ctx = getContext(inst);
+		duk_push_global_stash(ctx);
+		duk_push_pointer(ctx, (void*)inst.m_id);
+		duk_get_prop(ctx, -2);
+		const bool has_object = duk_is_object(ctx, -1);
+		for (const JSScript::Schema::Property& prop : schema.properties) {
+			if (has_object && storeSlotValue(ctx, prop, row)) continue;
+			if (!isStringType(prop.type) && !isArrayType(prop.type)) continue;
+
+			ArenaSlot slot;
+			memcpy(&slot, inst.m_values.data() + prop.offset, sizeof(slot));
+			setSlotData(row, prop.offset, inst.m_values.data() + slot.offset, slot.size);
+		}
+		duk_pop_2(ctx);
+	}
+
+	static void parseTaggedValues(const OutputMemoryStream& values, Array<TaggedValue>& out) {
+		if (values.empty()) return;
+
+		InputMemoryStream blob(values);
+		const u32 count = blob.read<u32>();
+		out.reserve(count);
+		for (u32 i = 0; i < count; ++i) {
+			TaggedValue& v = out.emplace();
+			blob.read(v.name_hash);
+			v.type = (Property::Type)blob.read<u8>();
+			v.offset = (u32)blob.getPosition();
+			skipTaggedValue(blob, v.type);
+		}
+	}
+
+	// converts a packed row to tagged records, which do not depend on the schema
+	template <typename P>
+	static void rowToTagged(Span<const P> schema, Span<const u8> row, OutputMemoryStream& tagged) {
+		tagged.write(schema.length());
+		for (const P& prop : schema) {
+			tagged.write(prop.name_hash);
+			tagged.write((u8)prop.type);
+			writeTaggedValue(tagged, prop.type, row.begin(), prop.offset);
+		}
+	}
+
+	template <typename T> static Span<const T> toSpan(const Array<T>& array) { return Span<const T>(array.begin(), array.size()); }
+	static Span<const u8> toSpan(const OutputMemoryStream& stream) { return Span<const u8>(stream.data(), (u32)stream.size()); }
+
+	// layouts are shared by instances of the same script and kept until the module is destroyed, there are only few of them
+	i32 addRowLayout(Span<const JSScriptModule::Property> props) {
+		for (i32 i = 0, c = m_row_layouts.size(); i < c; ++i) {
+			if (layoutEquals(getRowLayout(i), props)) return i;
+		}
+		m_row_layouts.push({(u32)m_row_layout_props.size(), props.length()});
+		for (const JSScriptModule::Property& prop : props) m_row_layout_props.push(prop);
+		return m_row_layouts.size() - 1;
+	}
+
+	Span<const JSScriptModule::Property> getRowLayout(i32 idx) const {
+		const RowLayout& layout = m_row_layouts[idx];
+		return Span<const JSScriptModule::Property>(m_row_layout_props.begin() + layout.first_prop, layout.num_props);
+	}
+
+	template <typename P>
+	static bool layoutEquals(Span<const JSScriptModule::Property> layout, Span<const P> schema) {
+		if (layout.length() != schema.length()) return false;
+		for (u32 i = 0; i < layout.length(); ++i) {
+			if (layout[i].name_hash != schema[i].name_hash || layout[i].type != schema[i].type) return false;
+		}
+		return true;
+	}
+
+	// converts a row loaded before the schema was detected to tagged records
+	void tagPendingRow(ScriptInstance& inst) {
+		if (inst.m_row_layout < 0) return;
+		OutputMemoryStream& tagged = m_values_scratch;
+		tagged.clear();
+		rowToTagged(getRowLayout(inst.m_row_layout), toSpan(inst.m_values), tagged);
+		inst.m_values.clear();
+		inst.m_values.write(tagged.data(), tagged.size());
+		inst.m_row_layout = -1;
+	}
+
+	// converts resolved values to tagged records, which do not depend on the schema
+	void unresolveValues(ScriptInstance& inst) {
+		if (!inst.m_values_resolved) return;
+
+		// keep values changed since the instance was started
+		const JSScript::Schema& schema = inst.m_script->getSchema();
+		writeRow(inst, schema, m_values_scratch);
+		inst.m_values.clear();
+		rowToTagged(toSpan(schema.properties), toSpan(m_values_scratch), inst.m_values);
+		inst.m_values_resolved = false;
+	}
+
+	// lays out tagged values by the schema, expects the script object on the top of the stack
+	void resolveValues(duk_context* ctx, ScriptInstance& inst, const JSScript::Schema& schema) {
+		m_tagged_values.clear();
+		parseTaggedValues(inst.m_values, m_tagged_values);
+
+		OutputMemoryStream& values = m_values_scratch;
+		values.clear();
+		values.resize(schema.values_size);
+		if (schema.values_size > 0) memset(values.getMutableData(), 0, schema.values_size);
+
+		for (i32 i = 0, c = schema.properties.size(); i < c; ++i) {
+			const JSScript::Schema::Property& prop = schema.properties[i];
+			
+			// tagged values are usually already in schema order
+			i32 tagged_idx = -1;
+			if (i < m_tagged_values.size() && m_tagged_values[i].name_hash == prop.name_hash) {
+				tagged_idx = i;
+			}
+			else {
+				for (i32 j = 0, cj = m_tagged_values.size(); j < cj; ++j) {
+					if (m_tagged_values[j].name_hash == prop.name_hash) {
+						tagged_idx = j;
+						break;
+					}
+				}
+			}
+
+			// stored value has different type if the script changed, in that case the value from script is used
+			if (tagged_idx < 0 || m_tagged_values[tagged_idx].type != prop.type) {
+				const bool stored = storeSlotValue(ctx, prop, values);
+				// object returned by Lumix.resource is replaced with plain path
+				if (!stored || prop.type != Property::RESOURCE) continue;
+			}
+			else {
+				setSlotFromTagged(values, prop.type, prop.offset, inst.m_values.data() + m_tagged_values[tagged_idx].offset);
+			}
+			pushSlotValue(ctx, prop.type, values, prop.offset);
+			duk_put_prop_string(ctx, -2, prop.name.c_str());
+		}
+
+		inst.m_values.clear();
+		inst.m_values.write(values.data(), values.size());
+		inst.m_values_resolved = true;
+	}
+
+	static int getScriptIndex(ScriptComponent& scr, ScriptInstance& inst) { return int(&inst - &scr.m_scripts[0]); }
+
+	static void removeContextRef(Array<ContextRef>& refs, uintptr id) {
+		for (int i = 0; i < refs.size(); ++i) {
+			if (refs[i].id == id) {
+				refs.swapAndPop(i);
+				break;
+			}
+		}
+	}
+
+	duk_context* getContext(const ScriptInstance& inst) const {
+		return inst.m_worker < 0 ? m_heap->ctx : m_workers[inst.m_worker].heap->ctx;
+	}
+
+	JSHeap& getInstanceHeap(const ScriptInstance& inst) const {
+		return inst.m_worker < 0 ? *m_heap : *m_workers[inst.m_worker].heap;
+	}
+
+	Array<ContextRef>& getUpdates(const ScriptInstance& inst) {
+		return inst.m_worker < 0 ? m_updates : m_workers[inst.m_worker].updates;
+	}
+
+	// parallel instances are distributed round robin
+	i32 pickWorker() {
+		if (m_workers.empty()) {
+			const u32 count = clamp((u32)jobs::getWorkersCount(), 1u, MAX_WORKER_HEAPS);
+			m_workers.reserve(count);
+			for (u32 i = 0; i < count; ++i) {
+				Worker& worker = m_workers.emplace(m_system.m_allocator);
+				worker.heap = m_system.createWorkerHeap();
+			}
+		}
+		const i32 idx = i32(m_next_worker % m_workers.size());
+		++m_next_worker;
+		return idx;
+	}
+
+
+	void clearInstance(ScriptComponent& scr, ScriptInstance& inst) {
+		int scr_idx = getScriptIndex(scr, inst);
+		auto* call = beginFunctionCall(scr.m_entity, scr_idx, "onDestroy");
+		if (call) endFunctionCall();
+
+		removeContextRef(getUpdates(inst), inst.m_id);
+		removeContextRef(m_input_handlers, inst.m_id);
+		removeTimers(inst.m_id);
+		removeTweens(inst.m_id);
+		stopCoroutines(inst.m_id);
+		unsubscribeEvents(inst.m_id);
+		inst.m_physics_hooks = 0;
+
+		duk_context* ctx = getContext(inst);
+		duk_push_global_stash(ctx);
+		duk_push_pointer(ctx, (void*)inst.m_id);
+		duk_del_prop(ctx, -2);
+		duk_pop(ctx);
+
+		inst.m_values.clear();
+		inst.m_values_resolved = false;
+		inst.m_row_layout = -1;
+	}
+
+
+	void setScriptPathInternal(ScriptComponent& cmp, ScriptInstance& inst, const Path& path) {
+		if (inst.m_script) {
+			clearInstance(cmp, inst);
+			auto& cb = inst.m_script->getObserverCb();
+			cb.unbind<&ScriptComponent::onScriptLoaded>(&cmp);
+			inst.m_script->decRefCount();
+		}
+		ResourceManagerHub& rm = m_system.m_engine.getResourceManager();
+		inst.m_script = path.isEmpty() ? nullptr : rm.load<JSScript>(path);
+		if (inst.m_script) {
+			inst.m_script->onLoaded<&ScriptComponent::onScriptLoaded>(&cmp);
+		}
+	}
+
+
+	// detects type of the value on the top of the stack, returns false if the value can not be a property
+	static bool detectPropertyType(duk_context* ctx, Property::Type& type, ResourceType& resource_type) {
+		switch (duk_get_type(ctx, -1)) {
+			case DUK_TYPE_BOOLEAN: type = Property::BOOLEAN; return true;
+			case DUK_TYPE_STRING: type = Property::STRING; return true;
+			case DUK_TYPE_NUMBER: type = Property::NUMBER; return true;
+			case DUK_TYPE_OBJECT: break;
+			default: type = Property::NUMBER; return true;
+		}
+
+		// duk_instanceof throws, so we use c_entity to detect entities
+		if (duk_get_prop_string(ctx, -1, "c_entity")) {
+			duk_pop(ctx);
+			type = Property::ENTITY;
+			return true;
+		}
+		duk_pop(ctx);
+
+		// values returned by Lumix.color, Lumix.quat and Lumix.resource
+		if (duk_get_prop_string(ctx, -1, "c_property_type")) {
+			type = (Property::Type)duk_get_int(ctx, -1);
+			duk_pop(ctx);
+			if (type == Property::RESOURCE) {
+				duk_get_prop_string(ctx, -1, "c_resource_type");
+				resource_type = ResourceType(duk_get_string_default(ctx, -1, ""));
+				duk_pop(ctx);
+			}
+			return true;
+		}
+		duk_pop(ctx);
+
+		static const Property::Type array_types[] = { Property::F32_ARRAY, Property::F64_ARRAY, Property::I32_ARRAY };
+		for (Property::Type array_type : array_types) {
+			if (isTypedArray(ctx, -1, array_type)) {
+				type = array_type;
+				return true;
+			}
+		}
+
+		// plain arrays can be anything, e.g. a path or a list of weights, vectors are marked by Lumix.vec2, vec3 and vec4
+		return false;
+	}
+
+	// expects the script object on the top of the stack
+	void detectSchema(duk_context* ctx, JSScript::Schema& schema) {
+		schema.clear();
+		IAllocator& allocator = m_system.m_allocator;
+
+		duk_enum(ctx, -1, 0);
+		while (duk_next(ctx, -1, 1)) {
+			// [... enum key value]
+			if (duk_is_function(ctx, -1)) {
+				const char* name = duk_get_string(ctx, -2);
+				schema.methods.insert(RuntimeHash(name), schema.method_names.size());
+				schema.method_names.emplace(name, allocator);
+				duk_pop_2(ctx);
+				continue;
+			}
+
+			Property::Type type;
+			ResourceType resource_type;
+			if (!detectPropertyType(ctx, type, resource_type)) {
+				duk_pop_2(ctx);
+				continue;
+			}
+
+			const char* prop_name = duk_get_string(ctx, -2);
+			JSScript::Schema::Property& prop = schema.properties.emplace(prop_name, allocator);
+			prop.name_hash = StableHash(prop_name);
+			prop.type = type;
+			prop.resource_type = resource_type;
+			prop.offset = schema.values_size;
+			schema.values_size += getValueSlotSize(prop.type);
+			duk_pop_2(ctx);
+		}
+		duk_pop(ctx); // enum
+		schema.is_detected = true;
+	}
+
+	// schema is detected only for the first instance of a script, other instances just apply their stored values
+	void detectProperties(ScriptInstance& inst, EntityRef entity) {
+		duk_context* ctx = getContext(inst);
+		duk_push_global_stash(ctx);
+		duk_push_pointer(ctx, (void*)inst.m_id);
+		duk_get_prop(ctx, -2); //[stash, id] -> [stash, obj]
+
+		JSScript::Schema& schema = inst.m_script->getSchema();
+		if (!schema.is_detected) detectSchema(ctx, schema);
+		if (inst.m_row_layout >= 0) {
+			if (layoutEquals(getRowLayout(inst.m_row_layout), toSpan(schema.properties))) {
+				inst.m_row_layout = -1;
+				inst.m_values_resolved = true;
+			}
+			else {
+				tagPendingRow(inst);
+			}
+		}
+
+		if (inst.m_values_resolved) {
+			for (const JSScript::Schema::Property& prop : schema.properties) {
+				pushSlotValue(ctx, prop.type, inst.m_values, prop.offset);
+				duk_put_prop_string(ctx, -2, prop.name.c_str());
+			}
+		}
+		else {
+			resolveValues(ctx, inst, schema);
+		}
+
+		duk_pop_2(ctx); // [stash obj] -> []
+	}
+
+	void onScriptLoaded(EntityRef entity, ScriptInstance& instance, bool is_restart) {
+		startScript(entity, instance, is_restart);
+	}
+
+	void startScript(EntityRef entity, ScriptInstance& instance, bool is_restart) {
+		// reloaded script is started again, possibly in another heap
+		removeContextRef(getUpdates(instance), instance.m_id);
+		removeContextRef(m_input_handlers, instance.m_id);
+		instance.m_physics_hooks = 0;
+		i32 worker = -1;
+		if (instance.m_script->isParallel()) worker = instance.m_worker >= 0 ? instance.m_worker : pickWorker();
+		if (worker != instance.m_worker) {
+			removeTimers(instance.m_id);
+			removeTweens(instance.m_id);
+			stopCoroutines(instance.m_id);
+			unsubscribeEvents(instance.m_id);
+			duk_context* prev_ctx = getContext(instance);
+			duk_push_global_stash(prev_ctx);
+			duk_push_pointer(prev_ctx, (void*)instance.m_id);
+			duk_del_prop(prev_ctx, -2);
+			duk_pop(prev_ctx);
+			instance.m_worker = worker;
+		}
+
+		duk_context* ctx = getContext(instance);
+		JSWrapper::DebugGuard guard(ctx);
+		InstanceScope scope(getInstanceHeap(instance), this, instance.m_id);
 
 		duk_push_global_stash(ctx);
 		duk_push_pointer(ctx, (void*)instance.m_id);
@@ -863,7 +1996,7 @@ public:
 
 		duk_get_prop_string(ctx, -1, "update");
 		if (duk_is_callable(ctx, -1)) {
-			ContextRef& update = m_updates.emplace();
+			ContextRef& update = getUpdates(instance).emplace();
 			update.context = ctx;
 			update.id = instance.m_id;
 		}
@@ -877,6 +2010,10 @@ public:
 		}
 		duk_pop(ctx);
 
+		if (isMethod(ctx, "onContact")) instance.m_physics_hooks |= PhysicsHook::CONTACT;
+		if (isMethod(ctx, "onTriggerEnter")) instance.m_physics_hooks |= PhysicsHook::TRIGGER_ENTER;
+		if (isMethod(ctx, "onTriggerExit")) instance.m_physics_hooks |= PhysicsHook::TRIGGER_EXIT;
+
 		detectProperties(instance, entity);
 
 		if (!m_scripts_init_called) {
@@ -899,7 +2036,24 @@ public:
 	}
 
 
-	void startGame() override { m_is_game_running = true; }
+	// object is on top of the stack
+	static bool isMethod(duk_context* ctx, const char* name) {
+		duk_get_prop_string(ctx, -1, name);
+		const bool res = duk_is_callable(ctx, -1);
+		duk_pop(ctx);
+		return res;
+	}
+
+
+	void startGame() override {
+		m_is_game_running = true;
+		// contacts are reported during the physics module's update, scripts get them in lateUpdate
+		m_physics_module = static_cast<PhysicsModule*>(m_world.getModule("physics"));
+		if (m_physics_module) {
+			m_physics_module->onContact().bind<&JSScriptModuleImpl::onContact>(this);
+			m_physics_module->onTrigger().bind<&JSScriptModuleImpl::onTrigger>(this);
+		}
+	}
 
 
 	void stopGame() override {
@@ -907,6 +2061,47 @@ public:
 		m_is_game_running = false;
 		m_updates.clear();
 		m_input_handlers.clear();
+		if (m_physics_module) {
+			m_physics_module->onContact().unbind<&JSScriptModuleImpl::onContact>(this);
+			m_physics_module->onTrigger().unbind<&JSScriptModuleImpl::onTrigger>(this);
+			m_physics_module = nullptr;
+		}
+		m_contacts.clear();
+		m_triggers.clear();
+		for (const Timer& timer : m_timers) {
+			if (!timer.is_coroutine) clearTimer(m_heap->ctx, timer.id);
+		}
+		m_timers.clear();
+		m_time_ms = 0;
+		stopAllCoroutines();
+		for (EventSubscription& sub : m_event_subscriptions) unsubscribeEvent(m_heap->ctx, sub.id);
+		m_event_subscriptions.clear();
+		m_events.clear();
+		clearMessages();
+		clearTweens();
+		for (i32 i = m_system_scripts.size() - 1; i >= 0; --i) {
+			if (i < m_system_scripts.size() && !m_system_scripts[i].removed) removeSystemAt(i);
+		}
+		m_system.m_compute_jobs.cancel(this);
+		// buffers are applied in the same update they are recorded, this only drops what an aborted update left
+		m_commands.clear();
+		for (Worker& worker : m_workers) {
+			worker.updates.clear();
+			worker.commands.clear();
+			worker.log.clear();
+			m_system.collectGarbage(*worker.heap, true);
+		}
+
+		// required modules are evaluated again in the next session, so changes in them are picked up
+		// the shared heap's cache is used by other worlds too, so it's kept
+		if (m_own_heap) {
+			duk_context* ctx = m_heap->ctx;
+			duk_push_global_stash(ctx);
+			duk_del_prop_string(ctx, -1, REQUIRE_CACHE);
+			duk_pop(ctx);
+		}
+
+		m_system.collectGarbage(*m_heap, true);
 	}
 
 
@@ -933,60 +2128,170 @@ public:
 	}
 
 	void serialize(OutputMemoryStream& serializer) override {
-		serializer.write(m_scripts.size());
-		for (auto iter = m_scripts.begin(), end = m_scripts.end(); iter != end; ++iter) {
-			ScriptComponent* script_cmp = iter.value();
-			serializer.write(script_cmp->m_entity);
-			serializer.write(script_cmp->m_scripts.size());
-			for (auto& scr : script_cmp->m_scripts) {
-				serializer.writeString(scr.m_script ? scr.m_script->getPath().c_str() : "");
-				serializer.write(scr.m_id);
-				serializer.write(scr.m_properties.size());
-				for (Property& prop : scr.m_properties) {
-					serializer.write(prop.name_hash);
-					i32 idx = m_property_names.find(prop.name_hash);
-					serializer.write(prop.type);
-					if (idx >= 0) {
-						const char* name = m_property_names.at(idx).c_str();
-						switch (prop.type) {
-							case Property::BOOLEAN: {
-								bool v = getProperty<bool>(prop, name, scr);
-								serializer.write(v);
-								break;
-							}
-							case Property::NUMBER: {
-								double v = getProperty<double>(prop, name, scr);
-								serializer.write(v);
-								break;
-							}
-							case Property::ENTITY: {
-								EntityPtr v = getProperty<EntityPtr>(prop, name, scr);
-								serializer.write(v);
-								break;
-							}
-							case Property::STRING:
-								ASSERT(false);
-								// TODO
-								break;
-						}
-					} else {
-						ASSERT(false);
-						serializer.writeString("");
-					}
+		// each script is written once with its schema, instances reference it by index and write just packed values
+		Array<JSScript*> scripts(m_system.m_allocator);
+		for (ScriptComponent* script_cmp : m_scripts) {
+			for (ScriptInstance& scr : script_cmp->m_scripts) {
+				if (scr.m_script && scripts.indexOf(scr.m_script) < 0) scripts.push(scr.m_script);
+			}
+		}
+
+		serializer.write(scripts.size());
+		for (JSScript* script : scripts) {
+			serializer.writeString(script->getPath().c_str());
+			const JSScript::Schema& schema = script->getSchema();
+			const u32 num_props = schema.is_detected ? schema.properties.size() : 0;
+			serializer.write(num_props);
+			for (u32 i = 0; i < num_props; ++i) {
+				serializer.write(schema.properties[i].name_hash);
+				serializer.write((u8)schema.properties[i].type);
+			}
+		}
+
+		OutputMemoryStream& row = m_values_scratch;
+		serializer.write(m_scripts.size());
+		for (ScriptComponent* script_cmp : m_scripts) {
+			serializer.write(script_cmp->m_entity);
+			serializer.write(script_cmp->m_scripts.size());
+			for (ScriptInstance& scr : script_cmp->m_scripts) {
+				serializer.write(scr.m_script ? scripts.indexOf(scr.m_script) : -1);
+				if (scr.m_values_resolved && !scr.m_script->getSchema().is_detected) unresolveValues(scr);
+				tagPendingRow(scr);
+				serializer.write(scr.m_values_resolved);
+				if (!scr.m_values_resolved) {
+					serializer.write((u32)scr.m_values.size());
+					serializer.write(scr.m_values.data(), scr.m_values.size());
+					continue;
 				}
+
+				writeRow(scr, scr.m_script->getSchema(), row);
+				serializer.write((u32)row.size());
+				serializer.write(row.data(), row.size());
 			}
 		}
+
+		serializeComponentStores(serializer);
+	}
+
+
+	static void remapEntitySlot(u8* slot, const EntityMap& entity_map) {
+		EntityPtr e;
+		memcpy(&e, slot, sizeof(e));
+		e = entity_map.get(e);
+		memcpy(slot, &e, sizeof(e));
+	}
+
+
+	void remapTaggedEntities(OutputMemoryStream& values, const EntityMap& entity_map) {
+		m_tagged_values.clear();
+		parseTaggedValues(values, m_tagged_values);
+		for (const TaggedValue& v : m_tagged_values) {
+			if (v.type == Property::ENTITY) remapEntitySlot(values.getMutableData() + v.offset, entity_map);
+		}
 	}
 
 
 	void deserialize(InputMemoryStream& serializer, const EntityMap& entity_map, i32 version) override {
+		if (version <= (i32)JSScriptModuleVersion::SCHEMA_ROWS) {
+			deserializeLegacy(serializer, entity_map);
+			return;
+		}
+
+		struct SerializedScript {
+			JSScript* script;
+			u32 first_prop;
+			u32 num_props;
+			// rows can be used as they are if the schema in file is the same as the one detected in the loaded script
+			bool matches_schema;
+			// index in m_row_layouts, if the schema is not detected yet
+			i32 row_layout;
+		};
+
+		IAllocator& allocator = m_system.m_allocator;
+		ResourceManagerHub& rm = m_system.m_engine.getResourceManager();
+		Array<SerializedScript> scripts(allocator);
+		Array<JSScriptModule::Property> props(allocator);
+		const i32 num_scripts = serializer.read<i32>();
+		scripts.reserve(num_scripts);
+		for (i32 i = 0; i < num_scripts; ++i) {
+			SerializedScript& s = scripts.emplace();
+			// keep the script alive until all instances reference it
+			s.script = rm.load<JSScript>(Path(serializer.readString()));
+			s.first_prop = props.size();
+			serializer.read(s.num_props);
+			u32 offset = 0;
+			for (u32 j = 0; j < s.num_props; ++j) {
+				JSScriptModule::Property& prop = props.emplace();
+				serializer.read(prop.name_hash);
+				prop.type = (Property::Type)serializer.read<u8>();
+				prop.offset = offset;
+				offset += getValueSlotSize(prop.type);
+			}
+
+			const JSScript::Schema& schema = s.script->getSchema();
+			const Span<const JSScriptModule::Property> layout(props.begin() + s.first_prop, s.num_props);
+			s.matches_schema = schema.is_detected && layoutEquals(layout, toSpan(schema.properties));
+			// the script is usually not loaded yet, rows are checked against its schema once it's detected
+			s.row_layout = schema.is_detected ? -1 : addRowLayout(layout);
+		}
+
+		const i32 len = serializer.read<i32>();
+		m_scripts.reserve(len + m_scripts.size());
+		for (i32 i = 0; i < len; ++i) {
+			const EntityRef entity = (EntityRef)entity_map.get(serializer.read<EntityRef>());
+			ScriptComponent* script = LUMIX_NEW(allocator, ScriptComponent)(*this, entity, allocator);
+			m_scripts.insert(script->m_entity, script);
+
+			const i32 scr_count = serializer.read<i32>();
+			script->m_scripts.reserve(scr_count);
+			for (i32 scr_idx = 0; scr_idx < scr_count; ++scr_idx) {
+				ScriptInstance& scr = script->m_scripts.emplace(allocator);
+				scr.m_id = ++m_id_generator;
+
+				const i32 script_idx = serializer.read<i32>();
+				const bool is_row = serializer.read<bool>();
+				const u32 size = serializer.read<u32>();
+				const Span<const u8> data((const u8*)serializer.skip(size), size);
+
+				if (!is_row) {
+					scr.m_values.write(data.begin(), size);
+					remapTaggedEntities(scr.m_values, entity_map);
+				}
+				else {
+					const SerializedScript& s = scripts[script_idx];
+					const Span<const JSScriptModule::Property> schema(props.begin() + s.first_prop, s.num_props);
+					if (s.matches_schema || s.row_layout >= 0) {
+						scr.m_values.write(data.begin(), size);
+						scr.m_values_resolved = s.matches_schema;
+						scr.m_row_layout = s.row_layout;
+						for (const JSScriptModule::Property& prop : schema) {
+							if (prop.type == Property::ENTITY) remapEntitySlot(scr.m_values.getMutableData() + prop.offset, entity_map);
+						}
+					}
+					else {
+						rowToTagged(schema, data, scr.m_values);
+						remapTaggedEntities(scr.m_values, entity_map);
+					}
+				}
+				setScriptPathInternal(*script, scr, script_idx < 0 ? Path() : scripts[script_idx].script->getPath());
+			}
+			m_world.onComponentCreated(script->m_entity, JS_SCRIPT_TYPE, this);
+		}
+
+		for (SerializedScript& s : scripts) s.script->decRefCount();
+
+		if (version > (i32)JSScriptModuleVersion::COMPONENT_STORES) deserializeComponentStores(serializer, entity_map);
+	}
+
+
+	// worlds saved before schema rows, each instance has its own list of named values
+	void deserializeLegacy(InputMemoryStream& serializer, const EntityMap& entity_map) {
 		const i32 len = serializer.read<i32>();
 		m_scripts.reserve(len + m_scripts.size());
 		for (i32 i = 0; i < len; ++i) {
 			IAllocator& allocator = m_system.m_allocator;
 			
-			EntityRef entity;
-			serializer.read(entity);
+			const EntityRef entity = (EntityRef)entity_map.get(serializer.read<EntityRef>());
 			ScriptComponent* script = LUMIX_NEW(allocator, ScriptComponent)(*this, entity, allocator);
 
 			m_scripts.insert(script->m_entity, script);
@@ -996,22 +2301,24 @@ public:
 				auto& scr = script->m_scripts.emplace(allocator);
 
 				const char* path = serializer.readString();
-				serializer.read(scr.m_id);
+				serializer.read<uintptr>();
+				scr.m_id = ++m_id_generator;
 				i32 num_props;
 				serializer.read(num_props);
-				scr.m_properties.reserve(num_props);
+				// schema is not known yet, values are resolved when the script is started
+				scr.m_values.write((u32)num_props);
 				for (i32 j = 0; j < num_props; ++j) {
-					Property& prop = scr.m_properties.emplace(allocator);
-					serializer.read(prop.name_hash);
-					serializer.read(prop.type);
-					switch (prop.type) {
-						case Property::STRING : prop.stored_value.writeString(serializer.readString()); break;
-						case Property::NUMBER: prop.stored_value.write(serializer.read<double>()); break;
-						case Property::BOOLEAN: prop.stored_value.write(serializer.read<bool>()); break;
+					scr.m_values.write(serializer.read<StableHash>());
+					const Property::Type type = serializer.read<Property::Type>();
+					scr.m_values.write((u8)type);
+					switch (type) {
+						case Property::STRING : scr.m_values.writeString(serializer.readString()); break;
+						case Property::NUMBER: scr.m_values.write(serializer.read<double>()); break;
+						case Property::BOOLEAN: scr.m_values.write(serializer.read<bool>()); break;
 						case Property::ENTITY: {
 							EntityPtr e = serializer.read<EntityPtr>();
 							e = entity_map.get(e);
-							prop.stored_value.write(e);
+							scr.m_values.write(e);
 						}
 					}
 				}
@@ -1080,6 +2387,7 @@ public:
 				break;
 		}
 
+		InstanceScope scope(*m_heap, this, ctx_ref.id);
 		duk_push_global_stash(ctx);
 		duk_push_pointer(ctx, (void*)ctx_ref.id);
 		duk_get_prop(ctx, -2);
@@ -1105,13 +2413,626 @@ public:
 
 	void update(float time_delta) override {
 		PROFILE_FUNCTION();
+		m_system.pushHeapCounters(*m_heap);
 
 		if (!m_is_game_running) return;
 		if (!m_scripts_init_called) initScripts();
 
+		// results of jobs finished since the last update
+		m_system.m_compute_jobs.deliver(this);
+		if (m_deferred_writes) m_heap->commands = &m_commands;
 		processInputEvents();
-		for (int i = 0; i < m_updates.size(); ++i) {
-			ContextRef update_item = m_updates[i];
+		updateTimers(time_delta);
+		updateCoroutines();
+		deliverEvents();
+		deliverMessages();
+		callUpdates(*m_heap, m_updates, time_delta);
+		updateSystems(time_delta);
+		updateTweens(time_delta);
+		if (m_deferred_writes) {
+			// sync point, workers see the results
+			m_heap->commands = nullptr;
+			m_commands.apply(m_world);
+			m_commands.clear();
+		}
+		if (!m_workers.empty()) updateWorkers(time_delta);
+		m_system.m_compute_jobs.dispatch();
+	}
+
+
+	static bool isEarlier(const Timer& a, const Timer& b) {
+		if (a.time != b.time) return a.time < b.time;
+		return a.id < b.id;
+	}
+
+	static void siftTimerDown(Array<Timer>& timers, i32 idx) {
+		const i32 count = timers.size();
+		for (;;) {
+			const i32 left = idx * 2 + 1;
+			if (left >= count) return;
+			const i32 right = left + 1;
+			const i32 child = right < count && isEarlier(timers[right], timers[left]) ? right : left;
+			if (!isEarlier(timers[child], timers[idx])) return;
+			swap(timers[child], timers[idx]);
+			idx = child;
+		}
+	}
+
+	static void pushTimer(Array<Timer>& timers, const Timer& timer) {
+		i32 idx = timers.size();
+		timers.push(timer);
+		while (idx > 0) {
+			const i32 parent = (idx - 1) / 2;
+			if (!isEarlier(timers[idx], timers[parent])) break;
+			swap(timers[idx], timers[parent]);
+			idx = parent;
+		}
+	}
+
+	static void popTimer(Array<Timer>& timers) {
+		timers[0] = timers.back();
+		timers.pop();
+		siftTimerDown(timers, 0);
+	}
+
+	// callback is at callback_idx
+	u32 addTimer(duk_context* ctx, duk_idx_t callback_idx, double delay_ms, bool repeat, uintptr owner) {
+		callback_idx = duk_normalize_index(ctx, callback_idx);
+		Timer timer;
+		timer.id = getHeap(ctx).generateID();
+		timer.interval = delay_ms;
+		timer.time = m_time_ms + delay_ms;
+		timer.repeat = repeat;
+		timer.is_coroutine = false;
+		timer.owner = owner;
+		pushTimer(m_timers, timer);
+
+		duk_push_global_stash(ctx);
+		if (!duk_get_prop_string(ctx, -1, TIMERS_KEY)) {
+			duk_pop(ctx);
+			duk_push_object(ctx);
+			duk_dup(ctx, -1);
+			duk_put_prop_string(ctx, -3, TIMERS_KEY);
+		}
+		duk_dup(ctx, callback_idx);
+		duk_put_prop_index(ctx, -2, timer.id);
+		duk_pop_2(ctx);
+		return timer.id;
+	}
+
+	// the timer is dropped once it expires
+	void clearTimer(duk_context* ctx, u32 id) {
+		duk_push_global_stash(ctx);
+		if (duk_get_prop_string(ctx, -1, TIMERS_KEY)) {
+			duk_del_prop_index(ctx, -1, id);
+		}
+		duk_pop_2(ctx);
+	}
+
+	static bool removeOwnedTimers(Array<Timer>& timers, uintptr owner) {
+		bool removed = false;
+		for (i32 i = timers.size() - 1; i >= 0; --i) {
+			if (timers[i].owner != owner) continue;
+			timers.swapAndPop(i);
+			removed = true;
+		}
+		if (!removed) return false;
+
+		for (i32 i = timers.size() / 2 - 1; i >= 0; --i) siftTimerDown(timers, i);
+		return true;
+	}
+
+	void removeTimers(uintptr owner) {
+		for (const Timer& timer : m_timers) {
+			if (timer.owner == owner && !timer.is_coroutine) clearTimer(m_heap->ctx, timer.id);
+		}
+		removeOwnedTimers(m_timers, owner);
+	}
+
+	// only expired timers are touched
+	void updateTimers(float time_delta) {
+		m_time_ms += time_delta * 1000.0;
+		if (m_timers.empty() || m_timers[0].time > m_time_ms) return;
+
+		PROFILE_FUNCTION();
+		// collected first, so an interval fires at most once per update
+		while (!m_timers.empty() && m_timers[0].time <= m_time_ms) {
+			m_expired_timers.push(m_timers[0]);
+			popTimer(m_timers);
+		}
+
+		duk_context* ctx = m_heap->ctx;
+		duk_push_global_stash(ctx);
+		duk_get_prop_string(ctx, -1, TIMERS_KEY);
+		for (const Timer& timer : m_expired_timers) {
+			// [stash, timers]
+			if (timer.is_coroutine) {
+				duk_push_undefined(ctx);
+				resumeCoroutine(timer.id);
+				continue;
+			}
+
+			if (!duk_get_prop_index(ctx, -1, timer.id)) {
+				// cleared
+				duk_pop(ctx);
+				continue;
+			}
+
+			if (timer.repeat) {
+				Timer next = timer;
+				next.time = maximum(timer.time + timer.interval, m_time_ms);
+				pushTimer(m_timers, next);
+			}
+			else {
+				duk_del_prop_index(ctx, -2, timer.id);
+			}
+
+			duk_push_pointer(ctx, (void*)timer.owner);
+			duk_get_prop(ctx, -4); // [stash, timers, func, this]
+			InstanceScope scope(*m_heap, this, timer.owner);
+			if (duk_pcall_method(ctx, 0) == DUK_EXEC_ERROR) {
+				logError(duk_safe_to_stacktrace(ctx, -1));
+			}
+			duk_pop(ctx);
+		}
+		duk_pop_2(ctx);
+		m_expired_timers.clear();
+	}
+
+	// function is at fn_idx, it runs until it waits for the first time
+	u32 startCoroutine(duk_context* ctx, duk_idx_t fn_idx, uintptr owner) {
+		fn_idx = duk_normalize_index(ctx, fn_idx);
+		const u32 id = getHeap(ctx).generateID();
+		m_coroutines.insert(id, owner);
+
+		duk_push_global_stash(ctx);
+		duk_get_prop_string(ctx, -1, COROUTINE_API_KEY);
+		duk_get_prop_string(ctx, -1, "create");
+		duk_dup(ctx, fn_idx);
+		duk_push_pointer(ctx, (void*)owner);
+		duk_get_prop(ctx, -5); // [stash, api, create, fn, this]
+		if (duk_pcall(ctx, 2) != DUK_EXEC_SUCCESS) {
+			logError(duk_safe_to_stacktrace(ctx, -1));
+			duk_pop_3(ctx);
+			m_coroutines.erase(id);
+			return 0;
+		}
+		// [stash, api, thread]
+		if (!duk_get_prop_string(ctx, -3, COROUTINES_KEY)) {
+			duk_pop(ctx);
+			duk_push_object(ctx);
+			duk_dup(ctx, -1);
+			duk_put_prop_string(ctx, -5, COROUTINES_KEY);
+		}
+		duk_swap_top(ctx, -2);
+		duk_put_prop_index(ctx, -2, id);
+		duk_pop_3(ctx);
+
+		duk_push_undefined(ctx);
+		// started by another coroutine, it runs after that one waits
+		if (ctx != m_heap->ctx) wakeCoroutine(ctx, id);
+		else resumeCoroutine(id);
+		return id;
+	}
+
+	// value is on the top of ctx's stack, it's popped; the coroutine is resumed once the main context runs again
+	void wakeCoroutine(duk_context* ctx, u32 id) {
+		CoroutineWake wake;
+		wake.coroutine = id;
+		wake.value = 0;
+		if (duk_is_undefined(ctx, -1)) {
+			duk_pop(ctx);
+		}
+		else {
+			wake.value = getHeap(ctx).generateID();
+			duk_push_global_stash(ctx);
+			if (!duk_get_prop_string(ctx, -1, COROUTINE_VALUES_KEY)) {
+				duk_pop(ctx);
+				duk_push_object(ctx);
+				duk_dup(ctx, -1);
+				duk_put_prop_string(ctx, -3, COROUTINE_VALUES_KEY);
+			}
+			duk_dup(ctx, -3);
+			duk_put_prop_index(ctx, -2, wake.value);
+			duk_pop_3(ctx);
+		}
+		m_coroutine_wakes.push(wake);
+	}
+
+	// main context only, resumed coroutines can wake others, those are resumed in the same call
+	void resumeWokenCoroutines() {
+		if (m_coroutine_wakes.empty() || m_resuming_woken) return;
+
+		m_resuming_woken = true;
+		duk_context* ctx = m_heap->ctx;
+		for (i32 i = 0; i < m_coroutine_wakes.size(); ++i) {
+			const CoroutineWake wake = m_coroutine_wakes[i];
+			if (wake.value) {
+				duk_push_global_stash(ctx);
+				duk_get_prop_string(ctx, -1, COROUTINE_VALUES_KEY);
+				duk_get_prop_index(ctx, -1, wake.value);
+				duk_del_prop_index(ctx, -2, wake.value);
+				duk_replace(ctx, -3);
+				duk_pop(ctx);
+			}
+			else {
+				duk_push_undefined(ctx);
+			}
+			resumeCoroutine(wake.coroutine);
+		}
+		m_coroutine_wakes.clear();
+		m_resuming_woken = false;
+	}
+
+	void stopCoroutine(duk_context* ctx, u32 id) {
+		if (!m_coroutines.find(id).isValid()) return;
+
+		m_coroutines.erase(id);
+		duk_push_global_stash(ctx);
+		if (duk_get_prop_string(ctx, -1, COROUTINES_KEY)) {
+			duk_del_prop_index(ctx, -1, id);
+		}
+		duk_pop_2(ctx);
+
+		for (i32 i = m_coroutine_resources.size() - 1; i >= 0; --i) {
+			if (m_coroutine_resources[i].coroutine != id) continue;
+			m_coroutine_resources[i].resource->decRefCount();
+			m_coroutine_resources.swapAndPop(i);
+		}
+		for (i32 i = m_signal_waits.size() - 1; i >= 0; --i) {
+			if (m_signal_waits[i].coroutine == id) m_signal_waits.erase(i);
+		}
+		// other waits of stopped coroutines are dropped when they are met
+	}
+
+	void stopCoroutines(uintptr owner) {
+		Array<u32> ids(m_system.m_allocator);
+		for (auto iter = m_coroutines.begin(), end = m_coroutines.end(); iter != end; ++iter) {
+			if (iter.value() == owner) ids.push(iter.key());
+		}
+		for (u32 id : ids) stopCoroutine(m_heap->ctx, id);
+		removeOwnedTimers(m_frame_waits, owner);
+	}
+
+	// value passed to the coroutine is on the top of the stack, it's popped
+	void resumeCoroutine(u32 id) {
+		duk_context* ctx = m_heap->ctx;
+		auto iter = m_coroutines.find(id);
+		if (!iter.isValid()) {
+			duk_pop(ctx);
+			return;
+		}
+
+		InstanceScope scope(*m_heap, this, iter.value());
+		duk_push_global_stash(ctx);
+		duk_get_prop_string(ctx, -1, COROUTINE_API_KEY);
+		duk_get_prop_string(ctx, -1, "resume");
+		duk_get_prop_string(ctx, -3, COROUTINES_KEY);
+		duk_get_prop_index(ctx, -1, id);
+		duk_remove(ctx, -2);
+		duk_dup(ctx, -5); // [value, stash, api, resume, thread, value]
+		if (duk_pcall(ctx, 2) != DUK_EXEC_SUCCESS) {
+			logError(duk_safe_to_stacktrace(ctx, -1));
+			stopCoroutine(ctx, id);
+		}
+		else {
+			// [value, stash, api, yielded]
+			waitCoroutine(ctx, id);
+		}
+		duk_pop_n(ctx, 4);
+		resumeWokenCoroutines();
+	}
+
+	// what the coroutine waits for is on the top of the stack, see COROUTINE_API_SRC
+	void waitCoroutine(duk_context* ctx, u32 id) {
+		auto iter = m_coroutines.find(id);
+		// stopped while it ran
+		if (!iter.isValid()) return;
+
+		Timer wait;
+		wait.id = id;
+		wait.owner = iter.value();
+		wait.interval = 0;
+		wait.repeat = false;
+		wait.is_coroutine = true;
+
+		// anything else, e.g. plain Duktape.Thread.yield(), waits for the next frame
+		i32 kind = (i32)CoroutineWait::FRAMES;
+		double arg = 1;
+		if (duk_is_array(ctx, -1)) {
+			duk_get_prop_index(ctx, -1, 0);
+			kind = duk_get_int_default(ctx, -1, kind);
+			duk_pop(ctx);
+			duk_get_prop_index(ctx, -1, 1);
+		}
+		else {
+			duk_push_undefined(ctx);
+		}
+
+		switch ((CoroutineWait)kind) {
+			case CoroutineWait::DONE:
+				stopCoroutine(ctx, id);
+				break;
+			case CoroutineWait::TIME:
+				wait.time = m_time_ms + maximum(duk_get_number_default(ctx, -1, 0), 0.0) * 1000.0;
+				pushTimer(m_timers, wait);
+				break;
+			case CoroutineWait::RESOURCE: {
+				Resource* resource = nullptr;
+				if (duk_is_object(ctx, -1)) {
+					duk_get_prop_string(ctx, -1, "path");
+					duk_get_prop_string(ctx, -2, "c_resource_type");
+					const char* path = duk_get_string(ctx, -2);
+					const char* type = duk_get_string(ctx, -1);
+					if (path && type) {
+						ResourceManagerHub& rm = m_system.m_engine.getResourceManager();
+						resource = rm.load(ResourceType(type), Path(path));
+					}
+					duk_pop_2(ctx);
+				}
+				if (!resource) {
+					logError("Coroutine waits for invalid resource, use Lumix.resource(path, type)");
+					stopCoroutine(ctx, id);
+					break;
+				}
+				m_resource_waits.push({id, resource});
+				break;
+			}
+			case CoroutineWait::SIGNAL: {
+				const char* name = duk_get_string(ctx, -1);
+				m_signal_waits.push({id, RuntimeHash(name ? name : "")});
+				break;
+			}
+			case CoroutineWait::FRAMES:
+			default:
+				wait.time = double(m_frame + maximum(duk_get_uint_default(ctx, -1, 1), 1u));
+				pushTimer(m_frame_waits, wait);
+				break;
+		}
+		duk_pop(ctx);
+	}
+
+	// value is on the top of the stack, it's popped
+	void signal(duk_context* ctx, const char* name) {
+		const RuntimeHash hash(name);
+		Array<u32> ready(m_system.m_allocator);
+		for (i32 i = m_signal_waits.size() - 1; i >= 0; --i) {
+			if (m_signal_waits[i].name != hash) continue;
+			ready.push(m_signal_waits[i].coroutine);
+			m_signal_waits.erase(i);
+		}
+		// in the order they started to wait
+		for (i32 i = ready.size() - 1; i >= 0; --i) {
+			duk_dup_top(ctx);
+			// sent by a coroutine, the main context is suspended in its resume
+			if (ctx != m_heap->ctx) wakeCoroutine(ctx, ready[i]);
+			else resumeCoroutine(ready[i]);
+		}
+		duk_pop(ctx);
+	}
+
+	// resumes coroutines waiting for frames or resources
+	void updateCoroutines() {
+		++m_frame;
+		if (m_frame_waits.empty() && m_resource_waits.empty()) return;
+
+		PROFILE_FUNCTION();
+		duk_context* ctx = m_heap->ctx;
+		while (!m_frame_waits.empty() && m_frame_waits[0].time <= double(m_frame)) {
+			m_ready_coroutines.push(m_frame_waits[0].id);
+			popTimer(m_frame_waits);
+		}
+		for (u32 id : m_ready_coroutines) {
+			duk_push_undefined(ctx);
+			resumeCoroutine(id);
+		}
+		m_ready_coroutines.clear();
+
+		// resources the coroutine waited for stay loaded until the coroutine ends
+		for (i32 i = m_resource_waits.size() - 1; i >= 0; --i) {
+			const ResourceWait wait = m_resource_waits[i];
+			if (wait.resource->isEmpty()) continue;
+
+			m_resource_waits.swapAndPop(i);
+			if (!m_coroutines.find(wait.coroutine).isValid()) {
+				wait.resource->decRefCount();
+				continue;
+			}
+			m_coroutine_resources.push(wait);
+			duk_push_boolean(ctx, wait.resource->isReady());
+			resumeCoroutine(wait.coroutine);
+		}
+	}
+
+	void postEvent(RuntimeHash type, EntityPtr entity, Span<const JSEventArg> args) override {
+		// nobody would get it
+		if (!m_is_game_running || m_event_subscriptions.empty()) return;
+
+		QueuedEvent& event = m_events.emplace();
+		event.type = type;
+		event.entity = entity;
+		event.arg_count = minimum(args.length(), MAX_EVENT_ARGS);
+		ASSERT(args.length() <= MAX_EVENT_ARGS);
+		for (u32 i = 0; i < event.arg_count; ++i) event.args[i] = args[i];
+	}
+
+	// handler is at handler_idx
+	u32 subscribeEvent(duk_context* ctx, const char* type, EntityPtr entity, duk_idx_t handler_idx, uintptr owner) {
+		handler_idx = duk_normalize_index(ctx, handler_idx);
+		EventSubscription& sub = m_event_subscriptions.emplace();
+		sub.type = RuntimeHash(type);
+		sub.entity = entity;
+		sub.owner = owner;
+		sub.id = getHeap(ctx).generateID();
+		sub.removed = false;
+		m_event_subscriptions_dirty = true;
+
+		duk_push_global_stash(ctx);
+		if (!duk_get_prop_string(ctx, -1, EVENT_HANDLERS_KEY)) {
+			duk_pop(ctx);
+			duk_push_object(ctx);
+			duk_dup(ctx, -1);
+			duk_put_prop_string(ctx, -3, EVENT_HANDLERS_KEY);
+		}
+		duk_dup(ctx, handler_idx);
+		duk_put_prop_index(ctx, -2, sub.id);
+		duk_pop_2(ctx);
+		return sub.id;
+	}
+
+	// subscriptions are removed from the array in deliverEvents, so it can be called from handlers
+	void unsubscribeEvent(duk_context* ctx, u32 id) {
+		for (EventSubscription& sub : m_event_subscriptions) {
+			if (sub.id != id) continue;
+			sub.removed = true;
+			m_event_subscriptions_dirty = true;
+		}
+		duk_push_global_stash(ctx);
+		if (duk_get_prop_string(ctx, -1, EVENT_HANDLERS_KEY)) {
+			duk_del_prop_index(ctx, -1, id);
+		}
+		duk_pop_2(ctx);
+	}
+
+	void unsubscribeEvents(uintptr owner) {
+		for (const EventSubscription& sub : m_event_subscriptions) {
+			if (sub.owner == owner && !sub.removed) unsubscribeEvent(m_heap->ctx, sub.id);
+		}
+	}
+
+	static void pushEventArg(duk_context* ctx, const JSEventArg& arg, World& world) {
+		switch (arg.type) {
+			case JSEventArg::Type::NUMBER: duk_push_number(ctx, arg.number); break;
+			case JSEventArg::Type::BOOLEAN: duk_push_boolean(ctx, arg.boolean); break;
+			case JSEventArg::Type::ENTITY: JSWrapper::pushEntity(ctx, arg.entity, &world); break;
+			case JSEventArg::Type::VEC3: JSWrapper::push(ctx, arg.vec3); break;
+		}
+	}
+
+	// all events of a frame, each subscriber gets its events in one pass
+	void deliverEvents() {
+		if (m_events.empty()) return;
+
+		PROFILE_FUNCTION();
+		if (m_event_subscriptions_dirty) {
+			for (i32 i = m_event_subscriptions.size() - 1; i >= 0; --i) {
+				if (m_event_subscriptions[i].removed) m_event_subscriptions.swapAndPop(i);
+			}
+			qsort(m_event_subscriptions.begin(), m_event_subscriptions.size(), sizeof(EventSubscription), [](const void* a, const void* b) -> int {
+				const EventSubscription& sa = *(const EventSubscription*)a;
+				const EventSubscription& sb = *(const EventSubscription*)b;
+				if (sa.owner != sb.owner) return sa.owner < sb.owner ? -1 : 1;
+				return sa.id < sb.id ? -1 : 1;
+			});
+			m_event_subscriptions_dirty = false;
+		}
+
+		// events posted by handlers are delivered in the next update
+		swap(m_events, m_delivered_events);
+		m_events.clear();
+		m_event_chains.clear();
+		for (i32 i = m_delivered_events.size() - 1; i >= 0; --i) {
+			QueuedEvent& event = m_delivered_events[i];
+			auto iter = m_event_chains.find(event.type);
+			if (iter.isValid()) {
+				event.next = iter.value();
+				iter.value() = i;
+			}
+			else {
+				event.next = -1;
+				m_event_chains.insert(event.type, i);
+			}
+		}
+
+		duk_context* ctx = m_heap->ctx;
+		duk_push_global_stash(ctx);
+		duk_get_prop_string(ctx, -1, EVENT_HANDLERS_KEY);
+		// subscriptions added by handlers are appended, they get the events too
+		for (i32 i = 0; i < m_event_subscriptions.size(); ++i) {
+			const EventSubscription sub = m_event_subscriptions[i];
+			if (sub.removed) continue;
+			auto iter = m_event_chains.find(sub.type);
+			if (!iter.isValid()) continue;
+
+			InstanceScope scope(*m_heap, this, sub.owner);
+			duk_push_pointer(ctx, (void*)sub.owner);
+			duk_get_prop(ctx, -3); // [stash, handlers, this]
+			for (i32 e = iter.value(); e >= 0; e = m_delivered_events[e].next) {
+				const QueuedEvent& event = m_delivered_events[e];
+				if (sub.entity.isValid() && sub.entity != event.entity) continue;
+				// unsubscribed by a handler
+				if (!duk_get_prop_index(ctx, -2, sub.id)) {
+					duk_pop(ctx);
+					break;
+				}
+				duk_dup(ctx, -2);
+				JSWrapper::pushEntity(ctx, event.entity, &m_world);
+				for (u32 a = 0; a < event.arg_count; ++a) pushEventArg(ctx, event.args[a], m_world);
+				if (duk_pcall_method(ctx, event.arg_count + 1) == DUK_EXEC_ERROR) {
+					logError(duk_safe_to_stacktrace(ctx, -1));
+				}
+				duk_pop(ctx);
+			}
+			duk_pop(ctx);
+		}
+		duk_pop_2(ctx);
+		m_delivered_events.clear();
+	}
+
+	void stopAllCoroutines() {
+		Array<u32> ids(m_system.m_allocator);
+		for (auto iter = m_coroutines.begin(), end = m_coroutines.end(); iter != end; ++iter) {
+			ids.push(iter.key());
+		}
+		for (u32 id : ids) stopCoroutine(m_heap->ctx, id);
+		for (const ResourceWait& wait : m_resource_waits) wait.resource->decRefCount();
+		m_resource_waits.clear();
+		m_signal_waits.clear();
+		m_frame_waits.clear();
+		// the stash object is shared by all worlds in the shared heap
+		duk_context* ctx = m_heap->ctx;
+		duk_push_global_stash(ctx);
+		if (duk_get_prop_string(ctx, -1, COROUTINE_VALUES_KEY)) {
+			for (const CoroutineWake& wake : m_coroutine_wakes) {
+				if (wake.value) duk_del_prop_index(ctx, -1, wake.value);
+			}
+		}
+		duk_pop_2(ctx);
+		m_coroutine_wakes.clear();
+		m_frame = 0;
+	}
+
+	void updateWorkers(float time_delta) {
+		PROFILE_FUNCTION();
+		for (Worker& worker : m_workers) {
+			worker.heap->commands = &worker.commands;
+			worker.heap->log = &worker.log;
+		}
+
+		// each heap is touched only by one job, world is only read until the commands are applied
+		jobs::forEach(m_workers.size(), 1, [&](i32 from, i32 to){
+			PROFILE_BLOCK("js worker update");
+			for (i32 i = from; i < to; ++i) {
+				callUpdates(*m_workers[i].heap, m_workers[i].updates, time_delta);
+			}
+		});
+
+		for (Worker& worker : m_workers) {
+			worker.heap->commands = nullptr;
+			worker.heap->log = nullptr;
+			InputMemoryStream errors(worker.log);
+			while (errors.getPosition() < errors.size()) logError(errors.readString());
+			worker.log.clear();
+			worker.commands.apply(m_world);
+			worker.commands.clear();
+		}
+	}
+
+
+	void callUpdates(JSHeap& heap, const Array<ContextRef>& updates, float time_delta) {
+		for (int i = 0; i < updates.size(); ++i) {
+			ContextRef update_item = updates[i];
+			InstanceScope scope(heap, this, update_item.id);
 			duk_push_global_stash(update_item.context);
 			duk_push_pointer(update_item.context, (void*)update_item.id);
 			duk_get_prop(update_item.context, -2);					//[stash, this]
@@ -1121,26 +3042,1027 @@ public:
 			if (duk_pcall_method(update_item.context, 1) == DUK_EXEC_ERROR) //[stash, this, func, this, arg] -> [stash, this, retval]
 			{
 				const char* error = duk_safe_to_string(update_item.context, -1);
+				reportError(heap, error);
+			}
+			duk_pop_3(update_item.context);
+		}
+	}
+
+
+	// payload is at payload_idx, target is INVALID_ENTITY for broadcast
+	void sendMessage(duk_context* ctx, EntityPtr target, const char* name, duk_idx_t payload_idx) {
+		// nobody would get it
+		if (!m_is_game_running) return;
+
+		Message msg;
+		msg.target = target;
+		msg.name_hash = RuntimeHash(name);
+		msg.payload = 0;
+		msg.seq = 0;
+
+		if (!duk_is_undefined(ctx, payload_idx)) {
+			payload_idx = duk_normalize_index(ctx, payload_idx);
+			msg.payload = getHeap(ctx).generateID();
+			duk_push_global_stash(ctx);
+			if (!duk_get_prop_string(ctx, -1, MESSAGES_KEY)) {
+				duk_pop(ctx);
+				duk_push_object(ctx);
+				duk_dup(ctx, -1);
+				duk_put_prop_string(ctx, -3, MESSAGES_KEY);
+			}
+			duk_dup(ctx, payload_idx);
+			duk_put_prop_index(ctx, -2, msg.payload);
+			duk_pop_2(ctx);
+		}
+
+		// ring buffer, capacity is a power of two
+		u32 capacity = m_messages.size();
+		if (m_message_count == capacity) {
+			Array<Message> grown(m_system.m_allocator);
+			grown.resize(maximum(capacity * 2, 64u));
+			for (u32 i = 0; i < m_message_count; ++i) grown[i] = m_messages[(m_message_head + i) & (capacity - 1)];
+			swap(m_messages, grown);
+			m_message_head = 0;
+			capacity = m_messages.size();
+		}
+		m_messages[(m_message_head + m_message_count) & (capacity - 1)] = msg;
+		++m_message_count;
+	}
+
+	// scripts of the module's heap on entity
+	void pushMessageReceivers(EntityRef entity) {
+		auto iter = m_scripts.find(entity);
+		if (!iter.isValid()) return;
+		for (const ScriptInstance& inst : iter.value()->m_scripts) {
+			// parallel scripts live in other heaps, payloads can't be passed there
+			if (inst.m_script && inst.m_worker < 0) m_message_receivers.push({entity, inst.m_id});
+		}
+	}
+
+	// each receiver gets its messages in one pass, message is handled by the receiver's function with the message's name
+	void deliverToReceivers(Span<const Message> messages) {
+		duk_context* ctx = m_heap->ctx;
+		duk_push_global_stash(ctx);
+		duk_get_prop_string(ctx, -1, MESSAGES_KEY); // [stash, payloads]
+		for (const MessageReceiver& receiver : m_message_receivers) {
+			// handlers of earlier receivers can remove the instance, its script or destroy the entity
+			const ScriptInstance* inst = findInstance(receiver.entity, receiver.instance);
+			if (!inst || !inst->m_script || inst->m_worker >= 0) continue;
+			JSScript* script = inst->m_script;
+			if (!script->getSchema().is_detected) continue;
+
+			duk_push_pointer(ctx, (void*)receiver.instance);
+			duk_get_prop(ctx, -3); // [stash, payloads, this]
+			if (!duk_is_object(ctx, -1)) {
+				duk_pop(ctx);
+				continue;
+			}
+
+			InstanceScope scope(*m_heap, this, receiver.instance);
+			for (const Message& msg : messages) {
+				// the receiver's own handlers can do the same
+				inst = findInstance(receiver.entity, receiver.instance);
+				if (!inst || inst->m_script != script || inst->m_worker >= 0) break;
+				const char* handler = script->getSchema().findMethod(msg.name_hash);
+				if (!handler) continue;
+
+				duk_get_prop_string(ctx, -1, handler);                            // [stash, payloads, this, func]
+				duk_dup(ctx, -2);                                                 // [stash, payloads, this, func, this]
+				if (msg.payload) duk_get_prop_index(ctx, -4, msg.payload);
+				else duk_push_undefined(ctx);
+				if (duk_pcall_method(ctx, 1) == DUK_EXEC_ERROR) {
+					const char* error = duk_safe_to_string(ctx, -1);
+					logError(error);
+				}
+				duk_pop(ctx);
+			}
+			duk_pop(ctx);
+		}
+		duk_pop_2(ctx);
+	}
+
+	// messages sent since the last update, grouped by target
+	void deliverMessages() {
+		if (m_message_count == 0) return;
+
+		PROFILE_FUNCTION();
+		profiler::pushInt("messages", m_message_count);
+		// messages sent by handlers are delivered in the next update
+		const u32 mask = m_messages.size() - 1;
+		for (u32 i = 0; i < m_message_count; ++i) {
+			Message& msg = m_delivered_messages.emplace();
+			msg = m_messages[(m_message_head + i) & mask];
+			msg.seq = i;
+		}
+		m_message_head = (m_message_head + m_message_count) & mask;
+		m_message_count = 0;
+
+		// broadcasts go first, the rest is grouped by target in the order of sending
+		qsort(m_delivered_messages.begin(), m_delivered_messages.size(), sizeof(Message), [](const void* a, const void* b) -> int {
+			const Message& ma = *(const Message*)a;
+			const Message& mb = *(const Message*)b;
+			if (ma.target.index != mb.target.index) return ma.target.index < mb.target.index ? -1 : 1;
+			return ma.seq < mb.seq ? -1 : 1;
+		});
+
+		const i32 count = m_delivered_messages.size();
+		i32 broadcasts = 0;
+		while (broadcasts < count && !m_delivered_messages[broadcasts].target.isValid()) ++broadcasts;
+		if (broadcasts > 0) {
+			m_message_receivers.clear();
+			for (auto iter = m_scripts.begin(), end = m_scripts.end(); iter != end; ++iter) pushMessageReceivers(iter.key());
+			deliverToReceivers(Span<const Message>(m_delivered_messages.begin(), broadcasts));
+		}
+		for (i32 i = broadcasts; i < count;) {
+			i32 end = i + 1;
+			while (end < count && m_delivered_messages[end].target == m_delivered_messages[i].target) ++end;
+			m_message_receivers.clear();
+			pushMessageReceivers(*m_delivered_messages[i].target);
+			if (!m_message_receivers.empty()) deliverToReceivers(Span<const Message>(m_delivered_messages.begin() + i, end - i));
+			i = end;
+		}
+
+		duk_context* ctx = m_heap->ctx;
+		duk_push_global_stash(ctx);
+		if (duk_get_prop_string(ctx, -1, MESSAGES_KEY)) {
+			for (const Message& msg : m_delivered_messages) {
+				if (msg.payload) duk_del_prop_index(ctx, -1, msg.payload);
+			}
+		}
+		duk_pop_2(ctx);
+		m_delivered_messages.clear();
+		m_message_receivers.clear();
+	}
+
+	void clearMessages() {
+		const u32 mask = m_messages.size() - 1;
+		duk_context* ctx = m_heap->ctx;
+		duk_push_global_stash(ctx);
+		if (duk_get_prop_string(ctx, -1, MESSAGES_KEY)) {
+			for (u32 i = 0; i < m_message_count; ++i) {
+				const Message& msg = m_messages[(m_message_head + i) & mask];
+				if (msg.payload) duk_del_prop_index(ctx, -1, msg.payload);
+			}
+		}
+		duk_pop_2(ctx);
+		m_message_head = 0;
+		m_message_count = 0;
+	}
+
+	static u32 getTweenValueCount(TweenTarget target) {
+		switch (target) {
+			case TweenTarget::FLOAT: return 1;
+			case TweenTarget::VEC2: return 2;
+			case TweenTarget::ROTATION:
+			case TweenTarget::VEC4: return 4;
+			default: return 3;
+		}
+	}
+
+	// T is float or a vector of floats
+	template <typename T> static void toDoubles(const T& v, double* out) {
+		const float* f = (const float*)&v;
+		for (u32 i = 0; i < sizeof(T) / sizeof(float); ++i) out[i] = f[i];
+	}
+
+	template <typename T> static T fromDoubles(const double* values) {
+		T v;
+		float* f = (float*)&v;
+		for (u32 i = 0; i < sizeof(T) / sizeof(float); ++i) f[i] = (float)values[i];
+		return v;
+	}
+
+	template <typename T> static const reflection::Property<T>& getTweenProperty(const Tween& tween, ComponentUID& cmp) {
+		cmp.module = tween.module;
+		cmp.type = tween.cmp_type;
+		cmp.entity = tween.entity;
+		return *(const reflection::Property<T>*)tween.property;
+	}
+
+	template <typename T> static void getPropertyValue(const Tween& tween, double* value) {
+		ComponentUID cmp;
+		const reflection::Property<T>& prop = getTweenProperty<T>(tween, cmp);
+		toDoubles(prop.get(cmp, -1), value);
+	}
+
+	template <typename T> static void setPropertyValue(const Tween& tween, const double* value, JSCommandBuffer* commands) {
+		ComponentUID cmp;
+		const reflection::Property<T>& prop = getTweenProperty<T>(tween, cmp);
+		if (commands) commands->setProperty(cmp, prop, fromDoubles<T>(value));
+		else prop.set(cmp, -1, fromDoubles<T>(value));
+	}
+
+	void getTweenValue(const Tween& tween, double* value) {
+		switch (tween.target) {
+			case TweenTarget::POSITION: {
+				const DVec3 pos = m_world.getPosition(tween.entity);
+				value[0] = pos.x;
+				value[1] = pos.y;
+				value[2] = pos.z;
+				break;
+			}
+			case TweenTarget::ROTATION: toDoubles(m_world.getRotation(tween.entity), value); break;
+			case TweenTarget::SCALE: toDoubles(m_world.getScale(tween.entity), value); break;
+			case TweenTarget::FLOAT: getPropertyValue<float>(tween, value); break;
+			case TweenTarget::VEC2: getPropertyValue<Vec2>(tween, value); break;
+			case TweenTarget::VEC3: getPropertyValue<Vec3>(tween, value); break;
+			case TweenTarget::VEC4: getPropertyValue<Vec4>(tween, value); break;
+		}
+	}
+
+	// with deferred writes the value is recorded after the writes of this frame's scripts, so the tween wins
+	void setTweenValue(const Tween& tween, const double* value) {
+		JSCommandBuffer* commands = m_heap->commands;
+		switch (tween.target) {
+			case TweenTarget::POSITION: {
+				const DVec3 pos(value[0], value[1], value[2]);
+				if (commands) commands->setPosition(tween.entity, pos);
+				else m_world.setPosition(tween.entity, pos);
+				break;
+			}
+			case TweenTarget::ROTATION:
+				if (commands) commands->setRotation(tween.entity, fromDoubles<Quat>(value));
+				else m_world.setRotation(tween.entity, fromDoubles<Quat>(value));
+				break;
+			case TweenTarget::SCALE:
+				if (commands) commands->setScale(tween.entity, fromDoubles<Vec3>(value));
+				else m_world.setScale(tween.entity, fromDoubles<Vec3>(value));
+				break;
+			case TweenTarget::FLOAT: setPropertyValue<float>(tween, value, commands); break;
+			case TweenTarget::VEC2: setPropertyValue<Vec2>(tween, value, commands); break;
+			case TweenTarget::VEC3: setPropertyValue<Vec3>(tween, value, commands); break;
+			case TweenTarget::VEC4: setPropertyValue<Vec4>(tween, value, commands); break;
+		}
+	}
+
+	// id, from and time of the tween are set here, it replaces a tween of the same value
+	u32 addTween(duk_context* ctx, Tween tween, duk_idx_t callback_idx) {
+		callback_idx = duk_normalize_index(ctx, callback_idx);
+		for (i32 i = m_tweens.size() - 1; i >= 0; --i) {
+			const Tween& t = m_tweens[i];
+			if (t.entity == tween.entity && t.target == tween.target && t.property == tween.property) removeTween(i);
+		}
+
+		tween.id = getHeap(ctx).generateID();
+		tween.time = 0;
+		tween.has_callback = duk_is_function(ctx, callback_idx);
+		getTweenValue(tween, tween.from);
+		m_tweens.push(tween);
+
+		if (tween.has_callback) {
+			duk_push_global_stash(ctx);
+			if (!duk_get_prop_string(ctx, -1, TWEENS_KEY)) {
+				duk_pop(ctx);
+				duk_push_object(ctx);
+				duk_dup(ctx, -1);
+				duk_put_prop_string(ctx, -3, TWEENS_KEY);
+			}
+			duk_dup(ctx, callback_idx);
+			duk_put_prop_index(ctx, -2, tween.id);
+			duk_pop_2(ctx);
+		}
+		return tween.id;
+	}
+
+	// the callback is not called
+	void removeTween(i32 idx) {
+		if (m_tweens[idx].has_callback) {
+			duk_context* ctx = m_heap->ctx;
+			duk_push_global_stash(ctx);
+			if (duk_get_prop_string(ctx, -1, TWEENS_KEY)) duk_del_prop_index(ctx, -1, m_tweens[idx].id);
+			duk_pop_2(ctx);
+		}
+		m_tweens.swapAndPop(idx);
+	}
+
+	void cancelTween(u32 id) {
+		for (i32 i = 0; i < m_tweens.size(); ++i) {
+			if (m_tweens[i].id != id) continue;
+			removeTween(i);
+			return;
+		}
+	}
+
+	void removeTweens(uintptr owner) {
+		for (i32 i = m_tweens.size() - 1; i >= 0; --i) {
+			if (m_tweens[i].owner == owner) removeTween(i);
+		}
+		// the owner can be destroyed by a callback of another finished tween
+		for (Tween& tween : m_finished_tweens) {
+			if (tween.owner != owner || !tween.has_callback) continue;
+			duk_context* ctx = m_heap->ctx;
+			duk_push_global_stash(ctx);
+			if (duk_get_prop_string(ctx, -1, TWEENS_KEY)) duk_del_prop_index(ctx, -1, tween.id);
+			duk_pop_2(ctx);
+			tween.has_callback = false;
+		}
+	}
+
+	// the stash object is shared by all worlds in the shared heap, only this module's callbacks are removed
+	void clearTweens() {
+		duk_context* ctx = m_heap->ctx;
+		duk_push_global_stash(ctx);
+		if (duk_get_prop_string(ctx, -1, TWEENS_KEY)) {
+			for (const Tween& tween : m_tweens) {
+				if (tween.has_callback) duk_del_prop_index(ctx, -1, tween.id);
+			}
+		}
+		duk_pop_2(ctx);
+		m_tweens.clear();
+	}
+
+	// no JS runs unless a tween with a callback finishes
+	void updateTweens(float time_delta) {
+		if (m_tweens.empty()) return;
+
+		PROFILE_FUNCTION();
+		for (i32 i = m_tweens.size() - 1; i >= 0; --i) {
+			Tween& tween = m_tweens[i];
+			if (tween.property && !m_world.hasComponent(tween.entity, tween.cmp_type)) {
+				removeTween(i);
+				continue;
+			}
+
+			tween.time += time_delta;
+			const float t = tween.time < tween.duration ? tween.time / tween.duration : 1;
+			const float k = ease(tween.easing, t);
+			double value[4];
+			if (tween.target == TweenTarget::ROTATION) {
+				toDoubles(nlerp(fromDoubles<Quat>(tween.from), fromDoubles<Quat>(tween.to), k), value);
+			}
+			else {
+				for (u32 j = 0; j < 4; ++j) value[j] = tween.from[j] + (tween.to[j] - tween.from[j]) * k;
+			}
+			setTweenValue(tween, value);
+
+			if (t < 1) continue;
+			if (tween.has_callback) m_finished_tweens.push(tween);
+			m_tweens.swapAndPop(i);
+		}
+		if (m_finished_tweens.empty()) return;
+
+		// in the order the tweens finished, callbacks can add tweens
+		duk_context* ctx = m_heap->ctx;
+		duk_push_global_stash(ctx);
+		duk_get_prop_string(ctx, -1, TWEENS_KEY);
+		for (i32 i = 0; i < m_finished_tweens.size(); ++i) {
+			const Tween tween = m_finished_tweens[i];
+			if (!tween.has_callback) continue;
+			// [stash, tweens]
+			duk_get_prop_index(ctx, -1, tween.id);
+			duk_del_prop_index(ctx, -2, tween.id);
+			duk_push_pointer(ctx, (void*)tween.owner);
+			duk_get_prop(ctx, -4); // [stash, tweens, func, this]
+			InstanceScope scope(*m_heap, this, tween.owner);
+			if (duk_pcall_method(ctx, 0) == DUK_EXEC_ERROR) {
+				logError(duk_safe_to_stacktrace(ctx, -1));
+			}
+			duk_pop(ctx);
+		}
+		duk_pop_2(ctx);
+		m_finished_tweens.clear();
+	}
+
+	void addSystem(const Path& path) override {
+		if (!m_is_game_running) {
+			logError("System ", path, " can be added only while the game is running");
+			return;
+		}
+
+		SystemScript& system = m_system_scripts.emplace();
+		system.script = m_system.m_engine.getResourceManager().load<JSScript>(path);
+		system.id = ++m_id_generator;
+		system.views_id = m_heap->generateID();
+		system.views_count = 0;
+		system.type_count = 0;
+		system.transforms = false;
+		system.started = false;
+		system.failed = false;
+		system.removed = false;
+	}
+
+	void removeSystem(const Path& path) override {
+		for (i32 i = m_system_scripts.size() - 1; i >= 0; --i) {
+			const SystemScript& system = m_system_scripts[i];
+			if (system.removed || system.script->getPath() != path) continue;
+
+			removeSystemAt(i);
+			return;
+		}
+	}
+
+	// while systems are updated, the entry is only marked, so updateSystems does not skip the next system
+	void removeSystemAt(i32 idx) {
+		m_system_scripts[idx].removed = true;
+		// copy, onDestroy can add systems
+		const SystemScript system = m_system_scripts[idx];
+		if (system.started) {
+			InstanceScope scope(*m_heap, this, system.id);
+			callSystemMethod(system, "onDestroy");
+		}
+		removeTimers(system.id);
+		removeTweens(system.id);
+		stopCoroutines(system.id);
+		unsubscribeEvents(system.id);
+
+		duk_context* ctx = m_heap->ctx;
+		duk_push_global_stash(ctx);
+		duk_push_pointer(ctx, (void*)system.id);
+		duk_del_prop(ctx, -2);
+		if (duk_get_prop_string(ctx, -1, SYSTEMS_KEY)) duk_del_prop_index(ctx, -1, system.views_id);
+		duk_pop_2(ctx);
+
+		if (m_updating_systems) return;
+		for (i32 i = m_system_scripts.size() - 1; i >= 0; --i) {
+			if (m_system_scripts[i].id != system.id) continue;
+			system.script->decRefCount();
+			m_system_scripts.erase(i);
+			return;
+		}
+	}
+
+	// calls the system's function without arguments, if it has it
+	void callSystemMethod(const SystemScript& system, const char* function) {
+		duk_context* ctx = m_heap->ctx;
+		duk_push_global_stash(ctx);
+		duk_push_pointer(ctx, (void*)system.id);
+		duk_get_prop(ctx, -2); // [stash, this]
+		if (duk_is_object(ctx, -1) && isMethod(ctx, function)) {
+			duk_get_prop_string(ctx, -1, function);
+			duk_dup(ctx, -2);
+			if (duk_pcall_method(ctx, 0) == DUK_EXEC_ERROR) {
+				const char* error = duk_safe_to_string(ctx, -1);
+				logError(error);
+			}
+			duk_pop(ctx);
+		}
+		duk_pop_2(ctx);
+	}
+
+	// evaluates the script and reads its query, returns false if it can't be updated
+	// the script's code can add systems, so the entry is looked up by idx after it runs
+	bool startSystem(i32 idx) {
+		duk_context* ctx = m_heap->ctx;
+		JSWrapper::DebugGuard guard(ctx);
+		JSScript* script = m_system_scripts[idx].script;
+		InstanceScope scope(*m_heap, this, m_system_scripts[idx].id);
+		const char* path = script->getPath().c_str();
+
+		duk_push_global_stash(ctx);
+		duk_push_string(ctx, path);
+		if (duk_pcompile_string_filename(ctx, DUK_COMPILE_EVAL, script->getSourceCode()) != 0 || duk_pcall(ctx, 0) != 0) {
+			const char* error = duk_safe_to_stacktrace(ctx, -1);
+			logError(error);
+			duk_pop_2(ctx);
+			return false;
+		}
+		if (!duk_is_object(ctx, -1)) {
+			logError(path, ": system script must return an object");
+			duk_pop_2(ctx);
+			return false;
+		}
+
+		SystemScript& system = m_system_scripts[idx];
+		duk_get_prop_string(ctx, -1, "query");
+		const u32 type_count = duk_is_array(ctx, -1) ? (u32)duk_get_length(ctx, -1) : 0;
+		if (type_count == 0 || type_count > MAX_QUERY_COMPONENTS) {
+			logError(path, ": system script must have a query with 1 to ", MAX_QUERY_COMPONENTS, " components");
+			duk_pop_3(ctx);
+			return false;
+		}
+		for (u32 i = 0; i < type_count; ++i) {
+			duk_get_prop_index(ctx, -1, i);
+			const char* name = duk_get_string(ctx, -1);
+			if (!name || !reflection::componentTypeExists(name)) {
+				logError(path, ": unknown component ", name ? name : "");
+				duk_pop_n(ctx, 4);
+				return false;
+			}
+			system.types[i] = reflection::getComponentType(name);
+			duk_pop(ctx);
+		}
+		system.type_count = type_count;
+		duk_pop(ctx);
+
+		if (!isMethod(ctx, "update")) {
+			logError(path, ": system script must have an update function");
+			duk_pop_2(ctx);
+			return false;
+		}
+
+		duk_get_prop_string(ctx, -1, "transforms");
+		system.transforms = duk_to_boolean(ctx, -1);
+		duk_pop(ctx);
+
+		duk_push_pointer(ctx, (void*)system.id);
+		duk_dup(ctx, -2);
+		duk_put_prop(ctx, -4); // stash[system.id] = obj
+		duk_pop_2(ctx);
+		return true;
+	}
+
+	// creates typed arrays for count entities, [state] -> [state]
+	static void createSystemViews(duk_context* ctx, u32 count, bool transforms) {
+		duk_push_fixed_buffer(ctx, count * sizeof(i32));
+		duk_push_buffer_object(ctx, -1, 0, count * sizeof(i32), DUK_BUFOBJ_INT32ARRAY);
+		duk_put_prop_string(ctx, -3, "entities");
+		duk_pop(ctx);
+		if (!transforms) return;
+
+		duk_push_object(ctx);
+		duk_push_fixed_buffer(ctx, count * sizeof(double) * 3);
+		duk_push_buffer_object(ctx, -1, 0, count * sizeof(double) * 3, DUK_BUFOBJ_FLOAT64ARRAY);
+		duk_put_prop_string(ctx, -3, "positions");
+		duk_pop(ctx);
+		duk_push_fixed_buffer(ctx, count * sizeof(float) * 4);
+		duk_push_buffer_object(ctx, -1, 0, count * sizeof(float) * 4, DUK_BUFOBJ_FLOAT32ARRAY);
+		duk_put_prop_string(ctx, -3, "rotations");
+		duk_pop(ctx);
+		duk_push_fixed_buffer(ctx, count * sizeof(float) * 3);
+		duk_push_buffer_object(ctx, -1, 0, count * sizeof(float) * 3, DUK_BUFOBJ_FLOAT32ARRAY);
+		duk_put_prop_string(ctx, -3, "scales");
+		duk_pop(ctx);
+		duk_put_prop_string(ctx, -2, "transforms");
+	}
+
+	// data of a typed array in obj, obj is on top of the stack
+	static void* getViewData(duk_context* ctx, const char* name) {
+		duk_get_prop_string(ctx, -1, name);
+		void* data = duk_get_buffer_data(ctx, -1, nullptr);
+		duk_pop(ctx);
+		return data;
+	}
+
+	// one call with all matching entities, transforms are gathered before the call and changed ones are written back after it
+	// the update can add or remove systems, so system is not used after the call
+	void updateSystem(SystemScript& system, float time_delta) {
+		profiler::pushString(system.script->getPath().c_str());
+		duk_context* ctx = m_heap->ctx;
+		JSWrapper::DebugGuard guard(ctx);
+		InstanceScope scope(*m_heap, this, system.id);
+
+		// the update can change the cached query
+		m_system_entities.clear();
+		const Array<i32>& entities = queryEntities(Span(system.types, system.type_count));
+		if (!entities.empty()) m_system_entities.resize(entities.size());
+		if (!entities.empty()) memcpy(m_system_entities.begin(), entities.begin(), entities.size() * sizeof(i32));
+		const u32 count = m_system_entities.size();
+
+		duk_push_global_stash(ctx);
+		if (!duk_get_prop_string(ctx, -1, SYSTEMS_KEY)) {
+			duk_pop(ctx);
+			duk_push_object(ctx);
+			duk_dup(ctx, -1);
+			duk_put_prop_string(ctx, -3, SYSTEMS_KEY);
+		}
+		// [stash, systems]
+		if (!duk_get_prop_index(ctx, -1, system.views_id) || system.views_count != count) {
+			// views are created only when the number of entities changes
+			duk_pop(ctx);
+			duk_push_object(ctx);
+			createSystemViews(ctx, count, system.transforms);
+			duk_dup(ctx, -1);
+			duk_put_prop_index(ctx, -3, system.views_id);
+			system.views_count = count;
+		}
+		// [stash, systems, state]
+
+		if (count > 0) memcpy(getViewData(ctx, "entities"), m_system_entities.begin(), count * sizeof(i32));
+		const bool transforms = system.transforms;
+		double* positions = nullptr;
+		float* rotations = nullptr;
+		float* scales = nullptr;
+		if (transforms) {
+			duk_get_prop_string(ctx, -1, "transforms");
+			positions = (double*)getViewData(ctx, "positions");
+			rotations = (float*)getViewData(ctx, "rotations");
+			scales = (float*)getViewData(ctx, "scales");
+			duk_pop(ctx);
+
+			m_system_transforms.clear();
+			m_system_transforms.reserve(count);
+			for (u32 i = 0; i < count; ++i) {
+				const Transform& tr = m_world.getTransform({m_system_entities[i]});
+				m_system_transforms.push(tr);
+				memcpy(positions + i * 3, &tr.pos, sizeof(double) * 3);
+				memcpy(rotations + i * 4, &tr.rot, sizeof(float) * 4);
+				memcpy(scales + i * 3, &tr.scale, sizeof(float) * 3);
+			}
+		}
+
+		duk_push_pointer(ctx, (void*)system.id);
+		duk_get_prop(ctx, -4);                    // [stash, systems, state, this]
+		duk_get_prop_string(ctx, -1, "update");   // [stash, systems, state, this, func]
+		duk_dup(ctx, -2);                         // [stash, systems, state, this, func, this]
+		duk_push_number(ctx, time_delta);
+		duk_get_prop_string(ctx, -5, "entities");
+		duk_get_prop_string(ctx, -6, "transforms");
+		if (duk_pcall_method(ctx, 3) == DUK_EXEC_ERROR) {
+			const char* error = duk_safe_to_string(ctx, -1);
+			logError(error);
+		}
+		// the state keeps the views alive even if the update removed the system
+		duk_pop_2(ctx); // [stash, systems, state]
+
+		JSCommandBuffer* commands = m_heap->commands;
+		for (u32 i = 0; transforms && i < count; ++i) {
+			const EntityRef e = {m_system_entities[i]};
+			if (!m_world.hasEntity(e)) continue;
+
+			const Transform& prev = m_system_transforms[i];
+			if (memcmp(positions + i * 3, &prev.pos, sizeof(double) * 3) != 0) {
+				const DVec3 pos(positions[i * 3], positions[i * 3 + 1], positions[i * 3 + 2]);
+				if (commands) commands->setPosition(e, pos);
+				else m_world.setPosition(e, pos);
+			}
+			if (memcmp(rotations + i * 4, &prev.rot, sizeof(float) * 4) != 0) {
+				const Quat rot(rotations[i * 4], rotations[i * 4 + 1], rotations[i * 4 + 2], rotations[i * 4 + 3]);
+				if (commands) commands->setRotation(e, rot);
+				else m_world.setRotation(e, rot);
+			}
+			if (memcmp(scales + i * 3, &prev.scale, sizeof(float) * 3) != 0) {
+				const Vec3 scale(scales[i * 3], scales[i * 3 + 1], scales[i * 3 + 2]);
+				if (commands) commands->setScale(e, scale);
+				else m_world.setScale(e, scale);
+			}
+		}
+		duk_pop_3(ctx);
+	}
+
+	void updateSystems(float time_delta) {
+		if (m_system_scripts.empty()) return;
+
+		PROFILE_FUNCTION();
+		// systems can add or remove systems
+		m_updating_systems = true;
+		for (i32 i = 0; i < m_system_scripts.size(); ++i) {
+			SystemScript& system = m_system_scripts[i];
+			if (system.failed || system.removed) continue;
+			if (!system.started) {
+				if (system.script->isFailure()) {
+					logError("Failed to load system ", system.script->getPath());
+					system.failed = true;
+					continue;
+				}
+				if (!system.script->isReady()) continue;
+				system.started = true;
+				// entries are not erased during the loop, but the script's code can add systems and move them
+				const bool started = startSystem(i);
+				m_system_scripts[i].failed = !started;
+				if (!started) continue;
+
+				{
+					InstanceScope scope(*m_heap, this, m_system_scripts[i].id);
+					callSystemMethod(m_system_scripts[i], "start");
+				}
+				if (m_system_scripts[i].removed) continue;
+			}
+			updateSystem(m_system_scripts[i], time_delta);
+		}
+		m_updating_systems = false;
+
+		for (i32 i = m_system_scripts.size() - 1; i >= 0; --i) {
+			if (!m_system_scripts[i].removed) continue;
+			m_system_scripts[i].script->decRefCount();
+			m_system_scripts.erase(i);
+		}
+	}
+
+	JSComponentStore* findComponentStore(const char* name) const {
+		for (JSComponentStore* store : m_component_stores) {
+			if (equalStrings(store->getName(), name)) return store;
+		}
+		return nullptr;
+	}
+
+	// [] -> [object], the object is created on first use
+	void pushComponentStore(JSComponentStore& store) {
+		duk_context* ctx = m_heap->ctx;
+		duk_push_global_stash(ctx);
+		if (!duk_get_prop_string(ctx, -1, COMPONENT_STORES_KEY)) {
+			duk_pop(ctx);
+			duk_push_object(ctx);
+			duk_dup(ctx, -1);
+			duk_put_prop_string(ctx, -3, COMPONENT_STORES_KEY);
+		}
+		duk_push_pointer(ctx, &store);
+		if (!duk_get_prop(ctx, -2)) {
+			duk_pop(ctx);
+			store.createObject(ctx);
+			duk_push_pointer(ctx, &store);
+			duk_dup(ctx, -2);
+			duk_put_prop(ctx, -4);
+		}
+		duk_replace(ctx, -3);
+		duk_pop(ctx);
+	}
+
+	// takes ownership of store, pushes the store's object or returns an error
+	const char* defineComponent(JSComponentStore* store) {
+		JSComponentStore* existing = findComponentStore(store->getName());
+		if (existing) {
+			const bool same = existing->hasSameColumns(*store);
+			LUMIX_DELETE(m_system.m_allocator, store);
+			if (!same) return "component is already defined with other columns";
+			store = existing;
+		}
+		else {
+			m_component_stores.push(store);
+		}
+		pushComponentStore(*store);
+		return nullptr;
+	}
+
+	void onEntityDestroyed(EntityRef entity) {
+		if (!m_name_index_dirty) {
+			// another entity can have the same name
+			auto iter = m_name_index.find(RuntimeHash(m_world.getEntityName(entity)));
+			if (iter.isValid() && iter.value() == entity) m_name_index_dirty = true;
+		}
+		for (i32 i = m_tweens.size() - 1; i >= 0; --i) {
+			if (m_tweens[i].entity == entity) removeTween(i);
+		}
+		// workers record only while updateWorkers runs its jobs, entities are not destroyed then
+		m_commands.removeEntity(entity);
+		for (Worker& worker : m_workers) worker.commands.removeEntity(entity);
+		for (JSComponentStore* store : m_component_stores) {
+			if (store->getRow(entity) < 0) continue;
+			pushComponentStore(*store);
+			store->remove(m_heap->ctx, -1, entity);
+			duk_pop(m_heap->ctx);
+		}
+	}
+
+	// objects can outlive the module in the shared heap, they are detached
+	void destroyComponentStores() {
+		duk_context* ctx = m_heap->ctx;
+		for (JSComponentStore* store : m_component_stores) {
+			pushComponentStore(*store);
+			store->detachObject(ctx, -1);
+			duk_pop(ctx);
+		}
+		duk_push_global_stash(ctx);
+		if (duk_get_prop_string(ctx, -1, COMPONENT_STORES_KEY)) {
+			for (JSComponentStore* store : m_component_stores) {
+				duk_push_pointer(ctx, store);
+				duk_del_prop(ctx, -2);
+			}
+		}
+		duk_pop_2(ctx);
+		for (JSComponentStore* store : m_component_stores) LUMIX_DELETE(m_system.m_allocator, store);
+		m_component_stores.clear();
+	}
+
+	void serializeComponentStores(OutputMemoryStream& serializer) {
+		serializer.write((u32)m_component_stores.size());
+		for (JSComponentStore* store : m_component_stores) {
+			store->serializeSchema(serializer);
+			pushComponentStore(*store);
+			store->serializeRows(m_heap->ctx, -1, serializer);
+			duk_pop(m_heap->ctx);
+		}
+	}
+
+	void deserializeComponentStores(InputMemoryStream& serializer, const EntityMap& entity_map) {
+		const u32 count = serializer.read<u32>();
+		for (u32 i = 0; i < count; ++i) {
+			JSComponentStore* store = JSComponentStore::deserializeSchema(serializer, m_system.m_allocator);
+			if (!store) {
+				// sizes of the rows are unknown, so the rest can not be read
+				logError("Invalid script component in the world, it and the following ones are not loaded");
+				return;
+			}
+			JSComponentStore* existing = findComponentStore(store->getName());
+			if (existing && !existing->hasSameColumns(*store)) {
+				logError("Component ", store->getName(), " is already defined with other columns, its values are not loaded");
+				JSComponentStore::skipRows(serializer, *store);
+				LUMIX_DELETE(m_system.m_allocator, store);
+				continue;
+			}
+			if (existing) {
+				LUMIX_DELETE(m_system.m_allocator, store);
+				store = existing;
+			}
+			else {
+				m_component_stores.push(store);
+			}
+			pushComponentStore(*store);
+			store->deserializeRows(m_heap->ctx, -1, serializer, entity_map);
+			duk_pop(m_heap->ctx);
+		}
+	}
+
+	void onComponentChanged(const ComponentUID& cmp) {
+		for (EntityQuery& query : m_queries) {
+			if (query.dirty) continue;
+			for (u32 i = 0; i < query.type_count; ++i) {
+				if (query.types[i] == cmp.type) {
+					query.dirty = true;
+					break;
+				}
+			}
+		}
+	}
+
+	// entities with all the components, in the order of the world's entity list
+	const Array<i32>& queryEntities(Span<ComponentType> types) {
+		ASSERT(types.length() <= MAX_QUERY_COMPONENTS);
+		// same queries with a different order of types share the result
+		for (u32 i = 1; i < types.length(); ++i) {
+			for (u32 j = i; j > 0 && types[j].index < types[j - 1].index; --j) swap(types[j], types[j - 1]);
+		}
+
+		EntityQuery* query = nullptr;
+		for (EntityQuery& q : m_queries) {
+			if (q.type_count != types.length()) continue;
+			bool same = true;
+			for (u32 i = 0; i < q.type_count; ++i) same = same && q.types[i] == types[i];
+			if (same) {
+				query = &q;
+				break;
+			}
+		}
+
+		if (!query) {
+			query = &m_queries.emplace(m_system.m_allocator);
+			query->type_count = types.length();
+			for (u32 i = 0; i < types.length(); ++i) query->types[i] = types[i];
+			query->dirty = true;
+		}
+
+		if (query->dirty) {
+			PROFILE_BLOCK("rebuild query");
+			query->entities.clear();
+			for (EntityPtr e = m_world.getFirstEntity(); e.isValid(); e = m_world.getNextEntity(*e)) {
+				bool has_all = true;
+				for (u32 i = 0; i < query->type_count && has_all; ++i) has_all = m_world.hasComponent(*e, query->types[i]);
+				if (has_all) query->entities.push(e.index);
+			}
+			query->dirty = false;
+		}
+		return query->entities;
+	}
+
+	// new entities are usually named right after they are created, unnamed ones are checked again on the next lookup
+	void onEntityCreated(EntityRef entity) {
+		if (m_name_index_dirty) return;
+		const char* name = m_world.getEntityName(entity);
+		if (!name[0]) {
+			// not looked up for a long time, a rebuild is cheaper than growing the list
+			if (m_unnamed_entities.size() >= 4096) {
+				m_unnamed_entities.clear();
+				m_name_index_dirty = true;
+				return;
+			}
+			m_unnamed_entities.push(entity);
+			return;
+		}
+		const RuntimeHash hash(name);
+		if (!m_name_index.find(hash).isValid()) m_name_index.insert(hash, entity);
+	}
+
+	// entities named after they were created
+	void indexUnnamedEntities() {
+		for (EntityRef e : m_unnamed_entities) {
+			if (!m_world.hasEntity(e)) continue;
+			const char* name = m_world.getEntityName(e);
+			if (!name[0]) continue;
+			const RuntimeHash hash(name);
+			if (!m_name_index.find(hash).isValid()) m_name_index.insert(hash, e);
+		}
+		m_unnamed_entities.clear();
+	}
+
+	void renameEntity(EntityRef entity, const char* name) {
+		if (!m_name_index_dirty) {
+			auto iter = m_name_index.find(RuntimeHash(m_world.getEntityName(entity)));
+			if (iter.isValid() && iter.value() == entity) m_name_index_dirty = true;
+		}
+		m_world.setEntityName(entity, name);
+		if (!m_name_index_dirty && name[0] && !m_name_index.find(RuntimeHash(name)).isValid()) {
+			m_name_index.insert(RuntimeHash(name), entity);
+		}
+	}
+
+	void rebuildNameIndex() {
+		PROFILE_FUNCTION();
+		m_name_index.clear();
+		m_unnamed_entities.clear();
+		for (EntityPtr e = m_world.getFirstEntity(); e.isValid(); e = m_world.getNextEntity(*e)) {
+			const char* name = m_world.getEntityName(*e);
+			if (!name[0]) continue;
+			const RuntimeHash hash(name);
+			if (!m_name_index.find(hash).isValid()) m_name_index.insert(hash, *e);
+		}
+		m_name_index_dirty = false;
+	}
+
+	// an entity with the name, after a rebuild it's the first one in the order of the world's entity list
+	EntityPtr findEntityByName(const char* name) {
+		if (!name[0]) return INVALID_ENTITY;
+		const RuntimeHash hash(name);
+		if (m_name_index_dirty) rebuildNameIndex();
+		else indexUnnamedEntities();
+		auto iter = m_name_index.find(hash);
+		if (!iter.isValid()) return INVALID_ENTITY;
+		if (equalStrings(m_world.getEntityName(iter.value()), name)) return iter.value();
+
+		// renamed by something else than scripts
+		rebuildNameIndex();
+		iter = m_name_index.find(hash);
+		if (iter.isValid() && equalStrings(m_world.getEntityName(iter.value()), name)) return iter.value();
+		return INVALID_ENTITY;
+	}
+
+	void onContact(const PhysicsModule::ContactData& data) { m_contacts.push(data); }
+
+	// nullptr if the instance was removed, e.g. by a script called before
+	ScriptInstance* findInstance(EntityRef entity, uintptr id) {
+		auto iter = m_scripts.find(entity);
+		if (!iter.isValid() || !iter.value()) return nullptr;
+		for (ScriptInstance& inst : iter.value()->m_scripts) {
+			if (inst.m_id == id) return &inst;
+		}
+		return nullptr;
+	}
+
+	void onTrigger(EntityRef trigger, EntityRef other, bool touch_lost) { m_triggers.push({trigger, other, touch_lost}); }
+
+	// calls the hook of entity's scripts which define it, point is passed only to onContact
+	template <typename T>
+	void callPhysicsHook(EntityRef entity, PhysicsHook hook, const char* function, EntityRef other, const T* point) {
+		auto iter = m_scripts.find(entity);
+		if (!iter.isValid() || !iter.value()) return;
+
+		// hooks can remove scripts or destroy the entity, so each instance is looked up again before its call
+		// nested calls append after first and truncate back to it
+		const i32 first = m_hook_instances.size();
+		for (const ScriptInstance& inst : iter.value()->m_scripts) {
+			if (inst.m_physics_hooks & hook) m_hook_instances.push(inst.m_id);
+		}
+		for (i32 i = first; i < m_hook_instances.size(); ++i) {
+			// other can be destroyed before the event is dispatched or by a previous hook
+			if (!m_world.hasEntity(other)) break;
+			const ScriptInstance* inst = findInstance(entity, m_hook_instances[i]);
+			if (!inst || (inst->m_physics_hooks & hook) == 0) continue;
+
+			duk_context* ctx = getContext(*inst);
+			InstanceScope scope(getInstanceHeap(*inst), this, inst->m_id);
+			duk_push_global_stash(ctx);
+			duk_push_pointer(ctx, (void*)inst->m_id);
+			duk_get_prop(ctx, -2);                    // [stash, this]
+			if (!duk_is_object(ctx, -1)) {
+				duk_pop_2(ctx);
+				continue;
+			}
+			duk_get_prop_string(ctx, -1, function);   // [stash, this, func]
+			duk_dup(ctx, -2);                         // [stash, this, func, this]
+			JSWrapper::pushEntity(ctx, other, &m_world);
+			if (point) JSWrapper::push(ctx, *point);
+			if (duk_pcall_method(ctx, point ? 2 : 1) == DUK_EXEC_ERROR) {
+				const char* error = duk_safe_to_string(ctx, -1);
 				logError(error);
 			}
-			duk_pop_3(update_item.context);
+			duk_pop_3(ctx);
 		}
+		m_hook_instances.resize(first);
 	}
 
+	// contacts and triggers of this frame's simulation, both entities of each pair get it
+	void dispatchPhysicsEvents() {
+		if (m_contacts.empty() && m_triggers.empty()) return;
 
-	Property& getScriptProperty(EntityRef entity, int scr_index, const char* name) {
-		const StableHash name_hash(name);
-		ScriptComponent* script_cmp = m_scripts[entity];
-		for (auto& prop : script_cmp->m_scripts[scr_index].m_properties) {
-			if (prop.name_hash == name_hash) {
-				return prop;
-			}
+		PROFILE_FUNCTION();
+		profiler::pushInt("contacts", m_contacts.size());
+		if (m_deferred_writes) m_heap->commands = &m_commands;
+		// hooks can cause new contacts
+		for (i32 i = 0; i < m_contacts.size(); ++i) {
+			const PhysicsModule::ContactData contact = m_contacts[i];
+			callPhysicsHook(contact.e1, PhysicsHook::CONTACT, "onContact", contact.e2, &contact.position);
+			callPhysicsHook(contact.e2, PhysicsHook::CONTACT, "onContact", contact.e1, &contact.position);
 		}
+		for (i32 i = 0; i < m_triggers.size(); ++i) {
+			const TriggerEvent trigger = m_triggers[i];
+			const PhysicsHook hook = trigger.touch_lost ? PhysicsHook::TRIGGER_EXIT : PhysicsHook::TRIGGER_ENTER;
+			const char* function = trigger.touch_lost ? "onTriggerExit" : "onTriggerEnter";
+			callPhysicsHook<Vec3>(trigger.trigger, hook, function, trigger.other, nullptr);
+			callPhysicsHook<Vec3>(trigger.other, hook, function, trigger.trigger, nullptr);
+		}
+		m_contacts.clear();
+		m_triggers.clear();
+		if (m_deferred_writes) {
+			m_heap->commands = nullptr;
+			m_commands.apply(m_world);
+			m_commands.clear();
+		}
+	}
+
 
-		script_cmp->m_scripts[scr_index].m_properties.emplace(m_system.m_allocator);
-		auto& prop = script_cmp->m_scripts[scr_index].m_properties.back();
-		prop.name_hash = name_hash;
-		return prop;
+	// end of frame is a safe point for garbage collection
+	void lateUpdate(float time_delta) override {
+		if (m_is_game_running) dispatchPhysicsEvents();
+		m_system.updateGC(*m_heap);
+		for (Worker& worker : m_workers) m_system.updateGC(*worker.heap);
 	}
 
 
@@ -1208,33 +4130,77 @@ public:
 		out = tmp;
 	}
 
-	template <typename T> T getProperty(Property& prop, const char* prop_name, ScriptInstance& scr) {
-		if (!scr.m_script) return {};
-
-		duk_context* ctx = m_system.m_global_context;
-		duk_push_global_stash(ctx);
-		duk_push_pointer(ctx, (void*)scr.m_id);
-		duk_get_prop(ctx, -2);
-
-		duk_get_prop_string(ctx, -1, prop_name);
-
-		if (!JSWrapper::isType<T>(ctx, -1)) {
-			duk_pop_3(ctx);
-			InputMemoryStream blob(prop.stored_value);
-			return blob.read<T>();
-		}
-		const T res = JSWrapper::toType<T>(ctx, -1);
-		duk_pop_3(ctx);
-		return res;
-	}
-
 	JSScriptSystemImpl& m_system;
+	// destroyed after everything else, releasing all memory of the world's scripts at once
+	UniquePtr<JSHeap> m_own_heap;
+	// m_own_heap or the system's shared heap
+	JSHeap* m_heap;
 	HashMap<EntityRef, ScriptComponent*> m_scripts;
-	AssociativeArray<StableHash, String> m_property_names;
+	OutputMemoryStream m_values_scratch;
+	Array<TaggedValue> m_tagged_values;
+	Array<RowLayout> m_row_layouts;
+	Array<JSScriptModule::Property> m_row_layout_props;
 	World& m_world;
 	Array<ContextRef> m_input_handlers;
 	Array<ContextRef> m_updates;
 	FunctionCall m_function_call;
+	Array<Worker> m_workers;
+	u32 m_next_worker = 0;
+	// world writes from the module's heap, applied at the end of update
+	JSCommandBuffer m_commands;
+	bool m_deferred_writes = false;
+	// binary min-heap, cleared timers stay until they expire
+	Array<Timer> m_timers;
+	Array<Timer> m_expired_timers;
+	double m_time_ms = 0;
+	// id -> owner
+	HashMap<u32, uintptr> m_coroutines;
+	// binary min-heap by frame
+	Array<Timer> m_frame_waits;
+	Array<ResourceWait> m_resource_waits;
+	// resources coroutines waited for, released when the coroutine ends
+	Array<ResourceWait> m_coroutine_resources;
+	Array<SignalWait> m_signal_waits;
+	// in the order they were requested
+	Array<CoroutineWake> m_coroutine_wakes;
+	Array<u32> m_ready_coroutines;
+	bool m_resuming_woken = false;
+	u64 m_frame = 0;
+	Array<QueuedEvent> m_events;
+	Array<QueuedEvent> m_delivered_events;
+	// type -> index of the first event of the type in m_delivered_events
+	HashMap<RuntimeHash, i32> m_event_chains;
+	// sorted by owner, unless m_event_subscriptions_dirty is set
+	Array<EventSubscription> m_event_subscriptions;
+	bool m_event_subscriptions_dirty = false;
+	// bound while the game is running
+	PhysicsModule* m_physics_module = nullptr;
+	Array<PhysicsModule::ContactData> m_contacts;
+	Array<TriggerEvent> m_triggers;
+	// ids of instances whose physics hook is being called
+	Array<uintptr> m_hook_instances;
+	// ring buffer, m_message_count messages from m_message_head
+	Array<Message> m_messages;
+	u32 m_message_head = 0;
+	u32 m_message_count = 0;
+	Array<Message> m_delivered_messages;
+	Array<MessageReceiver> m_message_receivers;
+	Array<EntityQuery> m_queries;
+	// unordered, see Lumix.tween
+	Array<Tween> m_tweens;
+	Array<Tween> m_finished_tweens;
+	// name -> first entity with the name, see findEntityByName
+	HashMap<RuntimeHash, EntityRef> m_name_index;
+	// created without a name since the last lookup
+	Array<EntityRef> m_unnamed_entities;
+	bool m_name_index_dirty = true;
+	Array<SystemScript> m_system_scripts;
+	bool m_updating_systems = false;
+	// entities and transforms passed to the updated system script, to find what it changed
+	Array<i32> m_system_entities;
+	Array<Transform> m_system_transforms;
+	// see Lumix.defineComponent
+	Array<JSComponentStore*> m_component_stores;
 	ScriptInstance* m_current_script_instance;
 	bool m_scripts_init_called = false;
 	bool m_is_api_registered = false;
@@ -1242,6 +4208,12 @@ public:
 	uintptr m_id_generator = 0;
 };
 
+static void renameEntity(World& world, EntityRef entity, const char* name) {
+	IModule* module = world.getModule(JS_SCRIPT_TYPE);
+	if (module) static_cast<JSScriptModuleImpl*>(module)->renameEntity(entity, name);
+	else world.setEntityName(entity, name);
+}
+
 static void js_fatalHandler(void *udata, const char *msg) {
 	logError("*** JS FATAL ERROR: ", (msg ? msg : "no message"));
 	abort();
@@ -1251,21 +4223,70 @@ JSScriptSystemImpl::JSScriptSystemImpl(Engine& engine)
 	: m_engine(engine)
 	, m_allocator(engine.getAllocator())
 	, m_script_manager(m_allocator)
+	, m_heap(m_allocator)
+	, m_parallel_readable(m_allocator)
+	, m_compute_jobs(engine.getFileSystem(), m_allocator, &registerComputeAPI, js_fatalHandler)
 {
 	s_instance = this;
 	m_script_manager.create(JSScript::TYPE, engine.getResourceManager());
 
-	// TODO allocator
-	m_global_context = duk_create_heap(nullptr, nullptr, nullptr, nullptr, js_fatalHandler);
+	createHeap(m_heap);
+	m_heap_live_counter = profiler::createCounter("JS heap live (KB)", 0);
+	m_heap_reserved_counter = profiler::createCounter("JS heap reserved (KB)", 0);
+	m_gc_pause_counter = profiler::createCounter("JS GC pause (ms)", 0);
 
 	#include "js_script_system.gen.h"
 }
 
 void registerJSAPI(duk_context* ctx);
 
+void JSScriptSystemImpl::createHeap(JSHeap& heap) {
+	heap.ctx = duk_create_heap(&JSAllocator::dukAlloc, &JSAllocator::dukRealloc, &JSAllocator::dukFree, &heap.allocator, js_fatalHandler);
+	duk_push_global_stash(heap.ctx);
+	duk_push_pointer(heap.ctx, &heap);
+	duk_put_prop_string(heap.ctx, -2, HEAP_KEY);
+	duk_pop(heap.ctx);
+}
+
+void JSScriptSystemImpl::collectGarbage(JSHeap& heap, bool compact) {
+	PROFILE_FUNCTION();
+	os::Timer timer;
+	duk_gc(heap.ctx, compact ? DUK_GC_COMPACT : 0);
+	const float pause_ms = timer.getTimeSinceStart() * 1000;
+
+	JSGCStats& stats = heap.gc_stats;
+	++stats.collections;
+	stats.last_pause_ms = pause_ms;
+	stats.max_pause_ms = maximum(stats.max_pause_ms, pause_ms);
+	stats.total_pause_ms += pause_ms;
+	stats.live_bytes_after_gc = heap.allocator.getStats().live_bytes;
+	profiler::pushCounter(m_gc_pause_counter, pause_ms);
+}
+
+// refcounting frees most garbage immediately, collections are needed only for cycles
+// so we collect when the heap grew enough since the last collection and the last frame left time for the expected pause
+void JSScriptSystemImpl::updateGC(JSHeap& heap) {
+	const float frame_ms = heap.gc_frame_timer.tick() * 1000;
+	const JSAllocator::Stats& stats = heap.allocator.getStats();
+	const JSGCStats& gc = heap.gc_stats;
+	const u64 growth = stats.live_bytes > gc.live_bytes_after_gc ? stats.live_bytes - gc.live_bytes_after_gc : 0;
+	const u64 threshold = maximum((u64)4 * 1024 * 1024, gc.live_bytes_after_gc / 2);
+	if (growth < threshold) return;
+
+	const bool has_slack = frame_ms + gc.last_pause_ms <= m_gc_frame_budget_ms;
+	const bool must_collect = growth > threshold * 4;
+	if (has_slack || must_collect) collectGarbage(heap, false);
+}
+
+void JSScriptSystemImpl::pushHeapCounters(JSHeap& heap) {
+	const JSAllocator::Stats& stats = heap.allocator.getStats();
+	profiler::pushCounter(m_heap_live_counter, float(stats.live_bytes / 1024.0));
+	profiler::pushCounter(m_heap_reserved_counter, float(stats.reserved_bytes / 1024.0));
+}
+
 void JSScriptSystemImpl::initBegin() {
-	registerGlobalAPI();
-	registerJSAPI(m_global_context);
+	registerGlobalAPI(m_heap.ctx, false);
+	registerJSAPI(m_heap.ctx);
 }
 
 static void convertPropertyToJSName(const char* src, char* out, int max_size) {
@@ -1320,6 +4341,25 @@ static int JS_getProperty(duk_context* ctx) {
 	return 1;
 }
 
+// getters of components which are not whitelisted can touch state which is not safe to read from job threads
+template <typename T>
+static int JS_getWorkerProperty(duk_context* ctx) {
+	duk_push_this(ctx);
+	if (duk_is_null_or_undefined(ctx, -1)) {
+		duk_eval_error(ctx, "this is null or undefined");
+	}
+	duk_get_prop_string(ctx, -1, "c_cmptype");
+	const ComponentType cmp_type = { JSWrapper::toType<int>(ctx, -1) };
+	duk_pop_2(ctx);
+
+	const JSHeap& heap = getHeap(ctx);
+	if (!heap.readable || heap.readable->indexOf(cmp_type) < 0) {
+		const reflection::ComponentBase* cmp = reflection::getComponent(cmp_type);
+		return duk_error(ctx, DUK_ERR_ERROR, "%s can not be read by parallel scripts", cmp ? cmp->name : "component");
+	}
+	return JS_getProperty<T>(ctx);
+}
+
 template <typename T>
 static int JS_setProperty(duk_context* ctx) {
 	duk_push_this(ctx);
@@ -1347,7 +4387,9 @@ static int JS_setProperty(duk_context* ctx) {
 	cmp.type = cmp_type;
 	cmp.entity = entity;
 	const T v = JSWrapper::toType<T>(ctx, 0);
-	desc->set(cmp, -1, v);
+	JSCommandBuffer* commands = getCommandBuffer(ctx);
+	if (commands) commands->setProperty(cmp, *desc, v);
+	else desc->set(cmp, -1, v);
 
 	return 0;
 }
@@ -1358,14 +4400,15 @@ struct RegisterPropertyVisitor : reflection::IPropertyVisitor {
 		char tmp[50];
 		convertPropertyToJSName(prop.name, tmp, lengthOf(tmp));
 
-		duk_get_global_string(ctx, cmp_type_name);
+		duk_get_global_string(ctx, "LumixAPI");
+		duk_get_prop_string(ctx, -1, cmp_type_name);
 		if (duk_get_prop_string(ctx, -1, "prototype") != 1) {
 			ASSERT(false);
 		}
 
 		duk_push_string(ctx, tmp);
 
-		duk_push_c_function(ctx, JS_getProperty<T>, 0);
+		duk_push_c_function(ctx, is_worker ? JS_getWorkerProperty<T> : JS_getProperty<T>, 0);
 		JSWrapper::push(ctx, &prop);
 		duk_put_prop_string(ctx, -2, "c_desc");
 
@@ -1375,7 +4418,7 @@ struct RegisterPropertyVisitor : reflection::IPropertyVisitor {
 
 		duk_def_prop(ctx, -4, DUK_DEFPROP_HAVE_GETTER | DUK_DEFPROP_HAVE_SETTER | DUK_DEFPROP_ENUMERABLE);
 
-		duk_pop_2(ctx);
+		duk_pop_3(ctx);
 	}
 
 	void visit(const reflection::Property<float>& prop) override { reg(prop); }
@@ -1394,9 +4437,10 @@ struct RegisterPropertyVisitor : reflection::IPropertyVisitor {
 
 	const char* cmp_type_name;
 	duk_context* ctx;
+	bool is_worker;
 };
 
-static void registerComponent(duk_context* ctx, const char* cmp_type_name) {
+static void registerComponent(duk_context* ctx, const char* cmp_type_name, bool is_worker) {
 	auto cmp_type = reflection::getComponentType(cmp_type_name);
 	registerJSComponent(ctx, cmp_type, cmp_type_name, &componentJSConstructor);
 	
@@ -1405,12 +4449,57 @@ static void registerComponent(duk_context* ctx, const char* cmp_type_name) {
 	RegisterPropertyVisitor v;
 	v.cmp_type_name = cmp_type_name;
 	v.ctx = ctx;
+	v.is_worker = is_worker;
 
 	cmp->visit(v);
 }
 
-void JSScriptSystemImpl::registerImGuiAPI() {
-	duk_context* ctx = m_global_context;
+// float or vector property by its name in JS, e.g. "Intensity"
+struct TweenPropertyVisitor : reflection::IPropertyVisitor {
+	template <typename T>
+	void check(const reflection::Property<T>& prop, TweenTarget prop_target) {
+		if (property) return;
+		char tmp[50];
+		convertPropertyToJSName(prop.name, tmp, lengthOf(tmp));
+		if (!equalStrings(tmp, name)) return;
+		property = &prop;
+		target = prop_target;
+	}
+
+	void visit(const reflection::Property<float>& prop) override { check(prop, TweenTarget::FLOAT); }
+	void visit(const reflection::Property<int>& prop) override {}
+	void visit(const reflection::Property<u32>& prop) override {}
+	void visit(const reflection::Property<EntityPtr>& prop) override {}
+	void visit(const reflection::Property<Vec2>& prop) override { check(prop, TweenTarget::VEC2); }
+	void visit(const reflection::Property<Vec3>& prop) override { check(prop, TweenTarget::VEC3); }
+	void visit(const reflection::Property<IVec3>& prop) override {}
+	void visit(const reflection::Property<Vec4>& prop) override { check(prop, TweenTarget::VEC4); }
+	void visit(const reflection::Property<Path>& prop) override {}
+	void visit(const reflection::Property<bool>& prop) override {}
+	void visit(const reflection::Property<const char*>& prop) override {}
+	void visit(const reflection::ArrayProperty& prop) override {}
+	void visit(const reflection::BlobProperty& prop) override {}
+
+	const char* name;
+	const void* property = nullptr;
+	TweenTarget target;
+};
+
+// components built from reflection instead of the generated API, setters respect heap's command buffer
+static void registerReflectionAPI(duk_context* ctx, bool is_worker) {
+	JSWrapper::DebugGuard guard(ctx);
+	duk_push_object(ctx);
+	duk_dup(ctx, -1);
+	duk_put_global_string(ctx, "LumixAPI");
+
+	for (const reflection::RegisteredComponent& cmp : reflection::getComponents()) {
+		if (!cmp.cmp) continue;
+		registerComponent(ctx, cmp.cmp->name, is_worker);
+	}
+	duk_pop(ctx);
+}
+
+void JSScriptSystemImpl::registerImGuiAPI(duk_context* ctx) {
 	duk_push_object(ctx);
 	duk_dup(ctx, -1);
 	duk_put_global_string(ctx, "ImGui");
@@ -1460,7 +4549,7 @@ namespace JSAPI {
 
 int logError(duk_context* ctx) {
 	auto* msg = JSWrapper::toType<const char*>(ctx, 0);
-	Lumix::logError(msg);
+	reportError(getHeap(ctx), msg);
 	return 0;
 }
 
@@ -1468,7 +4557,16 @@ int require(duk_context* ctx) {
 	auto* path = JSWrapper::toType<const char*>(ctx, 0);
 	JSScriptSystemImpl* system = JSScriptSystemImpl::s_instance;
 
-	// TODO cache the object
+	// modules are evaluated once, the cache is cleared when the game stops
+	duk_push_global_stash(ctx);
+	if (!duk_get_prop_string(ctx, -1, REQUIRE_CACHE)) {
+		duk_pop(ctx);
+		duk_push_object(ctx);
+		duk_dup(ctx, -1);
+		duk_put_prop_string(ctx, -3, REQUIRE_CACHE);
+	}
+	if (duk_get_prop_string(ctx, -1, path)) return 1;
+	duk_pop_3(ctx);
 
 	ResourceManagerHub& rm = system->m_engine.getResourceManager();
 	FileSystem& fs = system->m_engine.getFileSystem();
@@ -1490,33 +4588,528 @@ int require(duk_context* ctx) {
 	}
 
 	// TODO what if there's no return value
+	if (!duk_is_undefined(ctx, -1)) {
+		duk_push_global_stash(ctx);
+		duk_get_prop_string(ctx, -1, REQUIRE_CACHE);
+		duk_dup(ctx, -3);
+		duk_put_prop_string(ctx, -2, path);
+		duk_pop_2(ctx);
+	}
 	return 1;
 }
 
-} // namespace JSAPI
+// array with a type hint for property detection, missing w of colors and quaternions is 1
+static int pushTypedVector(duk_context* ctx, JSScriptModule::Property::Type type) {
+	const bool is_vec = type == JSScriptModule::Property::VEC2 || type == JSScriptModule::Property::VEC3 || type == JSScriptModule::Property::VEC4;
+	duk_push_array(ctx);
+	for (u32 i = 0, c = getVectorSize(type); i < c; ++i) {
+		duk_push_number(ctx, duk_get_number_default(ctx, i, i == 3 && !is_vec ? 1 : 0));
+		duk_put_prop_index(ctx, -2, i);
+	}
+	duk_push_int(ctx, type);
+	duk_put_prop_string(ctx, -2, "c_property_type");
+	return 1;
+}
+
+int color(duk_context* ctx) {
+	return pushTypedVector(ctx, JSScriptModule::Property::COLOR);
+}
+
+int quat(duk_context* ctx) {
+	return pushTypedVector(ctx, JSScriptModule::Property::QUAT);
+}
+
+int vec2(duk_context* ctx) {
+	return pushTypedVector(ctx, JSScriptModule::Property::VEC2);
+}
+
+int vec3(duk_context* ctx) {
+	return pushTypedVector(ctx, JSScriptModule::Property::VEC3);
+}
+
+int vec4(duk_context* ctx) {
+	return pushTypedVector(ctx, JSScriptModule::Property::VEC4);
+}
+
+int resource(duk_context* ctx) {
+	auto* path = JSWrapper::toType<const char*>(ctx, 0);
+	auto* type = JSWrapper::toType<const char*>(ctx, 1);
+	duk_push_object(ctx);
+	duk_push_int(ctx, JSScriptModule::Property::RESOURCE);
+	duk_put_prop_string(ctx, -2, "c_property_type");
+	duk_push_string(ctx, type);
+	duk_put_prop_string(ctx, -2, "c_resource_type");
+	duk_push_string(ctx, path);
+	duk_put_prop_string(ctx, -2, "path");
+	return 1;
+}
+
+int gcCollect(duk_context* ctx) {
+	const bool compact = duk_get_boolean_default(ctx, 0, false);
+	JSScriptSystemImpl::s_instance->collectGarbage(getHeap(ctx), compact);
+	return 0;
+}
+
+static int addTimer(duk_context* ctx, bool repeat) {
+	JSHeap& heap = getHeap(ctx);
+	if (!heap.module) return duk_error(ctx, DUK_ERR_ERROR, "timers can be created only by scripts");
+	if (!duk_is_function(ctx, 0)) return DUK_RET_TYPE_ERROR;
+
+	const double delay_ms = maximum(duk_get_number_default(ctx, 1, 0), 0.0);
+	duk_push_uint(ctx, heap.module->addTimer(ctx, 0, delay_ms, repeat, heap.instance));
+	return 1;
+}
+
+int setTimeout(duk_context* ctx) {
+	return addTimer(ctx, false);
+}
+
+int setInterval(duk_context* ctx) {
+	return addTimer(ctx, true);
+}
+
+int clearTimeout(duk_context* ctx) {
+	JSHeap& heap = getHeap(ctx);
+	if (heap.module && duk_is_number(ctx, 0)) heap.module->clearTimer(ctx, duk_get_uint(ctx, 0));
+	return 0;
+}
+
+int startCoroutine(duk_context* ctx) {
+	JSHeap& heap = getHeap(ctx);
+	if (!heap.module) return duk_error(ctx, DUK_ERR_ERROR, "coroutines can be started only by scripts");
+	if (!duk_is_function(ctx, 0)) return DUK_RET_TYPE_ERROR;
+
+	duk_push_uint(ctx, heap.module->startCoroutine(ctx, 0, heap.instance));
+	return 1;
+}
+
+int stopCoroutine(duk_context* ctx) {
+	JSHeap& heap = getHeap(ctx);
+	if (heap.module && duk_is_number(ctx, 0)) heap.module->stopCoroutine(ctx, duk_get_uint(ctx, 0));
+	return 0;
+}
+
+int signal(duk_context* ctx) {
+	JSHeap& heap = getHeap(ctx);
+	if (!heap.module) return duk_error(ctx, DUK_ERR_ERROR, "signals can be sent only by scripts");
+	auto* name = JSWrapper::toType<const char*>(ctx, 0);
+	duk_dup(ctx, 1);
+	heap.module->signal(ctx, name);
+	return 0;
+}
+
+int subscribe(duk_context* ctx) {
+	JSHeap& heap = getHeap(ctx);
+	if (!heap.module) return duk_error(ctx, DUK_ERR_ERROR, "events can be subscribed only by scripts");
+	auto* type = JSWrapper::toType<const char*>(ctx, 0);
+	if (!duk_is_function(ctx, 1)) return DUK_RET_TYPE_ERROR;
+	const EntityPtr entity = duk_is_object(ctx, 2) ? JSWrapper::toType<EntityPtr>(ctx, 2) : INVALID_ENTITY;
+
+	duk_push_uint(ctx, heap.module->subscribeEvent(ctx, type, entity, 1, heap.instance));
+	return 1;
+}
+
+int unsubscribe(duk_context* ctx) {
+	JSHeap& heap = getHeap(ctx);
+	if (heap.module && duk_is_number(ctx, 0)) heap.module->unsubscribeEvent(ctx, duk_get_uint(ctx, 0));
+	return 0;
+}
+
+int send(duk_context* ctx) {
+	JSHeap& heap = getHeap(ctx);
+	if (!heap.module) return duk_error(ctx, DUK_ERR_ERROR, "messages can be sent only by scripts");
+	const EntityPtr entity = JSWrapper::toType<EntityPtr>(ctx, 0);
+	auto* name = JSWrapper::toType<const char*>(ctx, 1);
+	if (!entity.isValid()) return DUK_RET_RANGE_ERROR;
+
+	heap.module->sendMessage(ctx, entity, name, 2);
+	return 0;
+}
 
-void JSScriptSystemImpl::registerGlobalAPI() {
-	registerImGuiAPI();
+int broadcast(duk_context* ctx) {
+	JSHeap& heap = getHeap(ctx);
+	if (!heap.module) return duk_error(ctx, DUK_ERR_ERROR, "messages can be sent only by scripts");
+	auto* name = JSWrapper::toType<const char*>(ctx, 0);
+
+	heap.module->sendMessage(ctx, INVALID_ENTITY, name, 1);
+	return 0;
+}
+
+int addSystem(duk_context* ctx) {
+	JSHeap& heap = getHeap(ctx);
+	if (!heap.module) return duk_error(ctx, DUK_ERR_ERROR, "systems can be added only by scripts");
+	auto* path = JSWrapper::toType<const char*>(ctx, 0);
+	heap.module->addSystem(Path(path));
+	return 0;
+}
+
+int removeSystem(duk_context* ctx) {
+	JSHeap& heap = getHeap(ctx);
+	if (!heap.module) return duk_error(ctx, DUK_ERR_ERROR, "systems can be removed only by scripts");
+	auto* path = JSWrapper::toType<const char*>(ctx, 0);
+	heap.module->removeSystem(Path(path));
+	return 0;
+}
+
+// Lumix.defineComponent("health", {hp: "f32", team: "u8"})
+int defineComponent(duk_context* ctx) {
+	JSHeap& heap = getHeap(ctx);
+	if (!heap.module) return duk_error(ctx, DUK_ERR_ERROR, "components can be defined only by scripts");
+	auto* name = JSWrapper::toType<const char*>(ctx, 0);
+	if (!duk_is_object(ctx, 1)) return DUK_RET_TYPE_ERROR;
+	if (stringLength(name) > JSComponentStore::MAX_NAME_LENGTH) {
+		return duk_error(ctx, DUK_ERR_RANGE_ERROR, "%s: name is longer than %d characters", name, (int)JSComponentStore::MAX_NAME_LENGTH);
+	}
+
+	IAllocator& allocator = JSScriptSystemImpl::s_instance->m_allocator;
+	JSComponentStore* store = LUMIX_NEW(allocator, JSComponentStore)(name, allocator);
+	const char* error = nullptr;
+	duk_enum(ctx, 1, DUK_ENUM_OWN_PROPERTIES_ONLY);
+	while (!error && duk_next(ctx, -1, 1)) {
+		const char* column = duk_get_string(ctx, -2);
+		const char* type_name = duk_get_string(ctx, -1);
+		JSComponentStore::Type type;
+		if (!type_name || !JSComponentStore::parseType(type_name, type)) error = "unknown column type, expected i8, u8, i16, u16, i32, u32, f32 or f64";
+		else if (!store->addColumn(column, type)) error = "duplicate column name or name longer than 31 characters";
+		duk_pop_2(ctx);
+	}
+	duk_pop(ctx);
+	if (!error) error = heap.module->defineComponent(store);
+	else LUMIX_DELETE(allocator, store);
+	if (error) return duk_error(ctx, DUK_ERR_TYPE_ERROR, "%s: %s", name, error);
+	return 1;
+}
+
+// data of a typed array of the global type, e.g. Float32Array, nullptr if it's something else
+template <typename T>
+static T* getTypedArray(duk_context* ctx, duk_idx_t idx, const char* type, u32& count) {
+	count = 0;
+	if (!duk_is_object(ctx, idx)) return nullptr;
+	duk_get_global_string(ctx, type);
+	const bool is_type = duk_instanceof(ctx, idx, -1);
+	duk_pop(ctx);
+	if (!is_type) return nullptr;
+	duk_size_t size;
+	T* data = (T*)duk_get_buffer_data(ctx, idx, &size);
+	count = u32(size / sizeof(T));
+	return data;
+}
+
+// Lumix.physics.raycastBatch(world, origins, dirs, max_dist, out, layer), out is {entities, distances, normals}, distances and normals are optional
+// origins is Float64Array and dirs Float32Array with x, y, z of each ray, returns the number of hits
+// the world is passed explicitly, so systems and top-level code can cast rays too
+int raycastBatch(duk_context* ctx) {
+	if (!duk_is_object(ctx, 0)) return duk_error(ctx, DUK_ERR_TYPE_ERROR, "world expected");
+	duk_get_prop_string(ctx, 0, "c_ptr");
+	World* world = (World*)duk_get_pointer(ctx, -1);
+	duk_pop(ctx);
+	auto* physics = world ? static_cast<PhysicsModule*>(world->getModule("physics")) : nullptr;
+	if (!physics) return duk_error(ctx, DUK_ERR_ERROR, "world has no physics module");
+
+	u32 origins_count, dirs_count;
+	const double* origins = getTypedArray<double>(ctx, 1, "Float64Array", origins_count);
+	const float* dirs = getTypedArray<float>(ctx, 2, "Float32Array", dirs_count);
+	if (!origins || !dirs) return duk_error(ctx, DUK_ERR_TYPE_ERROR, "origins must be Float64Array and dirs Float32Array");
+	const float max_dist = (float)duk_require_number(ctx, 3);
+	if (!duk_is_object(ctx, 4)) return DUK_RET_TYPE_ERROR;
+	const i32 layer = duk_get_int_default(ctx, 5, -1);
+
+	u32 entities_count, distances_count = 0, normals_count = 0;
+	duk_get_prop_string(ctx, 4, "entities");
+	i32* entities = getTypedArray<i32>(ctx, -1, "Int32Array", entities_count);
+	duk_get_prop_string(ctx, 4, "distances");
+	float* distances = getTypedArray<float>(ctx, -1, "Float32Array", distances_count);
+	duk_get_prop_string(ctx, 4, "normals");
+	float* normals = getTypedArray<float>(ctx, -1, "Float32Array", normals_count);
+	duk_pop_3(ctx);
+	if (!entities) return duk_error(ctx, DUK_ERR_TYPE_ERROR, "out.entities must be Int32Array");
+
+	const u32 count = minimum(origins_count, dirs_count) / 3;
+	if (entities_count < count || (distances && distances_count < count) || (normals && normals_count < count * 3)) {
+		return duk_error(ctx, DUK_ERR_RANGE_ERROR, "out arrays are too short for %d rays", (i32)count);
+	}
+
+	PROFILE_FUNCTION();
+	profiler::pushInt("rays", count);
+	u32 hits = 0;
+	for (u32 i = 0; i < count; ++i) {
+		const DVec3 origin(origins[i * 3], origins[i * 3 + 1], origins[i * 3 + 2]);
+		const Vec3 dir(dirs[i * 3], dirs[i * 3 + 1], dirs[i * 3 + 2]);
+		RaycastHit hit;
+		if (physics->raycastEx(origin, dir, max_dist, hit, INVALID_ENTITY, layer) && hit.entity.isValid()) {
+			entities[i] = hit.entity.index;
+			if (distances) distances[i] = (float)length(DVec3(hit.position) - origin);
+			if (normals) memcpy(normals + i * 3, &hit.normal, sizeof(float) * 3);
+			++hits;
+		}
+		else {
+			entities[i] = INVALID_ENTITY.index;
+			if (distances) distances[i] = -1;
+			if (normals) memset(normals + i * 3, 0, sizeof(float) * 3);
+		}
+	}
+	duk_push_uint(ctx, hits);
+	return 1;
+}
+
+// Lumix.tween(entity, "position", [0, 5, 0], 2, "outQuad", callback), easing and callback are optional
+// component properties are "component.Property", e.g. "point_light.Intensity", returns tween id
+int tween(duk_context* ctx) {
+	JSHeap& heap = getHeap(ctx);
+	if (!heap.module) return duk_error(ctx, DUK_ERR_ERROR, "tweens can be created only by scripts");
+	if (!duk_is_object(ctx, 0)) return DUK_RET_TYPE_ERROR;
+	const EntityRef entity = JSWrapper::toType<EntityRef>(ctx, 0);
+	const char* property = JSWrapper::toType<const char*>(ctx, 1);
+	World& world = heap.module->getWorld();
+	if (!world.hasEntity(entity)) return duk_error(ctx, DUK_ERR_ERROR, "invalid entity");
+
+	JSScriptModuleImpl::Tween tween = {};
+	tween.entity = entity;
+	tween.owner = heap.instance;
+	if (equalStrings(property, "position")) tween.target = TweenTarget::POSITION;
+	else if (equalStrings(property, "rotation")) tween.target = TweenTarget::ROTATION;
+	else if (equalStrings(property, "scale")) tween.target = TweenTarget::SCALE;
+	else {
+		const char* dot = property;
+		while (*dot && *dot != '.') ++dot;
+		StaticString<64> cmp_name;
+		if (*dot) copyString(Span(cmp_name.data), StringView(property, dot));
+		if (!*dot || !reflection::componentTypeExists(cmp_name)) return duk_error(ctx, DUK_ERR_TYPE_ERROR, "unknown property %s", property);
+		tween.cmp_type = reflection::getComponentType(cmp_name);
+		if (!world.hasComponent(entity, tween.cmp_type)) return duk_error(ctx, DUK_ERR_ERROR, "entity has no %s", (const char*)cmp_name);
+
+		TweenPropertyVisitor visitor;
+		visitor.name = dot + 1;
+		reflection::getComponent(tween.cmp_type)->visit(visitor);
+		if (!visitor.property) return duk_error(ctx, DUK_ERR_TYPE_ERROR, "%s is not a float or vector property", property);
+		tween.property = visitor.property;
+		tween.target = visitor.target;
+		tween.module = world.getModule(tween.cmp_type);
+	}
+
+	const u32 count = JSScriptModuleImpl::getTweenValueCount(tween.target);
+	if (count == 1) {
+		tween.to[0] = duk_require_number(ctx, 2);
+	}
+	else {
+		if (!duk_is_object(ctx, 2)) return duk_error(ctx, DUK_ERR_TYPE_ERROR, "target must be an array of %d numbers", (i32)count);
+		for (u32 i = 0; i < count; ++i) {
+			duk_get_prop_index(ctx, 2, i);
+			tween.to[i] = duk_get_number_default(ctx, -1, 0);
+			duk_pop(ctx);
+		}
+	}
+	tween.duration = (float)maximum(duk_get_number_default(ctx, 3, 0), 0.0);
+
+	tween.easing = Easing::LINEAR;
+	if (duk_is_string(ctx, 4)) {
+		const char* easing = duk_get_string(ctx, 4);
+		u32 i = 0;
+		while (i < lengthOf(EASING_NAMES) && !equalStrings(EASING_NAMES[i], easing)) ++i;
+		if (i == lengthOf(EASING_NAMES)) return duk_error(ctx, DUK_ERR_TYPE_ERROR, "unknown easing %s", easing);
+		tween.easing = (Easing)i;
+	}
+
+	duk_push_uint(ctx, heap.module->addTween(ctx, tween, 5));
+	return 1;
+}
+
+int cancelTween(duk_context* ctx) {
+	JSHeap& heap = getHeap(ctx);
+	if (heap.module && duk_is_number(ctx, 0)) heap.module->cancelTween(duk_get_uint(ctx, 0));
+	return 0;
+}
+
+int jobsRun(duk_context* ctx) {
+	auto* path = JSWrapper::toType<const char*>(ctx, 0);
+	auto* function = JSWrapper::toType<const char*>(ctx, 1);
+	if (!duk_is_function(ctx, 3)) return DUK_RET_TYPE_ERROR;
+	// the module delivers the results
+	JSHeap& heap = getHeap(ctx);
+	if (!heap.module) return duk_error(ctx, DUK_ERR_ERROR, "jobs.run called outside of a world");
+	if (stringLength(function) > JSComputeJobs::MAX_FUNCTION_NAME_LENGTH) {
+		return duk_error(ctx, DUK_ERR_RANGE_ERROR, "function name %s is longer than %d characters", function, (int)JSComputeJobs::MAX_FUNCTION_NAME_LENGTH);
+	}
+
+	duk_dup(ctx, 2);
+	duk_cbor_encode(ctx, -1, 0);
+	duk_size_t size;
+	const u8* payload = (const u8*)duk_get_buffer_data(ctx, -1, &size);
+	const u32 id = JSScriptSystemImpl::s_instance->m_compute_jobs.run(heap.module, ctx, path, function, Span(payload, (u32)size), 3);
+	if (id == 0) return duk_error(ctx, DUK_ERR_ERROR, "failed to read %s.js", path);
+
+	duk_push_uint(ctx, id);
+	return 1;
+}
+
+// world.query(["rigid_actor", "model_instance"], {name, center, radius}), filter is optional
+int worldQuery(duk_context* ctx) {
+	duk_push_this(ctx);
+	duk_get_prop_string(ctx, -1, "c_ptr");
+	World* world = (World*)duk_get_pointer(ctx, -1);
+	duk_pop_2(ctx);
+	IModule* module = world ? world->getModule(JS_SCRIPT_TYPE) : nullptr;
+	if (!module) return duk_error(ctx, DUK_ERR_ERROR, "world has no js_script module");
+	if (!duk_is_array(ctx, 0)) return DUK_RET_TYPE_ERROR;
+
+	ComponentType types[JSScriptModuleImpl::MAX_QUERY_COMPONENTS];
+	const u32 type_count = (u32)duk_get_length(ctx, 0);
+	if (type_count == 0 || type_count > lengthOf(types)) {
+		return duk_error(ctx, DUK_ERR_RANGE_ERROR, "query needs 1 to %d components", (i32)lengthOf(types));
+	}
+	for (u32 i = 0; i < type_count; ++i) {
+		duk_get_prop_index(ctx, 0, i);
+		const char* name = duk_get_string(ctx, -1);
+		if (!name || !reflection::componentTypeExists(name)) return duk_error(ctx, DUK_ERR_TYPE_ERROR, "unknown component %s", name ? name : "");
+		types[i] = reflection::getComponentType(name);
+		duk_pop(ctx);
+	}
+
+	const char* name = nullptr;
+	DVec3 center;
+	double radius = -1;
+	if (duk_is_object(ctx, 1)) {
+		if (duk_get_prop_string(ctx, 1, "name")) name = duk_get_string(ctx, -1);
+		duk_pop(ctx);
+		if (duk_get_prop_string(ctx, 1, "radius")) radius = duk_get_number(ctx, -1);
+		duk_pop(ctx);
+		if (radius >= 0) {
+			if (!duk_get_prop_string(ctx, 1, "center")) return duk_error(ctx, DUK_ERR_TYPE_ERROR, "radius needs center");
+			center = JSWrapper::toType<DVec3>(ctx, -1);
+			duk_pop(ctx);
+		}
+	}
+
+	const Array<i32>& entities = static_cast<JSScriptModuleImpl*>(module)->queryEntities(Span(types, type_count));
+	i32* out = (i32*)duk_push_fixed_buffer(ctx, entities.size() * sizeof(i32));
+	u32 count = 0;
+	if (!name && radius < 0) {
+		if (!entities.empty()) memcpy(out, entities.begin(), entities.size() * sizeof(i32));
+		count = entities.size();
+	}
+	else {
+		const double radius_squared = radius * radius;
+		for (i32 index : entities) {
+			const EntityRef e = {index};
+			if (name && !equalStrings(world->getEntityName(e), name)) continue;
+			if (radius >= 0 && squaredLength(world->getPosition(e) - center) > radius_squared) continue;
+			out[count] = index;
+			++count;
+		}
+	}
+	duk_push_buffer_object(ctx, -1, 0, count * sizeof(i32), DUK_BUFOBJ_INT32ARRAY);
+	return 1;
+}
+
+static JSScriptModuleImpl* getThisWorldModule(duk_context* ctx) {
+	duk_push_this(ctx);
+	duk_get_prop_string(ctx, -1, "c_ptr");
+	World* world = (World*)duk_get_pointer(ctx, -1);
+	duk_pop_2(ctx);
+	IModule* module = world ? world->getModule(JS_SCRIPT_TYPE) : nullptr;
+	if (!module) duk_error(ctx, DUK_ERR_ERROR, "world has no js_script module");
+	return static_cast<JSScriptModuleImpl*>(module);
+}
+
+// world.findByName("door_01"), returns null if there is no such entity
+int worldFindByName(duk_context* ctx) {
+	const char* name = JSWrapper::toType<const char*>(ctx, 0);
+	JSScriptModuleImpl* module = getThisWorldModule(ctx);
+	const EntityPtr entity = module->findEntityByName(name);
+	if (entity.isValid()) JSWrapper::pushEntity(ctx, entity, &module->getWorld());
+	else duk_push_null(ctx);
+	return 1;
+}
+
+// world.getChildren(entity, out_int32array, recursive), fills out with entity indices, descendants are depth first
+// returns the number of children, which can be more than out.length, so out can be grown and reused
+int worldGetChildren(duk_context* ctx) {
+	const EntityRef entity = duk_is_number(ctx, 0) ? EntityRef{duk_get_int(ctx, 0)} : JSWrapper::toType<EntityRef>(ctx, 0);
+	u32 capacity;
+	i32* out = getTypedArray<i32>(ctx, 1, "Int32Array", capacity);
+	if (!out) return duk_error(ctx, DUK_ERR_TYPE_ERROR, "out must be Int32Array");
+	const bool recursive = duk_get_boolean_default(ctx, 2, false);
+	World& world = getThisWorldModule(ctx)->getWorld();
+
+	u32 count = 0;
+	EntityPtr e = world.getFirstChild(entity);
+	while (e.isValid()) {
+		if (count < capacity) out[count] = e.index;
+		++count;
+		if (recursive) {
+			EntityPtr next = world.getFirstChild(*e);
+			// go up until there is a sibling, but not above the entity
+			while (!next.isValid() && e.isValid() && *e != entity) {
+				next = world.getNextSibling(*e);
+				if (!next.isValid()) e = world.getParent(*e);
+			}
+			e = next;
+		}
+		else {
+			e = world.getNextSibling(*e);
+		}
+	}
+	duk_push_uint(ctx, count);
+	return 1;
+}
+
+int gcStats(duk_context* ctx) {
+	const JSGCStats& gc = getHeap(ctx).gc_stats;
+	const JSAllocator::Stats& heap = getHeap(ctx).allocator.getStats();
+	duk_push_object(ctx);
+	JSWrapper::setField(ctx, "collections", gc.collections);
+	JSWrapper::setField(ctx, "last_pause_ms", gc.last_pause_ms);
+	JSWrapper::setField(ctx, "max_pause_ms", gc.max_pause_ms);
+	JSWrapper::setField(ctx, "total_pause_ms", gc.total_pause_ms);
+	JSWrapper::setField(ctx, "live_bytes", (double)heap.live_bytes);
+	JSWrapper::setField(ctx, "live_bytes_after_gc", (double)gc.live_bytes_after_gc);
+	JSWrapper::setField(ctx, "reserved_bytes", (double)heap.reserved_bytes);
+	JSWrapper::setField(ctx, "allocations", heap.live_allocations);
+	return 1;
+}
+
+} // namespace JSAPI
 
-	registerJSObject(m_global_context, nullptr, "Engine", &ptrJSConstructor);
-	registerGlobalVariable(m_global_context, "Engine", "g_engine", &m_engine);
+// worker heaps run on job threads, so they get only the thread safe part of the API
+void JSScriptSystemImpl::registerGlobalAPI(duk_context* ctx, bool is_worker) {
+	if (!is_worker) {
+		registerImGuiAPI(ctx);
+		registerJSObject(ctx, nullptr, "Engine", &ptrJSConstructor);
+		registerGlobalVariable(ctx, "Engine", "g_engine", &m_engine);
+	}
 
-	registerJSObject(m_global_context, nullptr, "World", &ptrJSConstructor);
+	registerJSObject(ctx, nullptr, "World", &ptrJSConstructor);
+	// query cache is not thread safe
+	if (!is_worker) {
+		registerMethod(ctx, "World", "query", &JSAPI::worldQuery);
+		registerMethod(ctx, "World", "findByName", &JSAPI::worldFindByName);
+		registerMethod(ctx, "World", "getChildren", &JSAPI::worldGetChildren);
+	}
 
-	registerJSObject(m_global_context, nullptr, "ModuleBase", &ptrJSConstructor);
-	registerJSObject(m_global_context, nullptr, "Entity", &entityJSConstructor);
+	registerJSObject(ctx, nullptr, "ModuleBase", &ptrJSConstructor);
+	registerJSObject(ctx, nullptr, "Entity", &entityJSConstructor);
 
 	Span<const reflection::RegisteredComponent> cmps = reflection::getComponents();
 	for (const reflection::RegisteredComponent& cmp : cmps) {
 		if (!cmp.cmp) continue;
 		const char* cmp_type_id = cmp.cmp->name;
-		//registerComponent(m_global_context, cmp_type_id);
+		//registerComponent(ctx, cmp_type_id);
 	}
 
-	duk_context* ctx = m_global_context;
 	JSWrapper::DebugGuard guard(ctx);
-	duk_push_c_function(ctx, &JSAPI::require, DUK_VARARGS);
-	duk_put_global_string(ctx, "require");
+	if (!is_worker) {
+		duk_push_c_function(ctx, &JSAPI::require, DUK_VARARGS);
+		duk_put_global_string(ctx, "require");
+
+		duk_push_c_function(ctx, &JSAPI::setTimeout, DUK_VARARGS);
+		duk_put_global_string(ctx, "setTimeout");
+		duk_push_c_function(ctx, &JSAPI::setInterval, DUK_VARARGS);
+		duk_put_global_string(ctx, "setInterval");
+		duk_push_c_function(ctx, &JSAPI::clearTimeout, DUK_VARARGS);
+		duk_put_global_string(ctx, "clearTimeout");
+		duk_push_c_function(ctx, &JSAPI::clearTimeout, DUK_VARARGS);
+		duk_put_global_string(ctx, "clearInterval");
+	}
 
 	duk_push_object(ctx);
 	duk_dup(ctx, -1);
@@ -1525,6 +5118,68 @@ void JSScriptSystemImpl::registerGlobalAPI() {
 	duk_push_c_function(ctx, &JSAPI::logError, DUK_VARARGS);
 	duk_put_prop_string(ctx, -2, "logError");
 
+	duk_push_c_function(ctx, &JSAPI::color, DUK_VARARGS);
+	duk_put_prop_string(ctx, -2, "color");
+
+	duk_push_c_function(ctx, &JSAPI::quat, DUK_VARARGS);
+	duk_put_prop_string(ctx, -2, "quat");
+
+	duk_push_c_function(ctx, &JSAPI::vec2, DUK_VARARGS);
+	duk_put_prop_string(ctx, -2, "vec2");
+	duk_push_c_function(ctx, &JSAPI::vec3, DUK_VARARGS);
+	duk_put_prop_string(ctx, -2, "vec3");
+	duk_push_c_function(ctx, &JSAPI::vec4, DUK_VARARGS);
+	duk_put_prop_string(ctx, -2, "vec4");
+
+	duk_push_c_function(ctx, &JSAPI::resource, DUK_VARARGS);
+	duk_put_prop_string(ctx, -2, "resource");
+
+	registerMathAPI(ctx);
+
+	if (!is_worker) {
+		duk_push_object(ctx);
+		duk_push_c_function(ctx, &JSAPI::gcCollect, DUK_VARARGS);
+		duk_put_prop_string(ctx, -2, "collect");
+		duk_push_c_function(ctx, &JSAPI::gcStats, DUK_VARARGS);
+		duk_put_prop_string(ctx, -2, "stats");
+		duk_put_prop_string(ctx, -2, "gc");
+
+		duk_push_c_function(ctx, &JSAPI::startCoroutine, DUK_VARARGS);
+		duk_put_prop_string(ctx, -2, "startCoroutine");
+		duk_push_c_function(ctx, &JSAPI::stopCoroutine, DUK_VARARGS);
+		duk_put_prop_string(ctx, -2, "stopCoroutine");
+		duk_push_c_function(ctx, &JSAPI::signal, DUK_VARARGS);
+		duk_put_prop_string(ctx, -2, "signal");
+		duk_push_c_function(ctx, &JSAPI::subscribe, DUK_VARARGS);
+		duk_put_prop_string(ctx, -2, "subscribe");
+		duk_push_c_function(ctx, &JSAPI::unsubscribe, DUK_VARARGS);
+		duk_put_prop_string(ctx, -2, "unsubscribe");
+		duk_push_c_function(ctx, &JSAPI::send, DUK_VARARGS);
+		duk_put_prop_string(ctx, -2, "send");
+		duk_push_c_function(ctx, &JSAPI::broadcast, DUK_VARARGS);
+		duk_put_prop_string(ctx, -2, "broadcast");
+		duk_push_c_function(ctx, &JSAPI::addSystem, DUK_VARARGS);
+		duk_put_prop_string(ctx, -2, "addSystem");
+		duk_push_c_function(ctx, &JSAPI::defineComponent, DUK_VARARGS);
+		duk_put_prop_string(ctx, -2, "defineComponent");
+		duk_push_c_function(ctx, &JSAPI::removeSystem, DUK_VARARGS);
+		duk_put_prop_string(ctx, -2, "removeSystem");
+		duk_push_c_function(ctx, &JSAPI::tween, DUK_VARARGS);
+		duk_put_prop_string(ctx, -2, "tween");
+		duk_push_c_function(ctx, &JSAPI::cancelTween, DUK_VARARGS);
+		duk_put_prop_string(ctx, -2, "cancelTween");
+
+		duk_push_object(ctx);
+		duk_push_c_function(ctx, &JSAPI::jobsRun, DUK_VARARGS);
+		duk_put_prop_string(ctx, -2, "run");
+		duk_put_prop_string(ctx, -2, "jobs");
+
+		duk_push_object(ctx);
+		duk_push_c_function(ctx, &JSAPI::raycastBatch, DUK_VARARGS);
+		duk_put_prop_string(ctx, -2, "raycastBatch");
+		duk_put_prop_string(ctx, -2, "physics");
+	}
+
 	#define DEF_CONST(T, N) \
 		do { duk_push_uint(ctx, (u32)T); duk_put_prop_string(ctx, -2, N); } while(false)
 
@@ -1544,16 +5199,53 @@ void JSScriptSystemImpl::registerGlobalAPI() {
 	duk_new(ctx, 2);
 	duk_put_prop_string(ctx, -2, "INVALID_ENTITY");
 	duk_pop(ctx);
+
+	if (!is_worker) {
+		duk_push_global_stash(ctx);
+		duk_eval_string(ctx, COROUTINE_API_SRC);
+		duk_put_prop_string(ctx, -2, COROUTINE_API_KEY);
+		duk_pop(ctx);
+	}
+}
+
+// compute heaps run only pure functions, they can't touch the world or the engine
+void JSScriptSystemImpl::registerComputeAPI(duk_context* ctx) {
+	duk_push_object(ctx);
+	duk_push_c_function(ctx, &JSComputeJobs::logError, DUK_VARARGS);
+	duk_put_prop_string(ctx, -2, "logError");
+	registerMathAPI(ctx);
+	duk_put_global_string(ctx, "Lumix");
 }
 
 JSScriptSystemImpl::~JSScriptSystemImpl() {
-	duk_destroy_heap(m_global_context);
 	m_script_manager.destroy();
 }
 
 
+void JSScriptSystemImpl::setParallelReadable(ComponentType type, bool readable) {
+	const i32 idx = m_parallel_readable.indexOf(type);
+	if (readable && idx < 0) m_parallel_readable.push(type);
+	if (!readable && idx >= 0) m_parallel_readable.swapAndPop(idx);
+}
+
+UniquePtr<JSHeap> JSScriptSystemImpl::createWorkerHeap() {
+	UniquePtr<JSHeap> heap = UniquePtr<JSHeap>::create(m_allocator, m_allocator);
+	createHeap(*heap);
+	registerGlobalAPI(heap->ctx, true);
+	registerReflectionAPI(heap->ctx, true);
+	heap->readable = &m_parallel_readable;
+	return heap.move();
+}
+
 void JSScriptSystemImpl::createModules(World& world) {
-	UniquePtr<JSScriptModuleImpl> module = UniquePtr<JSScriptModuleImpl>::create(m_allocator, *this, world);
+	UniquePtr<JSHeap> heap;
+	if (m_per_world_heaps) {
+		heap = UniquePtr<JSHeap>::create(m_allocator, m_allocator);
+		createHeap(*heap);
+		registerGlobalAPI(heap->ctx, false);
+		registerJSAPI(heap->ctx);
+	}
+	UniquePtr<JSScriptModuleImpl> module = UniquePtr<JSScriptModuleImpl>::create(m_allocator, *this, world, heap.move());
 	world.addModule(module.move());
 }
 
@@ -1,20 +1,100 @@
 #pragma once
 
 
+#include "core/array.h"
 #include "core/hash.h"
+#include "core/math.h"
 #include "core/path.h"
 #include "core/stream.h"
 #include "core/string.h"
 #include "engine/plugin.h"
 #include "engine/resource.h"
 #include "duktape/duktape.h"
+#include "js_allocator.h"
 
 
 namespace Lumix
 {
 
+struct JSHeapSnapshot;
+
+
+struct JSGCStats {
+	u32 collections = 0;
+	float last_pause_ms = 0;
+	float max_pause_ms = 0;
+	float total_pause_ms = 0;
+	// live heap size right after the last collection
+	u64 live_bytes_after_gc = 0;
+};
+
 struct JSScriptSystem : ISystem {
+	// heap shared by worlds, use JSScriptModule::getGlobalContext to get the heap of a world
 	virtual duk_context* getGlobalContext() = 0;
+	// stats of the heap the context belongs to
+	virtual const JSAllocator::Stats& getHeapStats(duk_context* ctx) = 0;
+	virtual const JSGCStats& getGCStats(duk_context* ctx) = 0;
+	// full collection, call at safe points such as level transitions or loading screens
+	virtual void collectGarbage(duk_context* ctx, bool compact) = 0;
+	// automatic collections are run at the end of frames which took less than this, unless the heap grows too much
+	virtual void setGCFrameBudget(float ms) = 0;
+	// worlds created afterwards get their own heap with its own globals, destroyed together with the world
+	virtual void setPerWorldHeaps(bool enable) = 0;
+	// parallel scripts can read properties only of these components, their getters must be safe to call from job threads
+	virtual void setParallelReadable(ComponentType type, bool readable) = 0;
+};
+
+// heap usage attributed to an owner, objects reachable from more owners are counted only for the first one
+struct JSMemoryItem {
+	Path path;
+	EntityPtr entity = INVALID_ENTITY;
+	i32 scr_index = -1;
+	u64 bytes = 0;
+	u32 objects = 0;
+};
+
+struct JSMemoryReport {
+	explicit JSMemoryReport(IAllocator& allocator)
+		: modules(allocator)
+		, scripts(allocator)
+		, instances(allocator)
+	{}
+
+	// reachable from the global object, e.g. the engine API
+	JSMemoryItem global;
+	// modules cached by require
+	Array<JSMemoryItem> modules;
+	// sums of all instances of each script
+	Array<JSMemoryItem> scripts;
+	Array<JSMemoryItem> instances;
+	// everything allocated by the heap, including garbage and Duktape internals
+	u64 heap_live_bytes = 0;
+};
+
+// payload of engine events, see JSScriptModule::postEvent
+struct JSEventArg {
+	enum class Type : u8 {
+		NUMBER,
+		BOOLEAN,
+		ENTITY,
+		VEC3
+	};
+
+	JSEventArg() : type(Type::NUMBER), number(0) {}
+	JSEventArg(double value) : type(Type::NUMBER), number(value) {}
+	JSEventArg(float value) : type(Type::NUMBER), number(value) {}
+	JSEventArg(i32 value) : type(Type::NUMBER), number(value) {}
+	JSEventArg(bool value) : type(Type::BOOLEAN), boolean(value) {}
+	JSEventArg(EntityPtr value) : type(Type::ENTITY), entity(value) {}
+	JSEventArg(const Vec3& value) : type(Type::VEC3), vec3(value) {}
+
+	Type type;
+	union {
+		double number;
+		bool boolean;
+		EntityPtr entity;
+		Vec3 vec3;
+	};
 };
 
 enum class JSExecuteResult {
@@ -31,17 +111,23 @@ struct JSScriptModule : public IModule {
 			BOOLEAN,
 			NUMBER,
 			STRING,
-			ENTITY
+			ENTITY,
+			VEC2,
+			VEC3,
+			VEC4,
+			COLOR,
+			QUAT,
+			RESOURCE,
+			F32_ARRAY,
+			F64_ARRAY,
+			I32_ARRAY
 		};
 
-		explicit Property(IAllocator& allocator)
-			: stored_value(allocator)
-		{}
-
 		StableHash name_hash;
 		Type type;
 		ResourceType resource_type;
-		OutputMemoryStream stored_value;
+		// offset of the value's slot in the instance's value buffer
+		u32 offset;
 	};
 
 
@@ -58,6 +144,7 @@ struct JSScriptModule : public IModule {
 	//@ array Script scripts
 	virtual Path getScriptPath(EntityRef entity, int scr_index) = 0;	//@ resource_type JSScript::TYPE
 	virtual void setScriptPath(EntityRef entity, int scr_index, const Path& path) = 0;
+	// data of all scripts of the entity, the signatures are the ones the generated reflection calls
 	virtual void getScriptData(EntityRef entity, OutputMemoryStream& blob) = 0;
 	virtual void setScriptData(EntityRef entity, InputMemoryStream& blob) = 0;
 	//@ end
@@ -76,6 +163,22 @@ struct JSScriptModule : public IModule {
 	virtual Property::Type getPropertyType(EntityRef entity, int scr_index, int prop_index) = 0;
 	virtual ResourceType getPropertyResourceType(EntityRef entity, int scr_index, int prop_index) = 0;
 	virtual duk_context* getGlobalContext() = 0;
+	// context of the heap the instance lives in, instances of parallel scripts live in worker heaps
+	virtual duk_context* getScriptContext(EntityRef entity, i32 scr_index) = 0;
+	// walks the heap, which is slow, meant for tools
+	virtual void getMemoryReport(JSMemoryReport& report) = 0;
+	// roots are global object, cached modules, script instances and the rest of the stash, in this order
+	virtual void captureHeapSnapshot(JSHeapSnapshot& snapshot) = 0;
+	// writes to the world from update and input handlers are recorded and applied at the end of update
+	// only the last write to each property is applied, so scripts read old values until then
+	virtual void setDeferredWrites(bool enable) = 0;
+	virtual bool areWritesDeferred() const = 0;
+	// queued and delivered to scripts subscribed by Lumix.subscribe in the next update, main thread only
+	virtual void postEvent(RuntimeHash type, EntityPtr entity, Span<const JSEventArg> args) = 0;
+	// system scripts are not attached to entities, they are updated once per frame with all entities matching their query
+	// they run while the game is running and are removed when it stops
+	virtual void addSystem(const Path& path) = 0;
+	virtual void removeSystem(const Path& path) = 0;
 };
 
 
@@ -61,6 +61,22 @@ LUMIX_FORCE_INLINE void getVecN(duk_context* ctx, T* out, i32 object_index) {
 	}
 }
 
+// reads array of `count` numbers at `idx`, does not throw, so it can read values scripts could change to anything
+inline bool getVector(duk_context* ctx, duk_idx_t idx, u32 count, float* out) {
+	if (!duk_is_array(ctx, idx)) return false;
+	if (duk_get_length(ctx, idx) != count) return false;
+
+	idx = duk_normalize_index(ctx, idx);
+	for (u32 i = 0; i < count; ++i) {
+		duk_get_prop_index(ctx, idx, i);
+		const bool is_number = duk_is_number(ctx, -1);
+		out[i] = (float)duk_get_number(ctx, -1);
+		duk_pop(ctx);
+		if (!is_number) return false;
+	}
+	return true;
+}
+
 template <typename T> struct ToType {
 	static const T& value(duk_context* ctx, int index) {
 		void* ptr = duk_require_pointer(ctx, index);
@@ -61,12 +61,24 @@ void serializerSetter(OutputStream& out, MetaData& data, Module& m, Component& c
 	L("duk_get_prop_string(ctx, -2, \"c_entity\");");
 	L("EntityRef entity {JSWrapper::toType<i32>(ctx, -1)};");
 	L("duk_pop_2(ctx);");
-	if (Enum* e = getEnum(data, m, p.type)) {
+	Enum* e = getEnum(data, m, p.type);
+	if (e) {
 		L("auto value = (",e->full,")JSWrapper::toType<i32>(ctx, 0);");
 	}
 	else {
 		L("auto value = JSWrapper::toType<",p.type,">(ctx, 0);");
 	}
+	// deferred, see JSCommandBuffer
+	L("if (JSCommandBuffer* commands = getCommandBuffer(ctx)) {");
+	L("	static const ComponentType cmp_type = reflection::getComponentType(\"",c.id,"\");");
+	if (e) {
+		L("	commands->call<",m.name,", ",e->full,">(module, entity, cmp_type, value, [](",m.name,"* module, EntityRef entity, ",e->full," value) { module->",p.setter_name,"(entity, value); });");
+	}
+	else {
+		L("	commands->call<",m.name,", ",p.type,">(module, entity, cmp_type, value, [](",m.name,"* module, EntityRef entity, ",p.type," value) { module->",p.setter_name,"(entity, value); });");
+	}
+	L("	return 0;");
+	L("}");
 	L("module->",p.setter_name,"(entity, value);");
 	L("return 0;");
 	L("}" OUT_ENDL);